@@ -0,0 +1,100 @@
+// ReSharper disable CppCStyleCast
+#include "Animation.h"
+
+#include <algorithm>
+#include <cmath>
+
+void FadeAnimation::Start(const double now)
+{
+	_phase = PhaseFadeIn;
+	_phaseStart = now;
+	_holdUntil = 0;
+	_alpha = 0;
+}
+
+void FadeAnimation::Stop()
+{
+	_phase = PhaseNone;
+	_alpha = 0;
+}
+
+void FadeAnimation::Restart(const double now)
+{
+	if (!IsRunning())
+	{
+		Start(now);
+		return;
+	}
+
+	_holdUntil = 0;
+	FadeBackIn(now);
+}
+
+void FadeAnimation::Extend(const double now, const double holdMs)
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	_holdUntil = std::max(_holdUntil, now + holdMs);
+
+	if (_phase == PhaseFadeOut)
+	{
+		FadeBackIn(now);
+	}
+}
+
+void FadeAnimation::FadeBackIn(const double now)
+{
+	// Resume the fade-in at the point of the curve matching the current alpha, so the overlay doesn't flicker
+	const double t = 1.0 - std::cbrt(1.0 - _alpha / 255.0);
+	_phase = PhaseFadeIn;
+	_phaseStart = now - t * FadeInMs;
+}
+
+int32_t FadeAnimation::Tick(const double now)
+{
+	if (_phase == PhaseFadeIn)
+	{
+		const double elapsed = std::max(now - _phaseStart, 0.0);
+
+		if (elapsed < FadeInMs)
+		{
+			_alpha = (int32_t)(EaseOutCubic(elapsed / FadeInMs) * 255.0);
+			return _alpha;
+		}
+
+		// The next phase starts when the fade-in ended, not when this late frame arrived
+		_phase = PhaseHold;
+		_phaseStart += FadeInMs;
+	}
+
+	if (_phase == PhaseHold)
+	{
+		if (now < _holdUntil)
+		{
+			_alpha = 255;
+			return _alpha;
+		}
+
+		_phase = PhaseFadeOut;
+		_phaseStart = std::max(_phaseStart, _holdUntil);
+	}
+
+	if (_phase == PhaseFadeOut)
+	{
+		const double elapsed = std::max(now - _phaseStart, 0.0);
+
+		if (elapsed < FadeOutMs)
+		{
+			_alpha = (int32_t)((1.0 - EaseInCubic(elapsed / FadeOutMs)) * 255.0);
+			return _alpha;
+		}
+
+		_phase = PhaseNone;
+	}
+
+	_alpha = 0;
+	return _alpha;
+}
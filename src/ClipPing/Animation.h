@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+class AnimationClock
+{
+public:
+	virtual ~AnimationClock() = default;
+
+	// Monotonic time in milliseconds
+	virtual double Now() const = 0;
+};
+
+// Deterministic clock for tests and benchmarks, it only moves when told to
+class VirtualClock final : public AnimationClock
+{
+public:
+	double Now() const override { return _now; }
+	void Advance(double ms) { _now += ms; }
+
+private:
+	double _now = 0;
+};
+
+// Fade-in then fade-out state machine of a ping, driven by timestamps from an AnimationClock
+class FadeAnimation
+{
+public:
+	enum Phase : uint8_t { PhaseNone, PhaseFadeIn, PhaseHold, PhaseFadeOut };
+
+	void Start(double now);
+	void Stop();
+
+	// Fades back in from the current alpha, then plays the whole fade-out again
+	void Restart(double now);
+
+	// Keeps the overlay fully opaque until now + holdMs, fading back in first if it was already fading out
+	void Extend(double now, double holdMs);
+
+	// Returns the alpha of the frame displayed at 'now', moving to the next phase once the current one is over
+	int32_t Tick(double now);
+
+	Phase GetPhase() const { return _phase; }
+	bool IsRunning() const { return _phase != PhaseNone; }
+
+	static constexpr double EaseOutCubic(double t)
+	{
+		const double u = 1.0 - t;
+		return 1.0 - u * u * u;
+	}
+
+	static constexpr double EaseInCubic(double t)
+	{
+		return t * t * t;
+	}
+
+	static constexpr double FadeInMs = 100;
+	static constexpr double FadeOutMs = 300;
+
+private:
+	void FadeBackIn(double now);
+
+	Phase _phase = PhaseNone;
+	double _phaseStart = 0;
+	double _holdUntil = 0;
+	int32_t _alpha = 0;
+};
@@ -0,0 +1,694 @@
+// ReSharper disable CppCStyleCast
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "ClipboardHistory.h"
+#include "ContentHasher.h"
+#include "IniFile.h"
+#include "OverlayRenderer.h"
+#include "OverlayStyle.h"
+#include "Rasterizer.h"
+#include "RenderTarget.h"
+#include "Trace.h"
+
+struct BenchmarkSize
+{
+	const char* name;
+	int32_t width;
+	int32_t height;
+};
+
+static constexpr BenchmarkSize Sizes[] =
+{
+	{ "1080p", 1920, 1080 },
+	{ "1440p", 2560, 1440 },
+	{ "4K", 3840, 2160 },
+	{ "8K", 7680, 4320 },
+};
+
+static const char* const TypeNames[] = { "Top", "Border", "Aura", "Bottom", "Left", "Right" };
+static const char* const IsaNames[] = { "scalar", "sse2", "avx2" };
+
+// Best time of a few runs in milliseconds, repeating until enough time has been spent to be stable
+template <typename Func>
+static double Measure(Func&& func)
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr int MinIterations = 5;
+	constexpr auto MinDuration = std::chrono::milliseconds(200);
+
+	func(); // Warm-up
+
+	double best = 1e30;
+	const auto start = Clock::now();
+
+	for (int i = 0; i < MinIterations || Clock::now() - start < MinDuration; i++)
+	{
+		const auto before = Clock::now();
+		func();
+		const std::chrono::duration<double, std::milli> elapsed = Clock::now() - before;
+		best = std::min(best, elapsed.count());
+	}
+
+	return best;
+}
+
+std::string Benchmark::Run()
+{
+	std::string report;
+	RasterizerSuite(report);
+	ThroughputSuite(report);
+	AuraSuite(report);
+	RendererSuite(report);
+	ResizeSuite(report);
+	StyleSuite(report);
+	TintSuite(report);
+	TracerSuite(report);
+	HashSuite(report);
+	HistorySuite(report);
+	SearchSuite(report);
+	return report;
+}
+
+void Benchmark::Append(std::string& report, const char* format, ...)
+{
+	char buffer[256];
+
+	va_list args;
+	va_start(args, format);
+	const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	if (length > 0)
+	{
+		report.append(buffer, std::min((size_t)length, sizeof(buffer) - 1));
+	}
+}
+
+void Benchmark::RasterizerSuite(std::string& report)
+{
+	const auto initialIsa = Rasterizer::GetIsa();
+
+	Append(report, "Rasterizer, full surface, best time in ms\n");
+	Append(report, "%-6s %-7s", "size", "type");
+
+	for (int isa = Rasterizer::IsaScalar; isa <= initialIsa; isa++)
+	{
+		Append(report, " %9s", IsaNames[isa]);
+	}
+
+	Append(report, "\n");
+
+	for (const auto& size : Sizes)
+	{
+		std::vector<uint32_t> pixels((size_t)size.width * size.height);
+		const Surface surface = { pixels.data(), size.width, size.height, size.width };
+
+		for (int type = 0; type < OverlayMax; type++)
+		{
+			Append(report, "%-6s %-7s", size.name, TypeNames[type]);
+
+			for (int isa = Rasterizer::IsaScalar; isa <= initialIsa; isa++)
+			{
+				Rasterizer::SetIsa((Rasterizer::Isa)isa);
+				const auto ms = Measure([&] { Rasterizer::Render(surface, (OverlayType)type, 0xFF, 0x00, 0x00); });
+				Append(report, " %9.3f", ms);
+			}
+
+			Append(report, "\n");
+		}
+	}
+
+	Rasterizer::SetIsa(initialIsa);
+	Append(report, "\n");
+}
+
+void Benchmark::ThroughputSuite(std::string& report)
+{
+	Append(report, "Rasterizer throughput (%s), full surface\n", IsaNames[Rasterizer::GetIsa()]);
+	Append(report, "%-6s %-7s %9s %9s\n", "size", "type", "ns/px", "MB/s");
+
+	for (const auto& size : Sizes)
+	{
+		std::vector<uint32_t> pixels((size_t)size.width * size.height);
+		const Surface surface = { pixels.data(), size.width, size.height, size.width };
+		const double count = (double)pixels.size();
+
+		for (int type = 0; type < OverlayMax; type++)
+		{
+			const auto ms = Measure([&] { Rasterizer::Render(surface, (OverlayType)type, 0xFF, 0x00, 0x00); });
+
+			// Every pixel of the surface is written, so this is the store bandwidth of the kernel
+			const double nsPerPixel = ms * 1e6 / count;
+			const double mbPerSecond = count * sizeof(uint32_t) / (1024.0 * 1024.0) / (ms / 1000.0);
+			Append(report, "%-6s %-7s %9.3f %9.0f\n", size.name, TypeNames[type], nsPerPixel, mbPerSecond);
+		}
+	}
+
+	Append(report, "\n");
+}
+
+void Benchmark::AuraSuite(std::string& report)
+{
+	Append(report, "Aura glow (%s), full surface\n", IsaNames[Rasterizer::GetIsa()]);
+	Append(report, "%-6s %9s %9s %9s %9s %9s\n", "size", "ms", "cold ms", "edge a", "corner a", "max step");
+
+	for (const auto& size : Sizes)
+	{
+		std::vector<uint32_t> pixels((size_t)size.width * size.height);
+		const Surface surface = { pixels.data(), size.width, size.height, size.width };
+
+		const auto warm = Measure([&] { Rasterizer::Render(surface, OverlayAura, 0xFF, 0x00, 0x00); });
+
+		// A new color every time, so that the glow tiles are built on each render
+		uint8_t green = 0;
+		const auto cold = Measure([&] { Rasterizer::Render(surface, OverlayAura, 0xFF, ++green, 0x00); });
+
+		Rasterizer::Render(surface, OverlayAura, 0xFF, 0x00, 0x00);
+
+		const auto alpha = [&](const int32_t x, const int32_t y) { return (int32_t)(pixels[(size_t)y * size.width + x] >> 24); };
+
+		// The corner must not be brighter than the edges, and the falloff must have no visible banding
+		int32_t maxStep = 0;
+
+		for (int32_t y = 0; y + 1 < size.height; y++)
+		{
+			for (int32_t x = 0; x + 1 < size.width; x++)
+			{
+				maxStep = std::max({ maxStep, std::abs(alpha(x, y) - alpha(x + 1, y)), std::abs(alpha(x, y) - alpha(x, y + 1)) });
+			}
+		}
+
+		Append(report, "%-6s %9.3f %9.3f %9d %9d %9d\n", size.name, warm, cold, alpha(size.width / 2, 0), alpha(0, 0), maxStep);
+	}
+
+	Append(report, "\n");
+}
+
+void Benchmark::RendererSuite(std::string& report)
+{
+	MemoryRenderTarget target;
+	OverlayRenderer renderer(target, 0);
+
+	Append(report, "Renderer, cache miss (allocate + rasterize), ns per overlay pixel\n");
+	Append(report, "%-6s %-7s %9s %9s %9s\n", "size", "type", "full", "strips", "strip MB");
+
+	for (const auto& size : Sizes)
+	{
+		const double count = (double)size.width * size.height;
+
+		for (int type = 0; type < OverlayMax; type++)
+		{
+			Strip strips[Rasterizer::MaxStrips] = { { 0, 0, size.width, size.height } };
+			double ns[2];
+			size_t stripBytes = 0;
+
+			for (int split = 0; split < 2; split++)
+			{
+				const auto stripCount = split ? Rasterizer::GetStrips((OverlayType)type, size.width, size.height, strips) : 1;
+
+				const auto ms = Measure([&]
+				{
+					renderer.GetCache().Clear();
+
+					for (int32_t i = 0; i < stripCount; i++)
+					{
+						renderer.Render((OverlayType)type, 0x0000FF, size.width, size.height, strips[i], split ? i : -1);
+					}
+				});
+
+				ns[split] = ms * 1e6 / count;
+				stripBytes = target.GetAllocatedBytes();
+			}
+
+			Append(report, "%-6s %-7s %9.3f %9.3f %9.1f\n", size.name, TypeNames[type], ns[0], ns[1], stripBytes / (1024.0 * 1024.0));
+		}
+	}
+
+	renderer.GetCache().Clear();
+	Append(report, "\n");
+}
+
+void Benchmark::ResizeSuite(std::string& report)
+{
+	// A window being dragged to a new size at every frame: each size is a cache miss
+	constexpr int32_t Steps = 32;
+
+	Append(report, "Resize, %d successive sizes, ns per overlay pixel\n", Steps);
+	Append(report, "%-6s %-7s %9s %9s %9s\n", "size", "type", "raster", "template", "tmpl KB");
+
+	for (const auto& size : Sizes)
+	{
+		std::vector<uint32_t> pixels((size_t)size.width * size.height);
+		std::vector<uint32_t> templatePixels;
+		double count = 0;
+
+		for (int32_t step = 0; step < Steps; step++)
+		{
+			count += (double)(size.width - step) * size.height;
+		}
+
+		for (int type = 0; type < OverlayMax; type++)
+		{
+			const auto raster = Measure([&]
+			{
+				for (int32_t step = 0; step < Steps; step++)
+				{
+					const Surface surface = { pixels.data(), size.width - step, size.height, size.width - step };
+					Rasterizer::Render(surface, (OverlayType)type, 0xFF, 0x00, 0x00);
+				}
+			});
+
+			const auto composed = Measure([&]
+			{
+				Insets current = { -1 };
+
+				for (int32_t step = 0; step < Steps; step++)
+				{
+					const int32_t width = size.width - step;
+					const Surface surface = { pixels.data(), width, size.height, width };
+					Insets insets;
+					Rasterizer::GetInsets((OverlayType)type, width, size.height, insets);
+
+					const int32_t templateWidth = insets.left + 1 + insets.right;
+					const int32_t templateHeight = insets.top + 1 + insets.bottom;
+					templatePixels.resize((size_t)templateWidth * templateHeight);
+					const Surface source = { templatePixels.data(), templateWidth, templateHeight, templateWidth };
+
+					// Only rendered again when the insets change, like in the renderer
+					if (insets != current)
+					{
+						Rasterizer::RenderTemplate(source, insets, width, size.height, (OverlayType)type, 0xFF, 0x00, 0x00);
+						current = insets;
+					}
+
+					Rasterizer::ComposeRegion(surface, 0, 0, width, size.height, source, insets);
+				}
+			});
+
+			Append(report, "%-6s %-7s %9.3f %9.3f %9.1f\n", size.name, TypeNames[type], raster * 1e6 / count, composed * 1e6 / count, templatePixels.size() * sizeof(uint32_t) / 1024.0);
+		}
+	}
+
+	Append(report, "\n");
+}
+
+void Benchmark::StyleSuite(std::string& report)
+{
+	// The built-in border as a custom style, and a style with several shapes, gradients and colors
+	IniFile ini;
+	ini.Parse(
+		"[Border]\n"
+		"Shape1=All 8 80\n"
+		"[Glow]\n"
+		"Shape1=All 2 FF #FFFFFF\n"
+		"Shape2=All 24 60 30@40 00\n"
+		"Shape3=Top+Bottom 6 80 00 #00FF00\n");
+
+	const auto compile = Measure([&] { OverlayStyle::Compile(ini, "Glow"); });
+	const auto glow = OverlayStyle::Compile(ini, "Glow");
+	const auto resolve = Measure([&] { glow->Resolve(144); });
+
+	Append(report, "Styles, compile %.2f us, resolve %.2f us\n", compile * 1000.0, resolve * 1000.0);
+	Append(report, "Cache miss (allocate + compose), ns per overlay pixel\n");
+	Append(report, "%-6s %-7s %9s %9s\n", "size", "style", "full", "strips");
+
+	const DrawList lists[] = { {}, OverlayStyle::Compile(ini, "Border")->Resolve(96), glow->Resolve(96) };
+	const char* const names[] = { "Border", "custom", "glow" };
+
+	MemoryRenderTarget target;
+	OverlayRenderer renderer(target, 0);
+
+	for (const auto& size : Sizes)
+	{
+		const double count = (double)size.width * size.height;
+
+		for (size_t i = 0; i < std::size(lists); i++)
+		{
+			const auto* style = lists[i].id ? &lists[i] : nullptr;
+			Strip strips[Rasterizer::MaxStrips] = { { 0, 0, size.width, size.height } };
+			double ns[2];
+
+			for (int split = 0; split < 2; split++)
+			{
+				const auto stripCount = !split ? 1 : style ? Rasterizer::GetStrips(*style, size.width, size.height, strips) : Rasterizer::GetStrips(OverlayBorder, size.width, size.height, strips);
+
+				const auto ms = Measure([&]
+				{
+					renderer.GetCache().Clear();
+
+					for (int32_t strip = 0; strip < stripCount; strip++)
+					{
+						renderer.Render(OverlayBorder, 0x0000FF, size.width, size.height, strips[strip], split ? strip : -1, style);
+					}
+				});
+
+				ns[split] = ms * 1e6 / count;
+			}
+
+			Append(report, "%-6s %-7s %9.3f %9.3f\n", size.name, names[i], ns[0], ns[1]);
+		}
+	}
+
+	renderer.GetCache().Clear();
+	Append(report, "\n");
+}
+
+void Benchmark::TintSuite(std::string& report)
+{
+	// A new color for a style whose geometry is known: the whole surface, as a color pulse would
+	// redraw it, and the template the renderer composes from
+	Append(report, "Tint, new color on a known geometry\n");
+	Append(report, "%-6s %-7s %9s %9s %9s %9s %9s\n", "size", "type", "raster", "tint", "tint GB/s", "tmpl us", "tint us");
+
+	for (const auto& size : Sizes)
+	{
+		const double count = (double)size.width * size.height;
+		std::vector<uint32_t> pixels((size_t)size.width * size.height);
+		std::vector<uint8_t> coverage(pixels.size());
+		const Surface surface = { pixels.data(), size.width, size.height, size.width };
+
+		for (int type = 0; type < OverlayMax; type++)
+		{
+			Rasterizer::Render(surface, (OverlayType)type, 0xFF, 0xFF, 0xFF);
+			Rasterizer::ExtractCoverage(surface, coverage.data(), size.width);
+
+			uint8_t green = 0;
+			const auto raster = Measure([&] { Rasterizer::Render(surface, (OverlayType)type, 0xFF, ++green, 0x00); });
+			const auto tint = Measure([&] { Rasterizer::Tint(surface, coverage.data(), size.width, 0xFF, ++green, 0x00); });
+
+			// Coverage read and pixels written
+			const double gbPerSecond = count * (sizeof(uint32_t) + 1) / (tint * 1e6);
+
+			Insets insets;
+			Rasterizer::GetInsets((OverlayType)type, size.width, size.height, insets);
+
+			const int32_t templateWidth = insets.left + 1 + insets.right;
+			const int32_t templateHeight = insets.top + 1 + insets.bottom;
+			std::vector<uint32_t> templatePixels((size_t)templateWidth * templateHeight);
+			std::vector<uint8_t> templateCoverage(templatePixels.size());
+			const Surface source = { templatePixels.data(), templateWidth, templateHeight, templateWidth };
+
+			Rasterizer::RenderTemplate(source, insets, size.width, size.height, (OverlayType)type, 0xFF, 0xFF, 0xFF);
+			Rasterizer::ExtractCoverage(source, templateCoverage.data(), templateWidth);
+
+			const auto templateRaster = Measure([&] { Rasterizer::RenderTemplate(source, insets, size.width, size.height, (OverlayType)type, 0xFF, ++green, 0x00); });
+			const auto templateTint = Measure([&] { Rasterizer::Tint(source, templateCoverage.data(), templateWidth, 0xFF, ++green, 0x00); });
+
+			Append(report, "%-6s %-7s %9.3f %9.3f %9.1f %9.1f %9.1f\n",
+				size.name,
+				TypeNames[type],
+				raster * 1e6 / count,
+				tint * 1e6 / count,
+				gbPerSecond,
+				templateRaster * 1000.0,
+				templateTint * 1000.0);
+		}
+	}
+
+	Append(report, "\n");
+}
+
+void Benchmark::TracerSuite(std::string& report)
+{
+	constexpr int Spans = 100000;
+
+	// Heap allocated, the ring buffer and the histograms are too large for the stack
+	const auto tracer = std::make_unique<Tracer>();
+
+	const auto scoped = Measure([&]
+	{
+		for (int i = 0; i < Spans; i++)
+		{
+			ScopedSpan span(SpanFrame, *tracer);
+		}
+	});
+
+	const auto record = Measure([&]
+	{
+		for (int i = 0; i < Spans; i++)
+		{
+			tracer->Record(SpanFrame, i, i + 1000);
+		}
+	});
+
+	// A scoped span reads the clock twice, which is most of its cost and depends on the platform
+	volatile int64_t sink = 0;
+
+	const auto clock = Measure([&]
+	{
+		for (int i = 0; i < Spans; i++)
+		{
+			sink = sink + Tracer::Now();
+		}
+	});
+
+	Append(report, "Tracer, ns per span\n");
+	Append(report, "%-24s %9.1f\n", "scoped (with timestamps)", scoped * 1e6 / Spans);
+	Append(report, "%-24s %9.1f\n", "record only", record * 1e6 / Spans);
+	Append(report, "%-24s %9.1f\n", "clock read", clock * 1e6 / Spans);
+	Append(report, "\n");
+}
+
+void Benchmark::HashSuite(std::string& report)
+{
+	constexpr size_t Sizes[] = { 64, 4 * 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+
+	std::vector<uint8_t> data(Sizes[std::size(Sizes) - 1]);
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = (uint8_t)(i * 2654435761u >> 24);
+	}
+
+	Append(report, "Content hash (XXH64), GB/s\n");
+
+	for (const auto size : Sizes)
+	{
+		// Small inputs are repeated so that the clock resolution doesn't matter
+		const size_t repeat = std::max<size_t>(1, (1024 * 1024) / size);
+		volatile uint64_t sink = 0;
+
+		const auto ms = Measure([&]
+		{
+			for (size_t i = 0; i < repeat; i++)
+			{
+				sink = sink + ContentHasher::Hash(data.data(), size);
+			}
+		});
+
+		Append(report, "%9zu B %9.2f\n", size, (double)size * repeat / (ms / 1000.0) / 1e9);
+	}
+
+	Append(report, "\n");
+}
+
+void Benchmark::HistorySuite(std::string& report)
+{
+	struct Payload
+	{
+		const char* name;
+		size_t size;
+		bool text;
+	};
+
+	static constexpr Payload Payloads[] =
+	{
+		{ "text 100 B", 100, true },
+		{ "text 16 KB", 16 * 1024, true },
+		{ "binary 1 KB", 1024, false },
+		{ "binary 256 KB", 256 * 1024, false },
+	};
+
+	constexpr size_t Budget = 64 * 1024 * 1024;
+	constexpr int Variants = 256;
+
+	Append(report, "Clipboard history, %d MB budget\n", (int)(Budget / (1024 * 1024)));
+	Append(report, "%-14s %12s %10s %12s %10s %12s\n", "payload", "inserts/s", "MB/s", "overhead B", "ratio", "evict us");
+
+	for (const auto& payload : Payloads)
+	{
+		// Distinct payloads, so that every insert is a miss. Text is made of words, so it compresses like prose.
+		std::vector<std::vector<uint8_t>> data(Variants);
+		uint32_t state = 1;
+
+		for (int v = 0; v < Variants; v++)
+		{
+			data[v].resize(payload.size);
+
+			static const char* const Words[] = { "the ", "clipboard ", "overlay ", "window ", "of ", "and ", "ping ", "color ", "to ", "a ", "history ", "\r\n" };
+			size_t i = 0;
+
+			while (i < payload.size)
+			{
+				state = state * 1103515245 + 12345;
+
+				if (!payload.text)
+				{
+					data[v][i++] = (uint8_t)(state >> 24);
+					continue;
+				}
+
+				for (auto word = Words[(state >> 24) % std::size(Words)]; *word && i < payload.size; word++)
+				{
+					data[v][i++] = (uint8_t)*word;
+				}
+			}
+
+			memcpy(data[v].data(), &v, sizeof(v));
+		}
+
+		ClipboardHistory history(Budget);
+		uint64_t counter = 0;
+
+		const auto ms = Measure([&]
+		{
+			for (int i = 0; i < Variants; i++)
+			{
+				// The counter makes every insert unique
+				auto& bytes = data[i];
+				memcpy(bytes.data() + sizeof(int), &counter, sizeof(counter));
+				counter++;
+				history.Add(1, bytes.data(), bytes.size(), payload.text ? PayloadText8 : PayloadBinary, counter);
+			}
+		});
+
+		const auto& stats = history.GetStats();
+		const auto count = std::max<size_t>(1, history.GetCount());
+		const auto overhead = (double)(history.GetFootprint() - stats.storedBytes) / (double)count;
+		const auto ratio = stats.storedBytes ? (double)stats.payloadBytes / (double)stats.storedBytes : 0.0;
+
+		// Eviction cost: shrink the budget so that half the entries go
+		const auto entries = history.GetCount();
+		const auto before = std::chrono::steady_clock::now();
+		history.SetBudget(history.GetFootprint() / 2);
+		const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - before;
+		const auto evicted = std::max<size_t>(1, entries - history.GetCount());
+
+		Append(report, "%-14s %12.0f %10.0f %12.0f %10.2f %12.3f\n",
+			payload.name,
+			Variants / (ms / 1000.0),
+			Variants * payload.size / (1024.0 * 1024.0) / (ms / 1000.0),
+			overhead,
+			ratio,
+			elapsed.count() / (double)evicted);
+	}
+
+	Append(report, "\n");
+}
+
+void Benchmark::SearchSuite(std::string& report)
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr int Entries = 50000;
+	constexpr int Queries = 2000;
+	constexpr size_t Limit = 20;
+
+	uint32_t state = 7;
+	const auto next = [&state] { state = state * 1103515245 + 12345; return state >> 8; };
+
+	// Made-up words with a skewed frequency, like in prose: a few are everywhere, most are rare
+	std::vector<std::u16string> words(8192);
+
+	for (auto& word : words)
+	{
+		const auto length = 2 + next() % 8;
+
+		for (uint32_t i = 0; i < length; i++)
+		{
+			word += (char16_t)(u'a' + next() % 26);
+		}
+	}
+
+	std::vector<std::u16string> texts(Entries);
+
+	for (auto& text : texts)
+	{
+		const auto count = 8 + next() % 50;
+
+		for (uint32_t w = 0; w < count; w++)
+		{
+			const auto unit = (double)(next() % 65536) / 65536.0;
+			text += words[(size_t)(unit * unit * unit * (double)words.size())];
+			text += next() % 8 ? u' ' : u'\n';
+		}
+	}
+
+	ClipboardHistory history((size_t)1024 * 1024 * 1024);
+	const auto buildStart = Clock::now();
+
+	for (int i = 0; i < Entries; i++)
+	{
+		history.Add(13, texts[i].data(), texts[i].size() * sizeof(char16_t), PayloadText16, (uint64_t)i);
+	}
+
+	const std::chrono::duration<double, std::milli> build = Clock::now() - buildStart;
+
+	Append(report, "History search, %d entries, %.0f ms to build, %.1f MB\n", Entries, build.count(), history.GetFootprint() / (1024.0 * 1024.0));
+	Append(report, "%-22s %10s %10s %10s\n", "query", "mean us", "p99 us", "results");
+
+	struct QueryKind
+	{
+		const char* name;
+		TrigramIndex::QueryMode mode;
+		size_t length;
+	};
+
+	static constexpr QueryKind Kinds[] =
+	{
+		{ "substring, 2 chars", TrigramIndex::QuerySubstring, 2 },
+		{ "substring, 5 chars", TrigramIndex::QuerySubstring, 5 },
+		{ "substring, 12 chars", TrigramIndex::QuerySubstring, 12 },
+		{ "prefix, 4 chars", TrigramIndex::QueryPrefix, 4 },
+		{ "prefix, 10 chars", TrigramIndex::QueryPrefix, 10 },
+	};
+
+	std::vector<uint64_t> results;
+	std::vector<double> times(Queries);
+
+	for (const auto& kind : Kinds)
+	{
+		size_t found = 0;
+
+		for (auto& time : times)
+		{
+			// Taken from the entries, so that every query has at least one match
+			const auto& text = texts[next() % Entries];
+			const auto start = kind.mode == TrigramIndex::QueryPrefix ? 0 : next() % (text.size() - kind.length);
+			const auto query = std::u16string_view(text).substr(start, kind.length);
+
+			results.clear();
+			const auto before = Clock::now();
+			history.Search(query, kind.mode, Limit, results);
+			const std::chrono::duration<double, std::micro> elapsed = Clock::now() - before;
+
+			time = elapsed.count();
+			found += results.size();
+		}
+
+		double total = 0;
+
+		for (const auto time : times)
+		{
+			total += time;
+		}
+
+		std::sort(times.begin(), times.end());
+
+		Append(report, "%-22s %10.1f %10.1f %10.1f\n", kind.name, total / Queries, times[Queries * 99 / 100], (double)found / Queries);
+	}
+
+	Append(report, "\n");
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+// Microbenchmarks of the hot paths, run with "ClipPing.exe --benchmark [output file]"
+class Benchmark
+{
+public:
+	// Runs every suite and returns a plain-text report
+	static std::string Run();
+
+private:
+	static void RasterizerSuite(std::string& report);
+	static void ThroughputSuite(std::string& report);
+	static void AuraSuite(std::string& report);
+	static void RendererSuite(std::string& report);
+	static void ResizeSuite(std::string& report);
+	static void StyleSuite(std::string& report);
+	static void TintSuite(std::string& report);
+	static void TracerSuite(std::string& report);
+	static void HashSuite(std::string& report);
+	static void HistorySuite(std::string& report);
+	static void SearchSuite(std::string& report);
+
+	static void Append(std::string& report, const char* format, ...);
+};
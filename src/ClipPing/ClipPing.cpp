@@ -3,68 +3,161 @@
  */
 
 // ReSharper disable CppCStyleCast
+#include <algorithm>
 #include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #define NOMINMAX
 
 #include <windows.h>
 #include <shellapi.h>
 #include <commctrl.h>
-#include <gdiplus.h>
+#include <commdlg.h>
 
 #include "resource.h"
-#include "Overlay.h"
+#include "Benchmark.h"
+#include "ClipboardAccess.h"
+#include "ClipboardDedup.h"
+#include "ForegroundProbe.h"
+#include "HistoryStore.h"
+#include "OverlayPolicy.h"
+#include "ProcessMemory.h"
+#include "Rasterizer.h"
+#include "RenderThread.h"
 #include "Settings.h"
+#include "SettingsWatcher.h"
+#include "Trace.h"
 
 #pragma comment(lib, "user32.lib")
 #pragma comment(lib, "gdi32.lib")
-#pragma comment(lib, "gdiplus.lib")
 #pragma comment(lib, "dwmapi.lib")
 #pragma comment(lib, "shcore.lib")
 #pragma comment(lib, "shell32.lib")
 #pragma comment(lib, "version.lib")
 
-#define WM_TRAYICON     (WM_APP + 1)
+#define WM_TRAYICON      (WM_APP + 1)
+#define WM_SETTINGSFILE  (WM_APP + 2)
+#define WM_HISTORYLOADED (WM_APP + 3)
+
+// Runs the deferred initialization once the listener is idle, WM_TIMER only comes when no other message is pending
+static constexpr UINT_PTR DeferredInitTimer = 1;
+static constexpr UINT DeferredInitDelayMs = 100;
+
+// Blinks the tray icon instead of showing the overlay, each tick hides or shows it again
+static constexpr UINT_PTR TrayFlashTimer = 2;
+static constexpr UINT TrayFlashIntervalMs = 150;
+static constexpr int32_t TrayFlashTicks = 6;
+
+// Fires after IdleReleaseSec without a ping, to give the rendering memory back
+static constexpr UINT_PTR IdleTimer = 3;
+
+// The memory readout in the tray tooltip is refreshed at most that often while hovering
+static constexpr ULONGLONG TrayTipRefreshMs = 1000;
+
+// WM_COPYDATA requests from "ClipPing.exe --dump-trace/--dump-latency <file>", the data is the output path
+enum CopyDataRequest : ULONG_PTR
+{
+	CopyDataChromeTrace = 1,
+	CopyDataLatencySummary = 2,
+};
+
+static bool WriteTrace(const wchar_t* path, const bool chromeTrace)
+{
+	const auto text = chromeTrace ? Tracer::Global().ToChromeTrace() : Tracer::Global().ToJson();
+
+	std::ofstream file(path, std::ios::binary);
+	file << text;
+	return file.good();
+}
+
+// Tracer::Now() timestamp of the process creation, so the startup time includes the loader and the CRT
+static int64_t GetProcessStartTime()
+{
+	FILETIME creation, exitTime, kernel, user, now;
+
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user))
+	{
+		return Tracer::Now();
+	}
+
+	GetSystemTimePreciseAsFileTime(&now);
+
+	const auto toTicks = [](const FILETIME& time) { return (int64_t)((uint64_t)time.dwHighDateTime << 32 | time.dwLowDateTime); };
+	return Tracer::Now() - (toTicks(now) - toTicks(creation)) * 100;
+}
 
 struct AppState
 {
 	Settings settings;
-	Overlay overlay;
+	RenderThread renderer;
+	SettingsWatcher watcher;
+	ClipboardDedup dedup;
+	OverlayPolicy policy;
+	uint32_t policyRevision = 0;
+	int32_t trayFlashTicks = 0;
+	ULONGLONG trayTipTime = 0;
+	HistoryStore history;
+	bool historyEnabled = false; // Follows the settings, checked at every clipboard update
+	std::vector<uint8_t> clipboardCopy;
 	NOTIFYICONDATA nid = {};
 	HINSTANCE hInstance = nullptr;
+	bool initialized = false;
+	bool measureStartup = false; // --startup-time, the process exits once initialized
+	std::wstring startupReportPath;
+	int64_t startTime = 0;
+	int64_t listeningTime = 0;
+
+	explicit AppState(HINSTANCE h) : hInstance(h) {}
 
-	explicit AppState(HINSTANCE h) : overlay(settings), hInstance(h) {}
+	// Read from the version resource the first time the About dialog opens
+	static const std::wstring& GetVersion()
+	{
+		static const std::wstring version = []
+		{
+			wchar_t path[MAX_PATH];
+			GetModuleFileName(nullptr, path, MAX_PATH);
+
+			DWORD unused;
+			const auto size = GetFileVersionInfoSize(path, &unused);
+
+			if (size == 0)
+			{
+				return std::wstring();
+			}
+
+			auto buffer = std::make_unique<BYTE[]>(size);
+			VS_FIXEDFILEINFO* fileInfo = nullptr;
+			UINT len = 0;
+
+			if (!GetFileVersionInfo(path, 0, size, buffer.get()) || !VerQueryValue(buffer.get(), L"\\", (void**)&fileInfo, &len))
+			{
+				return std::wstring();
+			}
+
+			wchar_t text[64];
+			swprintf_s(text, L"Version %d.%d",
+				HIWORD(fileInfo->dwProductVersionMS),
+				LOWORD(fileInfo->dwProductVersionMS));
+			return std::wstring(text);
+		}();
+
+		return version;
+	}
 
 	static INT_PTR CALLBACK AboutDlgProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 	{
 		switch (msg)
 		{
 		case WM_INITDIALOG:
+			if (const auto& version = GetVersion(); !version.empty())
 			{
-				wchar_t path[MAX_PATH];
-				GetModuleFileName(nullptr, path, MAX_PATH);
-
-				DWORD unused;
-				const auto size = GetFileVersionInfoSize(path, &unused);
-				if (size > 0)
-				{
-					auto buffer = std::make_unique<BYTE[]>(size);
-					if (GetFileVersionInfo(path, 0, size, buffer.get()))
-					{
-						VS_FIXEDFILEINFO* fileInfo = nullptr;
-						UINT len = 0;
-						if (VerQueryValue(buffer.get(), L"\\", (void**)&fileInfo, &len))
-						{
-							wchar_t version[64];
-							swprintf_s(version, L"Version %d.%d",
-								HIWORD(fileInfo->dwProductVersionMS),
-								LOWORD(fileInfo->dwProductVersionMS));
-							SetDlgItemText(hwnd, IDC_VERSION, version);
-						}
-					}
-				}
+				SetDlgItemText(hwnd, IDC_VERSION, version.c_str());
 			}
+
 			SetFocus(GetDlgItem(hwnd, IDOK));
 			return FALSE;
 
@@ -97,6 +190,7 @@ struct AppState
 	{
 		const auto menu = CreatePopupMenu();
 		AppendMenu(menu, MF_STRING, IDM_SETTINGS, L"Settings...");
+		AppendMenu(menu, MF_STRING, IDM_EXPORTTRACE, L"Export trace...");
 		AppendMenu(menu, MF_STRING, IDM_ABOUT, L"About...");
 		AppendMenu(menu, MF_SEPARATOR, 0, nullptr);
 		AppendMenu(menu, MF_STRING, IDM_EXIT, L"Exit");
@@ -113,6 +207,130 @@ struct AppState
 		DestroyMenu(menu);
 	}
 
+	// Everything that isn't needed to start listening: it runs on the first clipboard update or
+	// settings request, or when the listener is idle after the startup, whichever comes first
+	void EnsureInitialized(HWND hwnd)
+	{
+		if (initialized)
+		{
+			return;
+		}
+
+		initialized = true;
+		KillTimer(hwnd, DeferredInitTimer);
+
+		const auto start = Tracer::Now();
+
+		settings.Load();
+		renderer.Start(settings);
+		watcher.Start(settings.GetIniDirectory(), hwnd, WM_SETTINGSFILE);
+
+		// Loaded in the background, a large history must not delay the first ping
+		StartHistory(hwnd);
+		ArmIdleTimer(hwnd);
+
+		const auto end = Tracer::Now();
+		Tracer::Global().Record(SpanDeferredInit, start, end);
+
+		if (measureStartup)
+		{
+			WriteStartupReport(start, end);
+			PostMessage(hwnd, WM_CLOSE, 0, 0);
+			return;
+		}
+
+		if (settings.isFirstLaunch)
+		{
+			PostMessage(hwnd, WM_COMMAND, IDM_SETTINGS, 0);
+		}
+	}
+
+	void WriteStartupReport(const int64_t deferredStart, const int64_t deferredEnd) const
+	{
+		char report[256];
+		snprintf(report, sizeof(report),
+			"Startup, ms since the process creation\nlistening   %9.3f\ninitialized %9.3f (deferred work %.3f)\n",
+			(double)(listeningTime - startTime) / 1e6,
+			(double)(deferredEnd - startTime) / 1e6,
+			(double)(deferredEnd - deferredStart) / 1e6);
+
+		if (startupReportPath.empty())
+		{
+			MessageBoxA(nullptr, report, "ClipPing startup", MB_OK);
+			return;
+		}
+
+		std::ofstream file(startupReportPath, std::ios::binary);
+		file << report;
+	}
+
+	// Applies the budget and starts loading the history log, at startup and when the settings change.
+	// The history stays disabled when measuring the startup: the log belongs to the instance that may be running.
+	void StartHistory(HWND hwnd)
+	{
+		history.SetBudget((size_t)settings.historyMb * 1024 * 1024);
+		historyEnabled = !measureStartup && history.GetHistory().GetBudget() > 0;
+
+		if (historyEnabled)
+		{
+			history.Load(settings.GetIniDirectory(), hwnd, WM_HISTORYLOADED);
+		}
+	}
+
+	void RecordHistory(HWND hwnd)
+	{
+		if (!historyEnabled)
+		{
+			return;
+		}
+
+		// Copy while the clipboard is open, hash and compress once it's closed
+		UINT format = 0;
+		const bool read = ClipboardAccess::Read(hwnd, CF_UNICODETEXT, [&](const UINT dataFormat, const void* data, const size_t size)
+		{
+			format = dataFormat;
+
+			if (size <= history.GetHistory().GetBudget() / ClipboardHistory::MaxEntryShare)
+			{
+				clipboardCopy.assign((const uint8_t*)data, (const uint8_t*)data + size);
+			}
+			else
+			{
+				clipboardCopy.clear();
+			}
+		});
+
+		if (read && !clipboardCopy.empty())
+		{
+			// Wall clock time, the history outlives the process
+			FILETIME now;
+			GetSystemTimeAsFileTime(&now);
+
+			const auto time = (uint64_t)now.dwHighDateTime << 32 | now.dwLowDateTime;
+			history.Add(format, clipboardCopy.data(), clipboardCopy.size(), ClipboardAccess::GetPayloadKind(format), time);
+		}
+	}
+
+	static void ExportTrace(HWND hwnd)
+	{
+		wchar_t path[MAX_PATH] = L"clipping-trace.json";
+
+		OPENFILENAME ofn = {};
+		ofn.lStructSize = sizeof(ofn);
+		ofn.hwndOwner = hwnd;
+		ofn.lpstrFilter = L"Chrome trace (*.json)\0*.json\0Latency summary (*.json)\0*.json\0";
+		ofn.nFilterIndex = 1;
+		ofn.lpstrFile = path;
+		ofn.nMaxFile = MAX_PATH;
+		ofn.lpstrDefExt = L"json";
+		ofn.Flags = OFN_OVERWRITEPROMPT | OFN_PATHMUSTEXIST | OFN_NOCHANGEDIR;
+
+		if (GetSaveFileName(&ofn) && !WriteTrace(path, ofn.nFilterIndex == 1))
+		{
+			MessageBox(hwnd, L"Failed to write the trace file.", L"ClipPing", MB_OK | MB_ICONERROR);
+		}
+	}
+
 	void InitTrayIcon(HWND hwnd)
 	{
 		nid.cbSize = sizeof(NOTIFYICONDATA);
@@ -127,6 +345,128 @@ struct AppState
 		Shell_NotifyIcon(NIM_ADD, &nid);
 	}
 
+	// Shows the ping, unless the foreground window is one the user shouldn't be disturbed in
+	void Ping(HWND hwnd, const bool sameContent)
+	{
+		if (policyRevision != settings.revision)
+		{
+			policy.SetMode(settings.quietMode);
+			policy.SetProcessList(settings.quietProcesses);
+			policyRevision = settings.revision;
+		}
+
+		const auto decision = policy.GetMode() == QuietOff
+			? OverlayPolicy::Decision()
+			: policy.Evaluate(ForegroundProbe::Read(policy.HasProcessList()));
+
+		switch (decision.action)
+		{
+		case OverlayPolicy::ActionShow:
+			renderer.OnClipboardUpdate(sameContent);
+			ArmIdleTimer(hwnd);
+			break;
+		case OverlayPolicy::ActionTrayFlash:
+			FlashTrayIcon(hwnd);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Restarts the quiet period, the timer is replaced if it's already set
+	void ArmIdleTimer(HWND hwnd) const
+	{
+		if (settings.idleReleaseSec > 0)
+		{
+			SetTimer(hwnd, IdleTimer, settings.idleReleaseSec * 1000, nullptr);
+		}
+		else
+		{
+			KillTimer(hwnd, IdleTimer);
+		}
+	}
+
+	void OnIdle(HWND hwnd)
+	{
+		KillTimer(hwnd, IdleTimer);
+
+		if (!settings.idleStopRenderer)
+		{
+			renderer.ReleaseMemory();
+			return;
+		}
+
+		// The next ping starts the thread again. A ping still on screen keeps it, until the next quiet period.
+		if (!renderer.SuspendIfIdle())
+		{
+			ArmIdleTimer(hwnd);
+			return;
+		}
+
+		Rasterizer::ReleaseCaches();
+		ProcessMemory::TrimWorkingSet();
+	}
+
+	// Closing the dialog is a settings change, and its previews render surfaces that have to be released like a ping's
+	void ShowSettings(HWND hwnd)
+	{
+		EnsureInitialized(hwnd);
+		settings.ShowDialog(hwnd, hInstance, renderer);
+		StartHistory(hwnd);
+		ArmIdleTimer(hwnd);
+	}
+
+	void UpdateTrayTip()
+	{
+		const auto now = GetTickCount64();
+
+		if (now - trayTipTime < TrayTipRefreshMs)
+		{
+			return;
+		}
+
+		trayTipTime = now;
+
+		const auto memory = ProcessMemory::Read();
+		const auto surfaceBytes = renderer.GetStats().surfaceBytes.load(std::memory_order_relaxed);
+
+		swprintf_s(nid.szTip, L"ClipPing\nPrivate: %.1f MB (peak %.1f MB)\nGDI objects: %u\nSurfaces: %.1f MB",
+			(double)memory.privateBytes / (1024.0 * 1024.0),
+			(double)memory.peakPrivateBytes / (1024.0 * 1024.0),
+			memory.gdiObjects,
+			(double)surfaceBytes / (1024.0 * 1024.0));
+
+		NOTIFYICONDATA tip = nid;
+		tip.uFlags = NIF_TIP;
+		Shell_NotifyIcon(NIM_MODIFY, &tip);
+	}
+
+	void FlashTrayIcon(HWND hwnd)
+	{
+		if (trayFlashTicks == 0)
+		{
+			SetTimer(hwnd, TrayFlashTimer, TrayFlashIntervalMs, nullptr);
+		}
+
+		trayFlashTicks = TrayFlashTicks;
+	}
+
+	void OnTrayFlashTick(HWND hwnd)
+	{
+		trayFlashTicks = std::max(trayFlashTicks - 1, 0);
+
+		NOTIFYICONDATA state = nid;
+		state.uFlags = NIF_STATE;
+		state.dwStateMask = NIS_HIDDEN;
+		state.dwState = trayFlashTicks % 2 ? NIS_HIDDEN : 0;
+		Shell_NotifyIcon(NIM_MODIFY, &state);
+
+		if (trayFlashTicks == 0)
+		{
+			KillTimer(hwnd, TrayFlashTimer);
+		}
+	}
+
 	void RemoveTrayIcon()
 	{
 		Shell_NotifyIcon(NIM_DELETE, &nid);
@@ -156,7 +496,46 @@ struct AppState
 		switch (msg)
 		{
 		case WM_CLIPBOARDUPDATE:
-			app->overlay.Show();
+		{
+			app->EnsureInitialized(hwnd);
+
+			const auto mode = app->settings.dedupMode;
+			bool same = false;
+
+			if (mode != DedupOff)
+			{
+				same = app->dedup.Check(hwnd, app->settings.dedupMaxKb * 1024) == ClipboardDedup::ResultSameContent;
+			}
+
+			if (!same || mode == DedupSubtle)
+			{
+				app->Ping(hwnd, same);
+			}
+
+			if (!same)
+			{
+				app->RecordHistory(hwnd);
+			}
+
+			return 0;
+		}
+
+		case WM_SETTINGSFILE:
+			app->watcher.ChangeHandled();
+
+			if (app->settings.Reload())
+			{
+				app->renderer.UpdateSettings(app->settings);
+				app->StartHistory(hwnd);
+
+				// IdleReleaseSec may have changed, or been enabled
+				app->ArmIdleTimer(hwnd);
+			}
+
+			return 0;
+
+		case WM_HISTORYLOADED:
+			app->history.OnLoaded();
 			return 0;
 
 		case WM_TRAYICON:
@@ -164,9 +543,13 @@ struct AppState
 			{
 				ShowTrayMenu(hwnd);
 			}
+			else if (LOWORD(lParam) == WM_MOUSEMOVE)
+			{
+				app->UpdateTrayTip();
+			}
 			else if (LOWORD(lParam) == WM_LBUTTONDBLCLK)
 			{
-				app->settings.ShowDialog(hwnd, app->hInstance, app->overlay);
+				app->ShowSettings(hwnd);
 			}
 
 			return 0;
@@ -178,7 +561,11 @@ struct AppState
 			}
 			else if (LOWORD(wParam) == IDM_SETTINGS)
 			{
-				app->settings.ShowDialog(hwnd, app->hInstance, app->overlay);
+				app->ShowSettings(hwnd);
+			}
+			else if (LOWORD(wParam) == IDM_EXPORTTRACE)
+			{
+				ExportTrace(hwnd);
 			}
 			else if (LOWORD(wParam) == IDM_ABOUT)
 			{
@@ -187,6 +574,42 @@ struct AppState
 
 			return 0;
 
+		case WM_TIMER:
+			if (wParam == DeferredInitTimer)
+			{
+				app->EnsureInitialized(hwnd);
+				return 0;
+			}
+
+			if (wParam == TrayFlashTimer)
+			{
+				app->OnTrayFlashTick(hwnd);
+				return 0;
+			}
+
+			if (wParam == IdleTimer)
+			{
+				app->OnIdle(hwnd);
+				return 0;
+			}
+
+			break;
+
+		case WM_COPYDATA:
+		{
+			const auto data = (const COPYDATASTRUCT*)lParam;
+			const auto length = data->cbData / sizeof(wchar_t);
+			const auto path = (const wchar_t*)data->lpData;
+
+			if ((data->dwData != CopyDataChromeTrace && data->dwData != CopyDataLatencySummary)
+				|| length == 0 || path[length - 1] != L'\0')
+			{
+				return FALSE;
+			}
+
+			return WriteTrace(path, data->dwData == CopyDataChromeTrace);
+		}
+
 		case WM_DESTROY:
 			PostQuitMessage(0);
 			return 0;
@@ -196,53 +619,93 @@ struct AppState
 	}
 };
 
-int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int)
+// The rest of the command line after a switch, without the surrounding spaces and quotes
+static std::wstring ParsePathArgument(const wchar_t* argument)
 {
-	// Single-instance check: if another instance is already running,
-	// signal it to open its settings window and exit.
-	const auto mutex = CreateMutex(nullptr, FALSE, L"ClipPing_SingleInstance");
-	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	while (*argument == L' ' || *argument == L'"')
 	{
-		const auto existingWnd = FindWindow(L"ClipPingListener", nullptr);
-		if (existingWnd)
-		{
-			DWORD pid = 0;
-			GetWindowThreadProcessId(existingWnd, &pid);
-			AllowSetForegroundWindow(pid);
-			PostMessage(existingWnd, WM_COMMAND, IDM_SETTINGS, 0);
-		}
+		argument++;
+	}
 
-		CloseHandle(mutex);
+	std::wstring path = argument;
+
+	while (!path.empty() && (path.back() == L' ' || path.back() == L'"'))
+	{
+		path.pop_back();
+	}
+
+	return path;
+}
+
+static int RunBenchmark(const wchar_t* outputPath)
+{
+	const auto path = ParsePathArgument(outputPath);
+	const auto report = Benchmark::Run();
+
+	if (path.empty())
+	{
+		MessageBoxA(nullptr, report.c_str(), "ClipPing benchmark", MB_OK);
 		return 0;
 	}
 
+	std::ofstream file(path, std::ios::binary);
+	file << report;
+	return file.good() ? 0 : 1;
+}
+
+static int DumpTrace(const wchar_t* outputPath, const bool chromeTrace)
+{
+	const auto path = ParsePathArgument(outputPath);
+	const auto existingWnd = FindWindow(L"ClipPingListener", nullptr);
+
+	if (path.empty() || !existingWnd)
+	{
+		return 1;
+	}
+
+	// The running instance may have a different working directory
+	wchar_t fullPath[MAX_PATH];
+	const auto length = GetFullPathName(path.c_str(), MAX_PATH, fullPath, nullptr);
+
+	if (length == 0 || length >= MAX_PATH)
+	{
+		return 1;
+	}
+
+	COPYDATASTRUCT data = {};
+	data.dwData = chromeTrace ? CopyDataChromeTrace : CopyDataLatencySummary;
+	data.cbData = (DWORD)((length + 1) * sizeof(wchar_t));
+	data.lpData = fullPath;
+
+	return SendMessage(existingWnd, WM_COPYDATA, 0, (LPARAM)&data) ? 0 : 1;
+}
+
+// The critical path only creates the listener and the tray icon, the rest is deferred to the first use.
+// When measuring, the startup times are written to the report (or shown) and the process exits. The listener
+// is then a message-only window of its own class without a tray icon, so it can't be mistaken for the running instance.
+static int RunStartup(const HINSTANCE hInstance, const int64_t startTime, const bool measure, const std::wstring& reportPath)
+{
 	SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
 
 	AppState app(hInstance);
-	app.settings.Load();
+	app.measureStartup = measure;
+	app.startupReportPath = reportPath;
+	app.startTime = startTime;
 
-	ULONG_PTR gdiplusToken = 0;
-	Gdiplus::GdiplusStartupInput gdiplusStartup;
-	Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartup, nullptr);
+	const auto className = measure ? L"ClipPingStartupProbe" : L"ClipPingListener";
 
 	WNDCLASS wc = {};
-
 	wc.lpfnWndProc = AppState::ListenerWndProc;
 	wc.hInstance = hInstance;
-	wc.lpszClassName = L"ClipPingListener";
-	RegisterClass(&wc);
-
-	wc.lpfnWndProc = Overlay::WndProc;
-	wc.lpszClassName = L"ClipPingOverlay";
-	wc.hbrBackground = nullptr;
+	wc.lpszClassName = className;
 	RegisterClass(&wc);
 
 	const auto hwndListener = CreateWindowEx(
 		WS_EX_TOOLWINDOW,
-		L"ClipPingListener", L"",
+		className, L"",
 		WS_POPUP,
 		0, 0, 0, 0,
-		nullptr, nullptr, hInstance, &app);
+		measure ? HWND_MESSAGE : nullptr, nullptr, hInstance, &app);
 
 	if (!hwndListener)
 	{
@@ -250,13 +713,17 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int)
 	}
 
 	AddClipboardFormatListener(hwndListener);
-	app.InitTrayIcon(hwndListener);
 
-	if (app.settings.isFirstLaunch)
+	if (!measure)
 	{
-		PostMessage(hwndListener, WM_COMMAND, IDM_SETTINGS, 0);
+		app.InitTrayIcon(hwndListener);
 	}
 
+	app.listeningTime = Tracer::Now();
+	Tracer::Global().Record(SpanStartup, startTime, app.listeningTime);
+
+	SetTimer(hwndListener, DeferredInitTimer, DeferredInitDelayMs, nullptr);
+
 	MSG msg;
 	while (GetMessage(&msg, nullptr, 0, 0) > 0)
 	{
@@ -264,11 +731,66 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR, int)
 		DispatchMessage(&msg);
 	}
 
-	app.RemoveTrayIcon();
+	app.watcher.Stop();
+	app.history.Stop();
+
+	if (!measure)
+	{
+		app.RemoveTrayIcon();
+	}
+
 	RemoveClipboardFormatListener(hwndListener);
+	app.renderer.Stop();
 
-	Gdiplus::GdiplusShutdown(gdiplusToken);
+	return (int)msg.wParam;
+}
+
+int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, LPWSTR cmdLine, int)
+{
+	// Diagnostic mode: runs the benchmarks and exits, without interfering with a running instance
+	if (wcsncmp(cmdLine, L"--benchmark", 11) == 0)
+	{
+		return RunBenchmark(cmdLine + 11);
+	}
+
+	// Asks the running instance to write its trace, the spans only exist in that process
+	const bool dumpTrace = wcsncmp(cmdLine, L"--dump-trace", 12) == 0;
+
+	if (dumpTrace || wcsncmp(cmdLine, L"--dump-latency", 14) == 0)
+	{
+		return DumpTrace(cmdLine + (dumpTrace ? 12 : 14), dumpTrace);
+	}
+
+	// Diagnostic mode: starts normally, then writes the time to listening and to the end of the
+	// deferred initialization and exits. Ignores the single-instance check, so it can run next to an instance.
+	const bool measureStartup = wcsncmp(cmdLine, L"--startup-time", 14) == 0;
+	const auto startTime = GetProcessStartTime();
+
+	if (measureStartup)
+	{
+		return RunStartup(hInstance, startTime, true, ParsePathArgument(cmdLine + 14));
+	}
+
+	// Single-instance check: if another instance is already running,
+	// signal it to open its settings window and exit.
+	const auto mutex = CreateMutex(nullptr, FALSE, L"ClipPing_SingleInstance");
+	if (GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		const auto existingWnd = FindWindow(L"ClipPingListener", nullptr);
+		if (existingWnd)
+		{
+			DWORD pid = 0;
+			GetWindowThreadProcessId(existingWnd, &pid);
+			AllowSetForegroundWindow(pid);
+			PostMessage(existingWnd, WM_COMMAND, IDM_SETTINGS, 0);
+		}
+
+		CloseHandle(mutex);
+		return 0;
+	}
+
+	const auto result = RunStartup(hInstance, startTime, false, std::wstring());
 
 	CloseHandle(mutex);
-	return (int)msg.wParam;
+	return result;
 }
@@ -0,0 +1,102 @@
+// ReSharper disable CppCStyleCast
+#include "ClipboardAccess.h"
+
+bool ClipboardAccess::IsMemoryFormat(const UINT format)
+{
+	// These are GDI handles or pointers into another process, not HGLOBAL memory
+	switch (format)
+	{
+	case CF_BITMAP:
+	case CF_ENHMETAFILE:
+	case CF_METAFILEPICT:
+	case CF_PALETTE:
+	case CF_OWNERDISPLAY:
+	case CF_DSPBITMAP:
+	case CF_DSPENHMETAFILE:
+	case CF_DSPMETAFILEPICT:
+		return false;
+	default:
+		return true;
+	}
+}
+
+PayloadKind ClipboardAccess::GetPayloadKind(const UINT format)
+{
+	switch (format)
+	{
+	case CF_UNICODETEXT:
+		return PayloadText16;
+	case CF_TEXT:
+	case CF_OEMTEXT:
+		return PayloadText8;
+	default:
+		return PayloadBinary;
+	}
+}
+
+bool ClipboardAccess::Open(HWND owner)
+{
+	for (int attempt = 0; attempt < OpenAttempts; attempt++)
+	{
+		if (attempt > 0)
+		{
+			Sleep(OpenRetryMs);
+		}
+
+		if (OpenClipboard(owner))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ClipboardAccess::IsPrivate()
+{
+	static const UINT ExcludeFormat = RegisterClipboardFormat(L"ExcludeClipboardContentFromMonitorProcessing");
+	static const UINT ViewerIgnoreFormat = RegisterClipboardFormat(L"Clipboard Viewer Ignore");
+	static const UINT HistoryFormat = RegisterClipboardFormat(L"CanIncludeInClipboardHistory");
+
+	if ((ExcludeFormat != 0 && IsClipboardFormatAvailable(ExcludeFormat))
+		|| (ViewerIgnoreFormat != 0 && IsClipboardFormatAvailable(ViewerIgnoreFormat)))
+	{
+		return true;
+	}
+
+	if (HistoryFormat == 0 || !IsClipboardFormatAvailable(HistoryFormat))
+	{
+		return false;
+	}
+
+	// A DWORD, 0 keeps the content out of the history
+	const auto data = (HGLOBAL)GetClipboardData(HistoryFormat);
+	const auto value = data ? (const DWORD*)GlobalLock(data) : nullptr;
+
+	if (!value)
+	{
+		return false;
+	}
+
+	const bool excluded = GlobalSize(data) >= sizeof(DWORD) && *value == 0;
+	GlobalUnlock(data);
+	return excluded;
+}
+
+UINT ClipboardAccess::FindFormat(const UINT preferred)
+{
+	if (preferred != 0 && IsClipboardFormatAvailable(preferred))
+	{
+		return preferred;
+	}
+
+	UINT format = 0;
+
+	do
+	{
+		format = EnumClipboardFormats(format);
+	}
+	while (format != 0 && !IsMemoryFormat(format));
+
+	return format;
+}
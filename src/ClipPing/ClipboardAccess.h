@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <windows.h>
+
+#include "ClipboardHistory.h"
+
+// Short-lived read access to the clipboard. The clipboard is only held open for the duration of
+// the callback, so callbacks should copy or hash the data and return.
+class ClipboardAccess
+{
+public:
+	// Calls func(format, data, size) with the memory of the preferred format if it's available,
+	// otherwise of the first memory format the owner placed, which is its native one.
+	// Returns false if the clipboard couldn't be opened, holds no memory format, or is private.
+	template <typename Func>
+	static bool Read(HWND owner, UINT preferred, Func&& func)
+	{
+		if (!Open(owner))
+		{
+			return false;
+		}
+
+		bool read = false;
+		const auto format = IsPrivate() ? 0 : FindFormat(preferred);
+
+		if (format != 0)
+		{
+			const auto data = (HGLOBAL)GetClipboardData(format);
+			const auto bytes = data ? GlobalLock(data) : nullptr;
+
+			if (bytes)
+			{
+				func(format, (const void*)bytes, (size_t)GlobalSize(data));
+				GlobalUnlock(data);
+				read = true;
+			}
+		}
+
+		CloseClipboard();
+		return read;
+	}
+
+	static bool IsMemoryFormat(UINT format);
+	static PayloadKind GetPayloadKind(UINT format);
+
+private:
+	static bool Open(HWND owner);
+
+	// Password managers mark secrets with registered formats asking clipboard monitors and histories
+	// to leave the content alone. Must be called while the clipboard is open.
+	static bool IsPrivate();
+	static UINT FindFormat(UINT preferred);
+
+	// Other applications can hold the clipboard open for a short while after writing to it
+	static constexpr int OpenAttempts = 3;
+	static constexpr DWORD OpenRetryMs = 2;
+};
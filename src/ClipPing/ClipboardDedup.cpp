@@ -0,0 +1,59 @@
+// ReSharper disable CppCStyleCast
+#include "ClipboardDedup.h"
+
+#include "ClipboardAccess.h"
+#include "ContentHasher.h"
+
+ClipboardDedup::Result ClipboardDedup::Check(HWND owner, const uint32_t maxBytes)
+{
+	_stats.checked++;
+
+	const auto sequence = GetClipboardSequenceNumber();
+
+	if (_known && sequence == _sequence)
+	{
+		_stats.sameSequence++;
+		return ResultSameContent;
+	}
+
+	_sequence = sequence;
+
+	Content content;
+
+	if (!ReadContent(owner, maxBytes, content))
+	{
+		// Unknown content always pings
+		_known = false;
+		return ResultChanged;
+	}
+
+	const bool same = _known && content == _content;
+	_content = content;
+	_known = true;
+
+	if (same)
+	{
+		_stats.sameContent++;
+		return ResultSameContent;
+	}
+
+	return ResultChanged;
+}
+
+bool ClipboardDedup::ReadContent(HWND owner, const uint32_t maxBytes, Content& content)
+{
+	const bool read = ClipboardAccess::Read(owner, 0, [&](const UINT format, const void* data, const size_t size)
+	{
+		const auto hashed = size < maxBytes ? size : (size_t)maxBytes;
+
+		content = { format, (uint64_t)size, ContentHasher::Hash(data, hashed) };
+		_stats.hashedBytes += hashed;
+	});
+
+	if (!read)
+	{
+		_stats.readFailures++;
+	}
+
+	return read;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <windows.h>
+
+// What to do when the clipboard is rewritten with the content it already had
+enum DedupMode : int32_t
+{
+	DedupOff = 0,
+	DedupSuppress = 1, // No ping
+	DedupSubtle = 2, // A fainter ping
+	DedupMax
+};
+
+// Detects clipboard updates that don't change the content. The sequence number catches repeated
+// notifications, then a bounded hash of the primary format catches applications that write the
+// same data again.
+class ClipboardDedup
+{
+public:
+	enum Result : uint8_t { ResultChanged, ResultSameContent };
+
+	struct Stats
+	{
+		uint64_t checked = 0;
+		uint64_t sameSequence = 0;
+		uint64_t sameContent = 0;
+		uint64_t readFailures = 0; // Including private content, which isn't hashed
+		uint64_t hashedBytes = 0;
+	};
+
+	// Only hashes the first maxBytes of the format, the total size is part of the key
+	Result Check(HWND owner, uint32_t maxBytes);
+
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	struct Content
+	{
+		UINT format = 0;
+		uint64_t size = 0;
+		uint64_t hash = 0;
+
+		bool operator==(const Content&) const = default;
+	};
+
+	bool ReadContent(HWND owner, uint32_t maxBytes, Content& content);
+
+	DWORD _sequence = 0;
+	Content _content;
+	bool _known = false;
+	Stats _stats;
+};
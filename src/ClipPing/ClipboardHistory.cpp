@@ -0,0 +1,218 @@
+// ReSharper disable CppCStyleCast
+#include "ClipboardHistory.h"
+
+#include <cstring>
+#include <iterator>
+
+#include "ContentHasher.h"
+#include "LzCodec.h"
+
+ClipboardHistory::ClipboardHistory(const size_t budgetBytes)
+	: _budget(budgetBytes)
+{
+}
+
+ClipboardHistory::~ClipboardHistory()
+{
+	Clear();
+}
+
+uint64_t ClipboardHistory::Add(const uint32_t format, const void* data, const size_t size, const PayloadKind kind, const uint64_t time)
+{
+	if (size > _budget / MaxEntryShare || size > UINT32_MAX)
+	{
+		_stats.rejected++;
+		return 0;
+	}
+
+	// The format is the seed, so the same bytes in two formats are two entries
+	const auto hash = ContentHasher::Hash(data, size, format);
+
+	if (const auto existing = _byHash.find(hash); existing != _byHash.end())
+	{
+		const auto it = existing->second;
+
+		if (it->format == format && it->size == size)
+		{
+			it->time = time;
+			_entries.splice(_entries.end(), _entries, it);
+			_index.Touch(it->id);
+			_stats.duplicates++;
+			return it->id;
+		}
+	}
+
+	auto payload = (const uint8_t*)data;
+	auto storedSize = size;
+	bool compressed = false;
+
+	if (kind != PayloadBinary && size >= CompressMinBytes)
+	{
+		_scratch.resize(LzCodec::MaxCompressedSize(size));
+		const auto compressedSize = LzCodec::Compress(payload, size, _scratch.data(), _scratch.size());
+
+		// Not worth a decompression on every read below 1/8 of savings
+		if (compressedSize > 0 && compressedSize < size - size / 8)
+		{
+			payload = _scratch.data();
+			storedSize = compressedSize;
+			compressed = true;
+			_stats.compressed++;
+		}
+	}
+
+	if (!MakeRoom(storedSize))
+	{
+		_stats.rejected++;
+		return 0;
+	}
+
+	const auto block = _arena.Allocate(storedSize);
+
+	if (!block.data)
+	{
+		_stats.rejected++;
+		return 0;
+	}
+
+	memcpy(block.data, payload, storedSize);
+
+	Entry entry;
+	entry.id = _nextId++;
+	entry.time = time;
+	entry.hash = hash;
+	entry.format = format;
+	entry.size = (uint32_t)size;
+	entry.storedSize = (uint32_t)storedSize;
+	entry.kind = kind;
+	entry.compressed = compressed;
+	entry.block = block;
+
+	_entries.push_back(entry);
+	const auto it = std::prev(_entries.end());
+	_byHash[hash] = it;
+	_byId[entry.id] = it;
+
+	if (kind == PayloadText16)
+	{
+		// Clipboard data is only guaranteed to be byte aligned in the general case
+		std::u16string text(size / sizeof(char16_t), u'\0');
+		memcpy(text.data(), data, text.size() * sizeof(char16_t));
+		_index.Add(entry.id, text);
+	}
+	else if (kind == PayloadText8)
+	{
+		_index.Add(entry.id, TrigramIndex::Widen({ (const char*)data, size }));
+	}
+
+	_stats.inserts++;
+	_stats.payloadBytes += size;
+	_stats.storedBytes += storedSize;
+
+	// The index grows by an amount that's only known once the text is indexed
+	while (GetFootprint() > _budget)
+	{
+		const auto oldest = _entries.begin();
+
+		if (oldest == it)
+		{
+			Evict(it);
+			_stats.rejected++;
+			return 0;
+		}
+
+		Evict(oldest);
+	}
+
+	return entry.id;
+}
+
+bool ClipboardHistory::MakeRoom(const size_t size)
+{
+	while (!_entries.empty() && GetFootprint() + _arena.GetCost(size) + NodeOverhead > _budget)
+	{
+		Evict(_entries.begin());
+	}
+
+	return GetFootprint() + _arena.GetCost(size) + NodeOverhead <= _budget;
+}
+
+void ClipboardHistory::Evict(const Iterator it)
+{
+	// The hash slot may point to a newer entry after a collision
+	if (const auto byHash = _byHash.find(it->hash); byHash != _byHash.end() && byHash->second == it)
+	{
+		_byHash.erase(byHash);
+	}
+
+	_byId.erase(it->id);
+	_index.Remove(it->id);
+	_arena.Free(it->block);
+
+	_stats.payloadBytes -= it->size;
+	_stats.storedBytes -= it->storedSize;
+	_stats.evictions++;
+
+	_entries.erase(it);
+}
+
+const ClipboardHistory::Entry* ClipboardHistory::Find(const uint64_t id) const
+{
+	const auto it = _byId.find(id);
+	return it == _byId.end() ? nullptr : &*it->second;
+}
+
+void ClipboardHistory::Search(const std::u16string_view query, const TrigramIndex::QueryMode mode, const size_t limit, std::vector<uint64_t>& results) const
+{
+	_index.Search(query, mode, limit, results);
+}
+
+bool ClipboardHistory::Get(const uint64_t id, std::vector<uint8_t>& data) const
+{
+	const auto entry = Find(id);
+
+	if (!entry)
+	{
+		return false;
+	}
+
+	data.resize(entry->size);
+
+	if (!entry->compressed)
+	{
+		memcpy(data.data(), entry->block.data, entry->size);
+		return true;
+	}
+
+	return LzCodec::Decompress(entry->block.data, entry->storedSize, data.data(), entry->size);
+}
+
+void ClipboardHistory::SetBudget(const size_t budgetBytes)
+{
+	_budget = budgetBytes;
+
+	while (!_entries.empty() && GetFootprint() > _budget)
+	{
+		Evict(_entries.begin());
+	}
+}
+
+void ClipboardHistory::Clear()
+{
+	for (const auto& entry : _entries)
+	{
+		_arena.Free(entry.block);
+	}
+
+	_entries.clear();
+	_index.Clear();
+	_byHash.clear();
+	_byId.clear();
+	_stats.payloadBytes = 0;
+	_stats.storedBytes = 0;
+}
+
+size_t ClipboardHistory::GetFootprint() const
+{
+	return _arena.GetFootprint() + _index.GetMemoryUsage() + _entries.size() * NodeOverhead;
+}
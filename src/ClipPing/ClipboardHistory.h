@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "SlabArena.h"
+#include "TrigramIndex.h"
+
+enum PayloadKind : uint8_t
+{
+	PayloadBinary,
+	PayloadText8, // ANSI text
+	PayloadText16, // UTF-16 text
+};
+
+// Clipboard history with a hard memory cap. Payloads are copied into a slab arena, identical payloads
+// are stored once (a repeated copy moves the existing entry to the front), and large text payloads are
+// LZ-compressed. When the budget is exceeded, the oldest entries are evicted first. Text entries are
+// kept in a trigram index for search, which counts towards the budget.
+class ClipboardHistory
+{
+public:
+	struct Entry
+	{
+		uint64_t id = 0;
+		uint64_t time = 0;
+		uint64_t hash = 0;
+		uint32_t format = 0;
+		uint32_t size = 0; // Uncompressed
+		uint32_t storedSize = 0;
+		PayloadKind kind = PayloadBinary;
+		bool compressed = false;
+		SlabArena::Block block;
+	};
+
+	struct Stats
+	{
+		uint64_t inserts = 0;
+		uint64_t duplicates = 0;
+		uint64_t evictions = 0;
+		uint64_t compressed = 0;
+		uint64_t rejected = 0; // Too large for the budget
+		size_t payloadBytes = 0; // Uncompressed size of the stored entries
+		size_t storedBytes = 0;
+	};
+
+	explicit ClipboardHistory(size_t budgetBytes);
+	~ClipboardHistory();
+
+	ClipboardHistory(const ClipboardHistory&) = delete;
+	ClipboardHistory& operator=(const ClipboardHistory&) = delete;
+
+	// Returns the id of the entry holding the payload, or 0 if it was rejected.
+	// Text payloads above CompressMinBytes are compressed.
+	uint64_t Add(uint32_t format, const void* data, size_t size, PayloadKind kind, uint64_t time);
+
+	// Copies the uncompressed payload of an entry, returns false if it was evicted
+	bool Get(uint64_t id, std::vector<uint8_t>& data) const;
+
+	const Entry* Find(uint64_t id) const;
+
+	// Ids of the text entries containing the query (or starting with it), most recently used first
+	void Search(std::u16string_view query, TrigramIndex::QueryMode mode, size_t limit, std::vector<uint64_t>& results) const;
+
+	// Visits the entries from the most recent to the oldest, until the callback returns false
+	template <typename Func>
+	void ForEach(Func&& func) const
+	{
+		for (auto it = _entries.rbegin(); it != _entries.rend(); ++it)
+		{
+			if (!func(*it))
+			{
+				break;
+			}
+		}
+	}
+
+	void SetBudget(size_t budgetBytes);
+	void Clear();
+
+	size_t GetCount() const { return _entries.size(); }
+	size_t GetBudget() const { return _budget; }
+
+	// Arena memory, the search index and an estimate of the bookkeeping (list and table nodes)
+	size_t GetFootprint() const;
+
+	const Stats& GetStats() const { return _stats; }
+
+	static constexpr size_t CompressMinBytes = 4 * 1024;
+
+	// A single entry can't take more than this fraction of the budget
+	static constexpr size_t MaxEntryShare = 4;
+
+private:
+	using Iterator = std::list<Entry>::iterator;
+
+	// Bookkeeping per entry: the list node, and a node in each of the two indexes
+	static constexpr size_t NodeOverhead = sizeof(Entry) + 2 * sizeof(void*) + 2 * (sizeof(uint64_t) + sizeof(Iterator) + 2 * sizeof(void*));
+
+	bool MakeRoom(size_t size);
+	void Evict(Iterator it);
+
+	SlabArena _arena;
+	TrigramIndex _index;
+	std::list<Entry> _entries; // Oldest first
+	std::unordered_map<uint64_t, Iterator> _byHash;
+	std::unordered_map<uint64_t, Iterator> _byId;
+	std::vector<uint8_t> _scratch;
+	size_t _budget;
+	uint64_t _nextId = 1;
+	Stats _stats;
+};
@@ -0,0 +1,147 @@
+// ReSharper disable CppCStyleCast
+#include "ContentHasher.h"
+
+#include <bit>
+#include <cstring>
+
+static constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+static uint64_t Read64(const uint8_t* data)
+{
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static uint32_t Read32(const uint8_t* data)
+{
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static uint64_t Round(uint64_t accumulator, const uint64_t input)
+{
+	accumulator += input * Prime2;
+	accumulator = std::rotl(accumulator, 31);
+	return accumulator * Prime1;
+}
+
+static uint64_t MergeRound(uint64_t accumulator, const uint64_t lane)
+{
+	accumulator ^= Round(0, lane);
+	return accumulator * Prime1 + Prime4;
+}
+
+ContentHasher::ContentHasher(const uint64_t seed)
+	: _lanes{ seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 }, _seed(seed)
+{
+}
+
+void ContentHasher::Update(const void* data, size_t size)
+{
+	auto input = (const uint8_t*)data;
+	_length += size;
+
+	if (_buffered > 0)
+	{
+		const auto count = size < StripeSize - _buffered ? size : StripeSize - _buffered;
+		memcpy(_buffer + _buffered, input, count);
+		_buffered += count;
+		input += count;
+		size -= count;
+
+		if (_buffered < StripeSize)
+		{
+			return;
+		}
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			_lanes[lane] = Round(_lanes[lane], Read64(_buffer + lane * 8));
+		}
+
+		_buffered = 0;
+	}
+
+	// The four lanes are independent, which keeps four multiplies in flight
+	uint64_t v1 = _lanes[0], v2 = _lanes[1], v3 = _lanes[2], v4 = _lanes[3];
+
+	for (; size >= StripeSize; input += StripeSize, size -= StripeSize)
+	{
+		v1 = Round(v1, Read64(input));
+		v2 = Round(v2, Read64(input + 8));
+		v3 = Round(v3, Read64(input + 16));
+		v4 = Round(v4, Read64(input + 24));
+	}
+
+	_lanes[0] = v1;
+	_lanes[1] = v2;
+	_lanes[2] = v3;
+	_lanes[3] = v4;
+
+	memcpy(_buffer, input, size);
+	_buffered = size;
+}
+
+uint64_t ContentHasher::Finish() const
+{
+	uint64_t hash;
+
+	if (_length >= StripeSize)
+	{
+		hash = std::rotl(_lanes[0], 1) + std::rotl(_lanes[1], 7) + std::rotl(_lanes[2], 12) + std::rotl(_lanes[3], 18);
+
+		for (const auto lane : _lanes)
+		{
+			hash = MergeRound(hash, lane);
+		}
+	}
+	else
+	{
+		hash = _seed + Prime5;
+	}
+
+	hash += _length;
+
+	auto input = _buffer;
+	auto remaining = _buffered;
+
+	for (; remaining >= 8; input += 8, remaining -= 8)
+	{
+		hash ^= Round(0, Read64(input));
+		hash = std::rotl(hash, 27) * Prime1 + Prime4;
+	}
+
+	if (remaining >= 4)
+	{
+		hash ^= (uint64_t)Read32(input) * Prime1;
+		hash = std::rotl(hash, 23) * Prime2 + Prime3;
+		input += 4;
+		remaining -= 4;
+	}
+
+	for (; remaining > 0; input++, remaining--)
+	{
+		hash ^= *input * Prime5;
+		hash = std::rotl(hash, 11) * Prime1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= Prime2;
+	hash ^= hash >> 29;
+	hash *= Prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+uint64_t ContentHasher::Hash(const void* data, const size_t size, const uint64_t seed)
+{
+	ContentHasher hasher(seed);
+	hasher.Update(data, size);
+	return hasher.Finish();
+}
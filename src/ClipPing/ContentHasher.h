@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Streaming XXH64. Data can be fed in chunks of any size, the result is the same as hashing it in one go.
+class ContentHasher
+{
+public:
+	explicit ContentHasher(uint64_t seed = 0);
+
+	void Update(const void* data, size_t size);
+	uint64_t Finish() const;
+
+	static uint64_t Hash(const void* data, size_t size, uint64_t seed = 0);
+
+private:
+	static constexpr size_t StripeSize = 32;
+
+	uint64_t _lanes[4];
+	uint64_t _seed;
+	uint64_t _length = 0;
+	uint8_t _buffer[StripeSize];
+	size_t _buffered = 0;
+};
@@ -0,0 +1,37 @@
+// ReSharper disable CppCStyleCast
+#include "DibRenderTarget.h"
+
+void* DibRenderTarget::Allocate(const int32_t width, const int32_t height, Surface& surface)
+{
+	BITMAPINFO bmi = {};
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = width;
+	bmi.bmiHeader.biHeight = -height; // Top-down
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	void* pixels = nullptr;
+	const auto hdcScreen = GetDC(nullptr);
+	auto bitmap = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &pixels, nullptr, 0);
+	ReleaseDC(nullptr, hdcScreen);
+
+	if (bitmap && !pixels)
+	{
+		DeleteObject(bitmap);
+		bitmap = nullptr;
+	}
+
+	if (!bitmap)
+	{
+		return nullptr;
+	}
+
+	surface = { (uint32_t*)pixels, width, height, width };
+	return bitmap;
+}
+
+void DibRenderTarget::Release(void* handle)
+{
+	DeleteObject((HBITMAP)handle);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <windows.h>
+
+#include "RenderTarget.h"
+
+// Top-down 32bpp DIB sections, ready to be selected into a DC for UpdateLayeredWindow
+class DibRenderTarget final : public RenderTarget
+{
+public:
+	void* Allocate(int32_t width, int32_t height, Surface& surface) override;
+	void Release(void* handle) override;
+};
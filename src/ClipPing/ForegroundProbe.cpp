@@ -0,0 +1,93 @@
+// ReSharper disable CppCStyleCast
+#include "ForegroundProbe.h"
+
+#include <cwchar>
+
+#include <windows.h>
+#include <shellapi.h>
+
+// The desktop covers the monitor without a title bar, it's not a fullscreen application
+static bool IsDesktop(const HWND hwnd)
+{
+	if (hwnd == GetShellWindow())
+	{
+		return true;
+	}
+
+	wchar_t className[16];
+
+	if (GetClassName(hwnd, className, (int)(sizeof(className) / sizeof(className[0]))) == 0)
+	{
+		return false;
+	}
+
+	return wcscmp(className, L"WorkerW") == 0 || wcscmp(className, L"Progman") == 0;
+}
+
+static std::wstring GetProcessName(const HWND hwnd)
+{
+	DWORD processId = 0;
+	GetWindowThreadProcessId(hwnd, &processId);
+
+	const auto process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId);
+
+	if (!process)
+	{
+		return {};
+	}
+
+	wchar_t path[MAX_PATH];
+	DWORD length = MAX_PATH;
+	const bool read = QueryFullProcessImageName(process, 0, path, &length) != FALSE;
+	CloseHandle(process);
+
+	if (!read)
+	{
+		return {};
+	}
+
+	const auto separator = wcsrchr(path, L'\\');
+	return separator ? separator + 1 : path;
+}
+
+ForegroundState ForegroundProbe::Read(const bool withProcessName)
+{
+	ForegroundState state;
+	QUERY_USER_NOTIFICATION_STATE notification;
+
+	if (SUCCEEDED(SHQueryUserNotificationState(&notification)))
+	{
+		// QUNS_APP only means a Store app has the foreground, fullscreen or not: the window check decides
+		state.busy = notification == QUNS_BUSY
+			|| notification == QUNS_RUNNING_D3D_FULL_SCREEN
+			|| notification == QUNS_PRESENTATION_MODE;
+	}
+
+	const auto hwnd = GetForegroundWindow();
+
+	if (!hwnd || IsDesktop(hwnd))
+	{
+		return state;
+	}
+
+	RECT rect;
+	MONITORINFO monitor = {};
+	monitor.cbSize = sizeof(monitor);
+
+	if (!GetWindowRect(hwnd, &rect) || !GetMonitorInfo(MonitorFromWindow(hwnd, MONITOR_DEFAULTTONEAREST), &monitor))
+	{
+		return state;
+	}
+
+	state.hasWindow = true;
+	state.captioned = (GetWindowLongPtr(hwnd, GWL_STYLE) & WS_CAPTION) == WS_CAPTION;
+	state.window = { rect.left, rect.top, rect.right, rect.bottom };
+	state.monitor = { monitor.rcMonitor.left, monitor.rcMonitor.top, monitor.rcMonitor.right, monitor.rcMonitor.bottom };
+
+	if (withProcessName)
+	{
+		state.processName = GetProcessName(hwnd);
+	}
+
+	return state;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "OverlayPolicy.h"
+
+// Reads the state of the foreground window and of the shell for the overlay policy
+class ForegroundProbe
+{
+public:
+	// The process name needs to open the process, so it's only read when asked for
+	static ForegroundState Read(bool withProcessName);
+};
@@ -0,0 +1,187 @@
+// ReSharper disable CppCStyleCast
+#include "FrameClock.h"
+
+#include <dwmapi.h>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+FrameClock::FrameClock(HWND target, UINT message)
+	: _target(target), _message(message)
+{
+	_runEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	_msPerTick = 1000.0 / (double)frequency.QuadPart;
+}
+
+FrameClock::~FrameClock()
+{
+	Shutdown();
+
+	if (_runEvent)
+	{
+		CloseHandle(_runEvent);
+	}
+}
+
+double FrameClock::Now() const
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * _msPerTick;
+}
+
+void FrameClock::Start()
+{
+	if (!_runEvent)
+	{
+		return;
+	}
+
+	// The thread is created on first use, once the derived class is fully constructed
+	if (!_thread.joinable())
+	{
+		_thread = std::thread(&FrameClock::Run, this);
+	}
+
+	_framePending = false;
+	_running = true;
+	SetEvent(_runEvent);
+}
+
+void FrameClock::Stop()
+{
+	_running = false;
+
+	if (_runEvent)
+	{
+		ResetEvent(_runEvent);
+	}
+}
+
+void FrameClock::Shutdown()
+{
+	if (!_thread.joinable())
+	{
+		return;
+	}
+
+	_quit = true;
+	SetEvent(_runEvent);
+	_thread.join();
+}
+
+void FrameClock::Run()
+{
+	while (true)
+	{
+		WaitForSingleObject(_runEvent, INFINITE);
+
+		if (_quit)
+		{
+			return;
+		}
+
+		WaitForFrame();
+		_wakeups.fetch_add(1, std::memory_order_relaxed);
+
+		if (_quit)
+		{
+			return;
+		}
+
+		if (_running && !_framePending.exchange(true))
+		{
+			PostMessage(_target, _message, 0, 0);
+		}
+	}
+}
+
+QpcClock::QpcClock(HWND target, UINT message)
+	: FrameClock(target, message)
+{
+	// High-resolution timers need Windows 10 1803, older versions get the default timer resolution
+	_timer = CreateWaitableTimerEx(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+	if (!_timer)
+	{
+		_timer = CreateWaitableTimerEx(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+	}
+}
+
+QpcClock::~QpcClock()
+{
+	Shutdown();
+
+	if (_timer)
+	{
+		CloseHandle(_timer);
+	}
+}
+
+void QpcClock::WaitForFrame()
+{
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -FrameInterval; // Relative
+
+	if (!_timer || !SetWaitableTimer(_timer, &dueTime, 0, nullptr, nullptr, FALSE))
+	{
+		Sleep(16);
+		return;
+	}
+
+	WaitForSingleObject(_timer, INFINITE);
+}
+
+VsyncClock::VsyncClock(HWND target, UINT message)
+	: FrameClock(target, message)
+{
+}
+
+VsyncClock::~VsyncClock()
+{
+	Shutdown();
+}
+
+void VsyncClock::WaitForFrame()
+{
+	// DwmFlush fails when composition is unavailable, fall back to a ~60 Hz sleep
+	if (FAILED(DwmFlush()))
+	{
+		Sleep(16);
+	}
+}
+
+CoalescingClock::CoalescingClock(HWND target, UINT message, const uint32_t intervalMs, const uint32_t toleranceMs)
+	: FrameClock(target, message), _intervalMs(intervalMs), _toleranceMs(toleranceMs)
+{
+	// Not high resolution, those timers can't be coalesced
+	_timer = CreateWaitableTimerEx(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+}
+
+CoalescingClock::~CoalescingClock()
+{
+	Shutdown();
+
+	if (_timer)
+	{
+		CloseHandle(_timer);
+	}
+}
+
+void CoalescingClock::WaitForFrame()
+{
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -(LONGLONG)_intervalMs * 10000; // Relative, in 100ns units
+
+	if (!_timer || !SetWaitableTimerEx(_timer, &dueTime, 0, nullptr, nullptr, nullptr, _toleranceMs))
+	{
+		Sleep(_intervalMs);
+		return;
+	}
+
+	WaitForSingleObject(_timer, INFINITE);
+}
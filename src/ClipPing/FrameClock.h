@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <windows.h>
+
+#include "Animation.h"
+
+// Animation clock that also paces the frames: while started, a worker thread posts a frame message
+// to the target window once per frame. Time comes from QueryPerformanceCounter.
+class FrameClock : public AnimationClock
+{
+public:
+	FrameClock(HWND target, UINT message);
+	~FrameClock() override;
+
+	FrameClock(const FrameClock&) = delete;
+	FrameClock& operator=(const FrameClock&) = delete;
+
+	double Now() const override;
+
+	void Start();
+	void Stop();
+
+	// Called when the frame message is handled. Frames are skipped while one is pending,
+	// so they don't pile up when the window thread is busy.
+	void FrameHandled() { _framePending = false; }
+
+	// Times the worker thread woke up for a frame, whether it posted one or not
+	uint64_t GetWakeups() const { return _wakeups.load(std::memory_order_relaxed); }
+
+protected:
+	// Blocks the worker thread until the next frame is due
+	virtual void WaitForFrame() = 0;
+
+	// Derived classes must call this from their destructor, before WaitForFrame becomes unusable
+	void Shutdown();
+
+private:
+	void Run();
+
+	HWND _target;
+	UINT _message;
+	HANDLE _runEvent;
+	std::thread _thread;
+	std::atomic<bool> _running = false;
+	std::atomic<bool> _quit = false;
+	std::atomic<bool> _framePending = false;
+	std::atomic<uint64_t> _wakeups = 0;
+	double _msPerTick;
+};
+
+// Fixed 60 Hz frames from a high-resolution waitable timer
+class QpcClock final : public FrameClock
+{
+public:
+	QpcClock(HWND target, UINT message);
+	~QpcClock() override;
+
+protected:
+	void WaitForFrame() override;
+
+private:
+	static constexpr LONGLONG FrameInterval = 166667; // In 100ns units
+
+	HANDLE _timer;
+};
+
+// Frames aligned with the display refresh, using DwmFlush to wait for the next composition
+class VsyncClock final : public FrameClock
+{
+public:
+	VsyncClock(HWND target, UINT message);
+	~VsyncClock() override;
+
+protected:
+	void WaitForFrame() override;
+};
+
+// Low frame rate on a timer the system may delay to coalesce it with other wakeups, so the CPU
+// stays longer in deep idle states. Used to save power.
+class CoalescingClock final : public FrameClock
+{
+public:
+	CoalescingClock(HWND target, UINT message, uint32_t intervalMs, uint32_t toleranceMs);
+	~CoalescingClock() override;
+
+protected:
+	void WaitForFrame() override;
+
+private:
+	HANDLE _timer;
+	uint32_t _intervalMs;
+	uint32_t _toleranceMs;
+};
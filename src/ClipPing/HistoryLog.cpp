@@ -0,0 +1,353 @@
+// ReSharper disable CppCStyleCast
+#include "HistoryLog.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+static HANDLE OpenLogFile(const std::wstring& path, const DWORD disposition)
+{
+	return CreateFile(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+}
+
+HistoryLog::~HistoryLog()
+{
+	Close();
+}
+
+bool HistoryLog::Open(const std::wstring& path)
+{
+	Close();
+
+	_path = path;
+	_file = OpenLogFile(path, OPEN_ALWAYS);
+
+	LARGE_INTEGER fileSize = {};
+
+	if (_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(_file, &fileSize))
+	{
+		Close();
+		return false;
+	}
+
+	const auto size = (uint64_t)fileSize.QuadPart;
+
+	// The file is only ever truncated when it's known to be a log of this version, anything else could
+	// be a history that another build or a later attempt can still read
+	if (size > 0)
+	{
+		if (!Map(size))
+		{
+			Close();
+			return false;
+		}
+
+		switch (HistoryRecord::CheckFileHeader(_view, (size_t)size))
+		{
+		case HistoryRecord::FileEmpty:
+			_size = 0;
+			break;
+		case HistoryRecord::FileValid:
+			_size = HistoryRecord::FindEnd(_view, size);
+
+			if (_size == size)
+			{
+				return true;
+			}
+
+			break;
+		default:
+			Close();
+			return false;
+		}
+
+		Unmap();
+	}
+
+	_stats.recoveredBytes += size - _size;
+
+	LARGE_INTEGER end;
+	end.QuadPart = (LONGLONG)_size;
+
+	if (!SetFilePointerEx(_file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(_file))
+	{
+		Close();
+		return false;
+	}
+
+	if (_size == 0)
+	{
+		std::vector<uint8_t> header;
+		HistoryRecord::AppendFileHeader(header);
+
+		if (!Write(_file, 0, header.data(), header.size()))
+		{
+			Close();
+			return false;
+		}
+
+		_size = header.size();
+	}
+
+	if (!Map(_size))
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void HistoryLog::Close()
+{
+	if (_compaction.joinable())
+	{
+		_compaction.join();
+	}
+
+	Unmap();
+
+	if (_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(_file);
+		_file = INVALID_HANDLE_VALUE;
+	}
+
+	_size = 0;
+}
+
+bool HistoryLog::Map(const uint64_t size)
+{
+	_mapping = CreateFileMapping(_file, nullptr, PAGE_READONLY, (DWORD)(size >> 32), (DWORD)size, nullptr);
+
+	if (!_mapping)
+	{
+		return false;
+	}
+
+	_view = (const uint8_t*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!_view)
+	{
+		CloseHandle(_mapping);
+		_mapping = nullptr;
+		return false;
+	}
+
+	_mappedSize = size;
+	return true;
+}
+
+void HistoryLog::Unmap()
+{
+	if (_view)
+	{
+		UnmapViewOfFile(_view);
+		_view = nullptr;
+	}
+
+	if (_mapping)
+	{
+		CloseHandle(_mapping);
+		_mapping = nullptr;
+	}
+
+	_mappedSize = 0;
+}
+
+bool HistoryLog::Write(HANDLE file, const uint64_t offset, const void* data, const size_t size)
+{
+	auto bytes = (const uint8_t*)data;
+	auto position = offset;
+	auto remaining = size;
+
+	while (remaining > 0)
+	{
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)position;
+		overlapped.OffsetHigh = (DWORD)(position >> 32);
+
+		const auto chunk = (DWORD)std::min<size_t>(remaining, 1 << 30);
+		DWORD written = 0;
+
+		if (!WriteFile(file, bytes, chunk, &written, &overlapped) || written == 0)
+		{
+			return false;
+		}
+
+		bytes += written;
+		position += written;
+		remaining -= written;
+	}
+
+	return true;
+}
+
+bool HistoryLog::Append(const HistoryRecord::Header& header, const void* payload)
+{
+	std::lock_guard lock(_mutex);
+
+	if (_file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	_buffer.clear();
+	HistoryRecord::Append(header, payload, _buffer);
+
+	// A partial write leaves a torn record, which the next Open drops
+	if (!Write(_file, _size, _buffer.data(), _buffer.size()))
+	{
+		return false;
+	}
+
+	_size += _buffer.size();
+	_stats.appends++;
+	return true;
+}
+
+uint64_t HistoryLog::GetSize() const
+{
+	std::lock_guard lock(_mutex);
+	return _size;
+}
+
+bool HistoryLog::Compact(std::unordered_set<uint64_t> live)
+{
+	if (_compacting || _file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	if (_compaction.joinable())
+	{
+		_compaction.join();
+	}
+
+	_compacting = true;
+	_compaction = std::thread(&HistoryLog::RunCompaction, this, std::move(live));
+	return true;
+}
+
+void HistoryLog::RunCompaction(std::unordered_set<uint64_t> live)
+{
+	uint64_t end;
+
+	{
+		// The appends since the log was opened are past the end of the view
+		std::lock_guard lock(_mutex);
+		Unmap();
+
+		if (!Map(_size))
+		{
+			_compacting = false;
+			return;
+		}
+
+		end = _size;
+	}
+
+	// The log is append-only, so the part in the view doesn't change while it's read without the lock
+	std::unordered_map<uint64_t, uint64_t> latest;
+
+	for (uint64_t offset = HistoryRecord::FileHeaderSize; offset < end;)
+	{
+		HistoryRecord::Header header;
+		memcpy(&header, _view + offset, sizeof(header));
+
+		if (live.count(header.hash))
+		{
+			latest[header.hash] = offset;
+		}
+
+		offset += HistoryRecord::GetRecordSize(header.size);
+	}
+
+	// In the original order, which is the order of use
+	std::vector<uint64_t> offsets;
+	offsets.reserve(latest.size());
+
+	for (const auto& [hash, offset] : latest)
+	{
+		offsets.push_back(offset);
+	}
+
+	std::sort(offsets.begin(), offsets.end());
+
+	const auto temporary = _path + L".tmp";
+	const auto output = OpenLogFile(temporary, CREATE_ALWAYS);
+	bool success = output != INVALID_HANDLE_VALUE;
+
+	std::vector<uint8_t> buffer;
+	HistoryRecord::AppendFileHeader(buffer);
+	uint64_t size = 0;
+
+	if (success)
+	{
+		success = Write(output, 0, buffer.data(), buffer.size());
+		size = buffer.size();
+	}
+
+	for (size_t i = 0; i < offsets.size() && success; i++)
+	{
+		HistoryRecord::Header header;
+		memcpy(&header, _view + offsets[i], sizeof(header));
+
+		const auto recordSize = HistoryRecord::GetRecordSize(header.size);
+		success = Write(output, size, _view + offsets[i], recordSize);
+		size += recordSize;
+	}
+
+	std::lock_guard lock(_mutex);
+
+	// Carry over the records appended during the compaction
+	if (success && _size > end)
+	{
+		buffer.resize((size_t)(_size - end));
+
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)end;
+		overlapped.OffsetHigh = (DWORD)(end >> 32);
+
+		DWORD read = 0;
+		success = ReadFile(_file, buffer.data(), (DWORD)buffer.size(), &read, &overlapped) && read == buffer.size()
+			&& Write(output, size, buffer.data(), buffer.size());
+		size += buffer.size();
+	}
+
+	if (output != INVALID_HANDLE_VALUE)
+	{
+		// The new file replaces the only copy of the history
+		success = success && FlushFileBuffers(output);
+		CloseHandle(output);
+	}
+
+	if (!success)
+	{
+		DeleteFile(temporary.c_str());
+		_compacting = false;
+		return;
+	}
+
+	const auto before = _size;
+
+	Unmap();
+	CloseHandle(_file);
+
+	success = MoveFileEx(temporary.c_str(), _path.c_str(), MOVEFILE_REPLACE_EXISTING);
+
+	if (!success)
+	{
+		DeleteFile(temporary.c_str());
+	}
+
+	_file = OpenLogFile(_path, OPEN_EXISTING);
+
+	if (_file != INVALID_HANDLE_VALUE && success)
+	{
+		_size = size;
+		_stats.compactions++;
+		_stats.compactedBytes += before - size;
+	}
+
+	_compacting = false;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <windows.h>
+
+#include "HistoryRecord.h"
+
+// Append-only log of clipboard history records. The file is memory-mapped, so replaying it reads the
+// payloads in place. Opening it drops any torn or corrupt record at the end, left by a crash.
+// Superseded records are dropped by a compaction on a worker thread, which rewrites the live records
+// to a new file while appends continue, and swaps it in.
+class HistoryLog
+{
+public:
+	struct Stats
+	{
+		uint64_t appends = 0;
+		uint64_t recoveredBytes = 0; // Dropped when opening the log
+		uint64_t compactions = 0;
+		uint64_t compactedBytes = 0; // Dropped by the compactions
+	};
+
+	HistoryLog() = default;
+	~HistoryLog();
+
+	HistoryLog(const HistoryLog&) = delete;
+	HistoryLog& operator=(const HistoryLog&) = delete;
+
+	bool Open(const std::wstring& path);
+	void Close();
+
+	// Visits the records present when the log was opened, oldest first, until the callback returns false.
+	// The payload points into the mapping. Must not be called once compactions have started.
+	template <typename Func>
+	bool ForEach(Func&& func) const
+	{
+		for (uint64_t offset = HistoryRecord::FileHeaderSize; offset < _mappedSize;)
+		{
+			HistoryRecord::Header header;
+			memcpy(&header, _view + offset, sizeof(header));
+
+			if (!func(header, _view + offset + sizeof(header)))
+			{
+				return false;
+			}
+
+			offset += HistoryRecord::GetRecordSize(header.size);
+		}
+
+		return true;
+	}
+
+	bool Append(const HistoryRecord::Header& header, const void* payload);
+
+	// Starts a compaction keeping the latest record of each of the given hashes.
+	// Returns false if one is already running.
+	bool Compact(std::unordered_set<uint64_t> live);
+	bool IsCompacting() const { return _compacting; }
+
+	uint64_t GetSize() const;
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	bool Map(uint64_t size);
+	void Unmap();
+	static bool Write(HANDLE file, uint64_t offset, const void* data, size_t size);
+	void RunCompaction(std::unordered_set<uint64_t> live);
+
+	std::wstring _path;
+	HANDLE _file = INVALID_HANDLE_VALUE;
+	HANDLE _mapping = nullptr;
+	const uint8_t* _view = nullptr;
+	uint64_t _mappedSize = 0;
+	uint64_t _size = 0; // End of the last record, where the next one goes
+	std::vector<uint8_t> _buffer;
+	Stats _stats;
+
+	// Guards the file handle and the size against the end of a compaction
+	mutable std::mutex _mutex;
+	std::thread _compaction;
+	std::atomic<bool> _compacting = false;
+};
@@ -0,0 +1,92 @@
+// ReSharper disable CppCStyleCast
+#include "HistoryRecord.h"
+
+#include <cstring>
+
+#include "ContentHasher.h"
+
+void HistoryRecord::AppendFileHeader(std::vector<uint8_t>& output)
+{
+	uint8_t header[FileHeaderSize] = {};
+	memcpy(header, FileMagic, sizeof(FileMagic));
+	memcpy(header + sizeof(FileMagic), &Version, sizeof(Version));
+
+	output.insert(output.end(), header, header + FileHeaderSize);
+}
+
+HistoryRecord::FileStatus HistoryRecord::CheckFileHeader(const uint8_t* data, const size_t size)
+{
+	std::vector<uint8_t> expected;
+	AppendFileHeader(expected);
+
+	// A crash while the file was being created leaves part of the header
+	if (size < FileHeaderSize)
+	{
+		return memcmp(data, expected.data(), size) == 0 ? FileEmpty : FileInvalid;
+	}
+
+	if (memcmp(data, FileMagic, sizeof(FileMagic)) != 0)
+	{
+		return FileInvalid;
+	}
+
+	return memcmp(data, expected.data(), FileHeaderSize) == 0 ? FileValid : FileUnknownVersion;
+}
+
+uint64_t HistoryRecord::Checksum(Header header, const void* payload)
+{
+	header.checksum = 0;
+
+	ContentHasher hasher;
+	hasher.Update(&header, sizeof(header));
+	hasher.Update(payload, header.size);
+	return hasher.Finish();
+}
+
+void HistoryRecord::Append(Header header, const void* payload, std::vector<uint8_t>& output)
+{
+	header.magic = RecordMagic;
+	memset(header.reserved, 0, sizeof(header.reserved));
+	header.checksum = Checksum(header, payload);
+
+	const auto offset = output.size();
+	output.resize(offset + GetRecordSize(header.size), 0);
+	memcpy(output.data() + offset, &header, sizeof(header));
+
+	if (header.size > 0)
+	{
+		memcpy(output.data() + offset + sizeof(header), payload, header.size);
+	}
+}
+
+size_t HistoryRecord::Validate(const uint8_t* data, const size_t size)
+{
+	Header header;
+
+	if (size < sizeof(header))
+	{
+		return 0;
+	}
+
+	memcpy(&header, data, sizeof(header));
+
+	if (header.magic != RecordMagic || header.kind > PayloadText16
+		|| header.size > size - sizeof(header) || GetRecordSize(header.size) > size)
+	{
+		return 0;
+	}
+
+	return Checksum(header, data + sizeof(header)) == header.checksum ? GetRecordSize(header.size) : 0;
+}
+
+uint64_t HistoryRecord::FindEnd(const uint8_t* data, const uint64_t size)
+{
+	auto end = (uint64_t)FileHeaderSize;
+
+	while (const auto recordSize = Validate(data + end, (size_t)(size - end)))
+	{
+		end += recordSize;
+	}
+
+	return end;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ClipboardHistory.h"
+
+// On-disk layout of the clipboard history log: a file header, then the records back to back. A record
+// is a fixed header followed by the payload, padded to 8 bytes, and carries a checksum of both so that
+// a torn or corrupt record at the end of the log is detected when it's opened.
+class HistoryRecord
+{
+public:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t size; // Payload bytes
+		uint64_t hash; // Content hash, as computed by ClipboardHistory
+		uint64_t time;
+		uint32_t format;
+		PayloadKind kind;
+		uint8_t reserved[3];
+		uint64_t checksum; // XXH64 of the header, with this field at 0, and of the payload
+	};
+
+	static_assert(sizeof(Header) == 40);
+
+	enum FileStatus : uint8_t
+	{
+		FileEmpty, // Nothing but possibly a torn file header, a new one can be written
+		FileValid,
+		FileUnknownVersion, // Written by another build, which may still want it
+		FileInvalid, // Not a history log
+	};
+
+	static constexpr size_t FileHeaderSize = 16;
+	static constexpr size_t Alignment = 8;
+
+	static constexpr size_t GetRecordSize(const size_t payloadSize)
+	{
+		return sizeof(Header) + (payloadSize + Alignment - 1) / Alignment * Alignment;
+	}
+
+	static void AppendFileHeader(std::vector<uint8_t>& output);
+	static FileStatus CheckFileHeader(const uint8_t* data, size_t size);
+
+	// Appends the record, filling in the magic and the checksum of the header
+	static void Append(Header header, const void* payload, std::vector<uint8_t>& output);
+
+	// Returns the size of the record at 'data', or 0 if it's incomplete or corrupt
+	static size_t Validate(const uint8_t* data, size_t size);
+
+	// Returns the end of the last record that validates in a log with a valid file header. Everything
+	// after the first bad record is lost: a torn append only ever affects the last one.
+	static uint64_t FindEnd(const uint8_t* data, uint64_t size);
+
+private:
+	static constexpr uint8_t FileMagic[8] = { 'C', 'L', 'I', 'P', 'H', 'I', 'S', 'T' };
+	static constexpr uint32_t Version = 1;
+	static constexpr uint32_t RecordMagic = 0x52485043; // "CPHR"
+
+	static uint64_t Checksum(Header header, const void* payload);
+};
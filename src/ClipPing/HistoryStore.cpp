@@ -0,0 +1,157 @@
+// ReSharper disable CppCStyleCast
+#include "HistoryStore.h"
+
+#include <unordered_set>
+#include <vector>
+
+HistoryStore::~HistoryStore()
+{
+	Stop();
+}
+
+void HistoryStore::Load(const std::wstring& directory, HWND target, UINT message)
+{
+	if (_loader.joinable() || _loaded || directory.empty())
+	{
+		return;
+	}
+
+	// A previous Stop() would end the replay right away
+	_stopping = false;
+	_target = target;
+	_message = message;
+	_loader = std::thread(&HistoryStore::Run, this, directory + L"\\" + FileName, _history->GetBudget());
+}
+
+void HistoryStore::Run(std::wstring path, const size_t budget)
+{
+	if (_log.Open(path))
+	{
+		auto history = std::make_unique<ClipboardHistory>(budget);
+
+		const bool completed = _log.ForEach([&](const HistoryRecord::Header& header, const uint8_t* payload)
+		{
+			history->Add(header.format, payload, header.size, header.kind, header.time);
+			return !_stopping;
+		});
+
+		if (completed)
+		{
+			_replayed = std::move(history);
+		}
+	}
+
+	PostMessage(_target, _message, 0, 0);
+}
+
+void HistoryStore::OnLoaded()
+{
+	if (!_loader.joinable())
+	{
+		return;
+	}
+
+	_loader.join();
+
+	if (!_replayed)
+	{
+		// The history stays in memory only
+		_log.Close();
+		return;
+	}
+
+	// The entries recorded while loading are newer than the ones in the log
+	std::vector<uint64_t> ids;
+	_history->ForEach([&](const ClipboardHistory::Entry& entry)
+	{
+		ids.push_back(entry.id);
+		return true;
+	});
+
+	_replayed->SetBudget(_history->GetBudget());
+	std::unique_ptr<ClipboardHistory> recent = std::move(_history);
+	_history = std::move(_replayed);
+	_loaded = true;
+
+	std::vector<uint8_t> data;
+
+	for (auto it = ids.rbegin(); it != ids.rend(); ++it)
+	{
+		const auto entry = recent->Find(*it);
+
+		if (entry && recent->Get(*it, data))
+		{
+			Add(entry->format, data.data(), data.size(), entry->kind, entry->time);
+		}
+	}
+}
+
+void HistoryStore::Stop()
+{
+	_stopping = true;
+
+	if (_loader.joinable())
+	{
+		_loader.join();
+	}
+
+	_log.Close();
+}
+
+uint64_t HistoryStore::Add(const uint32_t format, const void* data, const size_t size, const PayloadKind kind, const uint64_t time)
+{
+	const auto id = _history->Add(format, data, size, kind, time);
+
+	if (id != 0 && _loaded)
+	{
+		// Repeated copies are appended again, that's how the log keeps track of the order of use
+		Persist(id, data);
+		MaybeCompact();
+	}
+
+	return id;
+}
+
+void HistoryStore::SetBudget(const size_t budgetBytes)
+{
+	_history->SetBudget(budgetBytes);
+}
+
+void HistoryStore::Persist(const uint64_t id, const void* data)
+{
+	const auto entry = _history->Find(id);
+
+	HistoryRecord::Header header = {};
+	header.size = entry->size;
+	header.hash = entry->hash;
+	header.time = entry->time;
+	header.format = entry->format;
+	header.kind = entry->kind;
+
+	_log.Append(header, data);
+}
+
+void HistoryStore::MaybeCompact()
+{
+	if (_log.IsCompacting())
+	{
+		return;
+	}
+
+	const auto liveBytes = _history->GetStats().payloadBytes + _history->GetCount() * HistoryRecord::GetRecordSize(0);
+	const auto size = _log.GetSize();
+
+	if (size < MinCompactionBytes || size < 2 * liveBytes)
+	{
+		return;
+	}
+
+	std::unordered_set<uint64_t> live;
+	_history->ForEach([&](const ClipboardHistory::Entry& entry)
+	{
+		live.insert(entry.hash);
+		return true;
+	});
+
+	_log.Compact(std::move(live));
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <windows.h>
+
+#include "ClipboardHistory.h"
+#include "HistoryLog.h"
+
+// Clipboard history persisted to an append-only log in the settings directory. The log is opened and
+// replayed on a worker thread, so that a large history doesn't slow down the startup; entries recorded
+// in the meantime are kept in memory, and merged into the loaded history when it's ready.
+class HistoryStore
+{
+public:
+	HistoryStore() = default;
+	~HistoryStore();
+
+	HistoryStore(const HistoryStore&) = delete;
+	HistoryStore& operator=(const HistoryStore&) = delete;
+
+	// Starts loading the log, the message is posted to the target window when it's done.
+	// Does nothing if it was already started.
+	void Load(const std::wstring& directory, HWND target, UINT message);
+
+	// Called when the message is handled
+	void OnLoaded();
+	void Stop();
+
+	uint64_t Add(uint32_t format, const void* data, size_t size, PayloadKind kind, uint64_t time);
+	void SetBudget(size_t budgetBytes);
+
+	const ClipboardHistory& GetHistory() const { return *_history; }
+	const HistoryLog& GetLog() const { return _log; }
+	bool IsLoaded() const { return _loaded; }
+
+	static constexpr const wchar_t* FileName = L"history.dat";
+
+	// The log is compacted once it's twice as large as the live records, and above this size
+	static constexpr uint64_t MinCompactionBytes = 4 * 1024 * 1024;
+
+private:
+	void Run(std::wstring path, size_t budget);
+	void Persist(uint64_t id, const void* data);
+	void MaybeCompact();
+
+	std::unique_ptr<ClipboardHistory> _history = std::make_unique<ClipboardHistory>(0);
+	std::unique_ptr<ClipboardHistory> _replayed; // Handed over by the loader
+	HistoryLog _log;
+	std::thread _loader;
+	std::atomic<bool> _stopping = false;
+	HWND _target = nullptr;
+	UINT _message = 0;
+	bool _loaded = false;
+};
@@ -0,0 +1,286 @@
+// ReSharper disable CppCStyleCast
+#include "IniFile.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+void IniFile::Parse(const std::string_view text)
+{
+	_lines.clear();
+	_dirty = false;
+	_newline = "\r\n";
+
+	// UTF-8 byte order mark, written back by Serialize
+	_bom = text.substr(0, Bom.size()) == Bom;
+	size_t position = _bom ? Bom.size() : 0;
+
+	bool newlineDetected = false;
+
+	while (position < text.size())
+	{
+		auto end = text.find('\n', position);
+
+		if (end == std::string_view::npos)
+		{
+			end = text.size();
+		}
+
+		auto raw = text.substr(position, end - position);
+		position = end + 1;
+
+		const bool carriageReturn = !raw.empty() && raw.back() == '\r';
+
+		while (!raw.empty() && raw.back() == '\r')
+		{
+			raw.remove_suffix(1);
+		}
+
+		if (!newlineDetected && end < text.size())
+		{
+			_newline = carriageReturn ? "\r\n" : "\n";
+			newlineDetected = true;
+		}
+
+		Line line;
+		line.text = raw;
+
+		const auto content = Trim(raw);
+
+		if (content.empty() || content[0] == ';' || content[0] == '#')
+		{
+			line.kind = LineOther;
+		}
+		else if (content[0] == '[')
+		{
+			const auto close = content.find(']');
+			line.kind = LineSection;
+			line.name = Trim(content.substr(1, close == std::string_view::npos ? std::string_view::npos : close - 1));
+		}
+		else if (const auto equals = content.find('='); equals != std::string_view::npos)
+		{
+			auto value = Trim(content.substr(equals + 1));
+
+			if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front())
+			{
+				value = value.substr(1, value.size() - 2);
+			}
+
+			line.kind = LineEntry;
+			line.name = Trim(content.substr(0, equals));
+			line.value = value;
+		}
+
+		_lines.push_back(std::move(line));
+	}
+}
+
+std::string IniFile::Serialize() const
+{
+	std::string text(_bom ? Bom : std::string_view());
+
+	for (const auto& line : _lines)
+	{
+		text += line.text;
+		text += _newline;
+	}
+
+	return text;
+}
+
+bool IniFile::Read(const std::filesystem::path& path)
+{
+	std::ifstream file(path, std::ios::binary);
+
+	if (!file)
+	{
+		Parse({});
+		return false;
+	}
+
+	const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (file.bad())
+	{
+		Parse({});
+		return false;
+	}
+
+	Parse(text);
+	return true;
+}
+
+bool IniFile::Write(const std::filesystem::path& path)
+{
+	auto temporary = path;
+	temporary += ".tmp";
+
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		const auto text = Serialize();
+		file.write(text.data(), (std::streamsize)text.size());
+		file.close();
+
+		if (!file)
+		{
+			std::error_code error;
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+
+	_dirty = false;
+	return true;
+}
+
+std::string IniFile::GetString(const std::string_view section, const std::string_view key, const std::string_view defaultValue) const
+{
+	bool found;
+	const auto index = FindEntry(section, key, found);
+	return std::string(found ? std::string_view(_lines[(size_t)index].value) : defaultValue);
+}
+
+int32_t IniFile::GetInt(const std::string_view section, const std::string_view key, const int32_t defaultValue) const
+{
+	bool found;
+	const auto index = FindEntry(section, key, found);
+
+	if (!found)
+	{
+		return defaultValue;
+	}
+
+	const auto& value = _lines[(size_t)index].value;
+	return (int32_t)strtol(value.c_str(), nullptr, 10);
+}
+
+void IniFile::SetString(const std::string_view section, const std::string_view key, const std::string_view value)
+{
+	bool found;
+	const auto index = FindEntry(section, key, found);
+
+	if (found)
+	{
+		auto& line = _lines[(size_t)index];
+
+		if (line.value == value)
+		{
+			return;
+		}
+
+		line.value = value;
+		line.text = line.name + "=" + line.value;
+		_dirty = true;
+		return;
+	}
+
+	Line entry;
+	entry.kind = LineEntry;
+	entry.name = key;
+	entry.value = value;
+	entry.text = entry.name + "=" + entry.value;
+
+	if (index < 0)
+	{
+		Line header;
+		header.kind = LineSection;
+		header.name = section;
+		header.text = "[" + header.name + "]";
+
+		_lines.push_back(std::move(header));
+		_lines.push_back(std::move(entry));
+	}
+	else
+	{
+		_lines.insert(_lines.begin() + index, std::move(entry));
+	}
+
+	_dirty = true;
+}
+
+void IniFile::SetInt(const std::string_view section, const std::string_view key, const int32_t value)
+{
+	SetString(section, key, std::to_string(value));
+}
+
+int64_t IniFile::FindEntry(const std::string_view section, const std::string_view key, bool& found) const
+{
+	found = false;
+	int64_t insertAt = -1;
+	bool inSection = false;
+
+	for (size_t i = 0; i < _lines.size(); i++)
+	{
+		const auto& line = _lines[i];
+
+		if (line.kind == LineSection)
+		{
+			// Like the Win32 API, only the first section with a given name is used
+			if (inSection)
+			{
+				break;
+			}
+
+			inSection = EqualsIgnoreCase(line.name, section);
+		}
+		else if (inSection && line.kind == LineEntry && EqualsIgnoreCase(line.name, key))
+		{
+			found = true;
+			return (int64_t)i;
+		}
+
+		// New entries go after the last entry of the section, before any trailing blank lines
+		if (inSection && line.kind != LineOther)
+		{
+			insertAt = (int64_t)i + 1;
+		}
+	}
+
+	return insertAt;
+}
+
+std::string_view IniFile::Trim(std::string_view text)
+{
+	while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+	{
+		text.remove_prefix(1);
+	}
+
+	while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+	{
+		text.remove_suffix(1);
+	}
+
+	return text;
+}
+
+bool IniFile::EqualsIgnoreCase(const std::string_view left, const std::string_view right)
+{
+	if (left.size() != right.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < left.size(); i++)
+	{
+		const auto l = left[i] >= 'A' && left[i] <= 'Z' ? left[i] + ('a' - 'A') : left[i];
+		const auto r = right[i] >= 'A' && right[i] <= 'Z' ? right[i] + ('a' - 'A') : right[i];
+
+		if (l != r)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
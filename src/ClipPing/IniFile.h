@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Parsed INI file, read once and queried in memory. Lookups follow GetPrivateProfileString: section
+// and key names are case-insensitive, and whitespace and surrounding quotes are trimmed from values.
+// Lines that aren't modified are written back verbatim, so comments, layout and a UTF-8 byte order mark
+// survive a save.
+class IniFile
+{
+public:
+	void Parse(std::string_view text);
+	std::string Serialize() const;
+
+	// Returns false if the file can't be read, leaving the model empty
+	bool Read(const std::filesystem::path& path);
+
+	// Writes to a temporary file next to the target, then renames it over the target,
+	// so readers never see a partially written file. Clears the dirty flag on success.
+	bool Write(const std::filesystem::path& path);
+
+	std::string GetString(std::string_view section, std::string_view key, std::string_view defaultValue) const;
+
+	// Parses the leading integer of the value like GetPrivateProfileInt, 0 if it isn't a number
+	int32_t GetInt(std::string_view section, std::string_view key, int32_t defaultValue) const;
+
+	// The model only becomes dirty if the value actually changes
+	void SetString(std::string_view section, std::string_view key, std::string_view value);
+	void SetInt(std::string_view section, std::string_view key, int32_t value);
+
+	bool IsDirty() const { return _dirty; }
+
+private:
+	enum LineKind : uint8_t { LineOther, LineSection, LineEntry };
+
+	static constexpr std::string_view Bom = "\xEF\xBB\xBF";
+
+	struct Line
+	{
+		LineKind kind = LineOther;
+		std::string text; // Verbatim, without the line break
+		std::string name; // Section name or key
+		std::string value;
+	};
+
+	// Index of the entry, or of the line to insert it before when it doesn't exist. Returns -1 if the section doesn't exist.
+	int64_t FindEntry(std::string_view section, std::string_view key, bool& found) const;
+
+	static std::string_view Trim(std::string_view text);
+	static bool EqualsIgnoreCase(std::string_view left, std::string_view right);
+
+	std::vector<Line> _lines;
+	const char* _newline = "\r\n";
+	bool _bom = false;
+	bool _dirty = false;
+};
@@ -0,0 +1,235 @@
+// ReSharper disable CppCStyleCast
+#include "LzCodec.h"
+
+#include <bit>
+#include <cstring>
+
+static uint32_t Read32(const uint8_t* data)
+{
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static uint64_t Read64(const uint8_t* data)
+{
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+// Writes the extra bytes of a length that doesn't fit in its 4-bit token field
+static uint8_t* WriteLength(uint8_t* output, size_t length)
+{
+	for (; length >= 255; length -= 255)
+	{
+		*output++ = 255;
+	}
+
+	*output++ = (uint8_t)length;
+	return output;
+}
+
+// Length of the common prefix of the two positions, stopping at 'end'
+static size_t MatchLength(const uint8_t* source, const size_t position, const size_t reference, const size_t end)
+{
+	size_t length = 0;
+
+	while (position + length + 8 <= end)
+	{
+		const auto difference = Read64(source + position + length) ^ Read64(source + reference + length);
+
+		if (difference != 0)
+		{
+			return length + (size_t)std::countr_zero(difference) / 8;
+		}
+
+		length += 8;
+	}
+
+	while (position + length < end && source[position + length] == source[reference + length])
+	{
+		length++;
+	}
+
+	return length;
+}
+
+static uint8_t* WriteSequence(uint8_t* output, const uint8_t* literals, const size_t literalCount, const size_t offset, const size_t matchLength)
+{
+	auto token = output++;
+	*token = (uint8_t)((literalCount < 15 ? literalCount : 15) << 4);
+
+	if (literalCount >= 15)
+	{
+		output = WriteLength(output, literalCount - 15);
+	}
+
+	if (literalCount > 0)
+	{
+		memcpy(output, literals, literalCount);
+		output += literalCount;
+	}
+
+	// The last sequence only has literals
+	if (matchLength == 0)
+	{
+		return output;
+	}
+
+	*output++ = (uint8_t)offset;
+	*output++ = (uint8_t)(offset >> 8);
+
+	const auto length = matchLength - 4;
+	*token |= (uint8_t)(length < 15 ? length : 15);
+
+	if (length >= 15)
+	{
+		output = WriteLength(output, length - 15);
+	}
+
+	return output;
+}
+
+size_t LzCodec::Compress(const uint8_t* source, const size_t size, uint8_t* destination, const size_t capacity)
+{
+	if (capacity < MaxCompressedSize(size))
+	{
+		return 0;
+	}
+
+	auto output = destination;
+	size_t anchor = 0;
+
+	if (size > MatchFindLimit)
+	{
+		// Positions + 1, so that 0 means empty
+		uint32_t table[1 << HashBits] = {};
+
+		const auto matchEnd = size - LastLiterals;
+		size_t position = 0;
+
+		while (position + MatchFindLimit <= size)
+		{
+			const auto sequence = Read32(source + position);
+			const auto hash = (sequence * 2654435761u) >> (32 - HashBits);
+			const auto candidate = (size_t)table[hash];
+			table[hash] = (uint32_t)(position + 1);
+
+			if (candidate == 0 || position - (candidate - 1) > MaxOffset || Read32(source + candidate - 1) != sequence)
+			{
+				position++;
+				continue;
+			}
+
+			const auto reference = candidate - 1;
+			const auto length = MinMatch + MatchLength(source, position + MinMatch, reference + MinMatch, matchEnd);
+
+			output = WriteSequence(output, source + anchor, position - anchor, position - reference, length);
+			position += length;
+			anchor = position;
+		}
+	}
+
+	output = WriteSequence(output, source + anchor, size - anchor, 0, 0);
+	return (size_t)(output - destination);
+}
+
+bool LzCodec::Decompress(const uint8_t* source, const size_t sourceSize, uint8_t* destination, const size_t size)
+{
+	const auto inputEnd = source + sourceSize;
+	auto input = source;
+	size_t written = 0;
+
+	while (input < inputEnd)
+	{
+		const auto token = *input++;
+		size_t literals = token >> 4;
+
+		if (literals == 15)
+		{
+			uint8_t extra;
+
+			do
+			{
+				if (input >= inputEnd)
+				{
+					return false;
+				}
+
+				extra = *input++;
+				literals += extra;
+			}
+			while (extra == 255);
+		}
+
+		if (literals > (size_t)(inputEnd - input) || literals > size - written)
+		{
+			return false;
+		}
+
+		if (literals > 0)
+		{
+			memcpy(destination + written, input, literals);
+			input += literals;
+			written += literals;
+		}
+
+		if (input == inputEnd)
+		{
+			break;
+		}
+
+		if (inputEnd - input < 2)
+		{
+			return false;
+		}
+
+		const size_t offset = input[0] | (size_t)input[1] << 8;
+		input += 2;
+
+		size_t length = (token & 0x0F) + MinMatch;
+
+		if ((token & 0x0F) == 15)
+		{
+			uint8_t extra;
+
+			do
+			{
+				if (input >= inputEnd)
+				{
+					return false;
+				}
+
+				extra = *input++;
+				length += extra;
+			}
+			while (extra == 255);
+		}
+
+		if (offset == 0 || offset > written || length > size - written)
+		{
+			return false;
+		}
+
+		// Overlapping copies repeat the last 'offset' bytes, so they have to go byte by byte
+		const auto from = destination + written - offset;
+		auto to = destination + written;
+
+		if (offset >= length)
+		{
+			memcpy(to, from, length);
+		}
+		else
+		{
+			for (size_t i = 0; i < length; i++)
+			{
+				to[i] = from[i];
+			}
+		}
+
+		written += length;
+	}
+
+	return written == size;
+}
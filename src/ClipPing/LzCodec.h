@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Byte-oriented LZ77 codec producing LZ4 block format: greedy matching over a 64 KB window with a
+// single-entry hash table. Fast enough to compress clipboard text inline, and text typically shrinks 2-4x.
+class LzCodec
+{
+public:
+	// Size of the output buffer that Compress needs in the worst case (incompressible input)
+	static constexpr size_t MaxCompressedSize(const size_t size) { return size + size / 255 + 16; }
+
+	// Returns the compressed size, or 0 if the output buffer is too small
+	static size_t Compress(const uint8_t* source, size_t size, uint8_t* destination, size_t capacity);
+
+	// Decompresses exactly 'size' bytes, returns false if the input is malformed or doesn't match the size
+	static bool Decompress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t size);
+
+private:
+	static constexpr int HashBits = 12;
+	static constexpr size_t MinMatch = 4;
+	static constexpr size_t MaxOffset = 65535;
+
+	// Format constraints: the last match starts at least 12 bytes before the end, the last 5 bytes are literals
+	static constexpr size_t MatchFindLimit = 12;
+	static constexpr size_t LastLiterals = 5;
+};
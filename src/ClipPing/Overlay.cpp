@@ -5,29 +5,33 @@
 #define NOMINMAX
 
 #include <windows.h>
-#include <gdiplus.h>
 #include <dwmapi.h>
+#include <shellscalingapi.h>
 
 #include "Overlay.h"
+#include "Rasterizer.h"
 #include "Settings.h"
+#include "Trace.h"
 
-using namespace Gdiplus;
+thread_local Overlay* Overlay::s_tracking = nullptr;
 
-constexpr double Overlay::EaseOutCubic(const double t)
+static PowerState ReadPowerState()
 {
-	const double u = 1.0 - t;
-	return 1.0 - u * u * u;
-}
+	PowerState state;
+	SYSTEM_POWER_STATUS status;
 
-constexpr double Overlay::EaseInCubic(const double t)
-{
-	return t * t * t;
+	if (GetSystemPowerStatus(&status))
+	{
+		state.onBattery = status.ACLineStatus == 0;
+		state.batterySaver = status.SystemStatusFlag != 0;
+	}
+
+	return state;
 }
 
-RECT Overlay::GetForegroundWindowRect()
+RECT Overlay::GetWindowBounds(const HWND hwnd)
 {
 	RECT rect = {};
-	const auto hwnd = GetForegroundWindow();
 
 	if (!hwnd)
 	{
@@ -45,350 +49,470 @@ RECT Overlay::GetForegroundWindowRect()
 }
 
 Overlay::Overlay(const Settings& settings)
-	: _settings(settings)
+	: _settings(settings), _renderer(_target, 0)
 {
 }
 
 Overlay::~Overlay()
 {
-	if (_bitmap)
-	{
-		DeleteObject(_bitmap);
-	}
+	StopTracking();
 }
 
-void Overlay::UpdateAlpha(int32_t alpha) const
+void Overlay::UpdateAlpha(int32_t alpha)
 {
-	if (!_hwnd || !_bitmap)
+	if (_layerCount == 0)
 	{
 		return;
 	}
 
-	alpha = std::clamp(alpha, 0, 255);
+	alpha = std::clamp(alpha, 0, 255) * _peakAlpha / 255;
+	_context.Present((uint8_t)alpha);
+}
+
+HBITMAP Overlay::AcquireBitmap(const int32_t width, const int32_t height, const Strip& strip, const int32_t stripIndex)
+{
+	const auto entry = _renderer.Render(_settings.overlayType, _settings.overlayColor, width, height, strip, stripIndex, _style);
+	return entry ? (HBITMAP)entry->handle : nullptr;
+}
 
-	const auto deviceContext = GetDC(nullptr);
+const DrawList* Overlay::ResolveStyle(const RECT& bounds)
+{
+	const auto& style = _settings.customStyle;
 
-	if (!deviceContext)
+	if (!style)
 	{
-		return;
+		return nullptr;
 	}
 
-	const auto memoryDeviceContext = CreateCompatibleDC(deviceContext);
+	UINT dpiX = USER_DEFAULT_SCREEN_DPI;
+	UINT dpiY = USER_DEFAULT_SCREEN_DPI;
+	GetDpiForMonitor(MonitorFromRect(&bounds, MONITOR_DEFAULTTONEAREST), MDT_EFFECTIVE_DPI, &dpiX, &dpiY);
 
-	if (!memoryDeviceContext)
+	// Resolving only scales the compiled bands, but keeping the list keeps its id and so the cached surfaces
+	if (style->GetSerial() != _drawListSerial || dpiX != _drawListDpi)
 	{
-		ReleaseDC(nullptr, deviceContext);
-		return;
+		_drawList = style->Resolve(dpiX);
+		_drawListSerial = style->GetSerial();
+		_drawListDpi = dpiX;
 	}
 
-	const auto old = (HBITMAP)SelectObject(memoryDeviceContext, _bitmap);
-
-	POINT ptSrc = { 0, 0 };
-	SIZE sizeWnd = { _bitmapWidth, _bitmapHeight };
+	return &_drawList;
+}
 
-	BLENDFUNCTION blend = {};
-	blend.BlendOp = AC_SRC_OVER;
-	blend.SourceConstantAlpha = (BYTE)alpha;
-	blend.AlphaFormat = AC_SRC_ALPHA;
+bool Overlay::PrepareLayer(Layer& layer, const POINT origin, const int32_t width, const int32_t height, const Strip& strip, const int32_t stripIndex)
+{
+	layer.position = { origin.x + strip.x, origin.y + strip.y };
+	layer.size = { strip.width, strip.height };
 
-	RECT rc;
-	GetWindowRect(_hwnd, &rc);
-	POINT ptDst = { rc.left, rc.top };
+	if (!layer.hwnd)
+	{
+		layer.hwnd = CreateWindowEx(
+			WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE,
+			L"ClipPingOverlay", L"",
+			WS_POPUP | WS_VISIBLE,
+			layer.position.x, layer.position.y, layer.size.cx, layer.size.cy,
+			nullptr, nullptr, GetModuleHandle(nullptr), this);
+	}
+	else
+	{
+		SetWindowPos(layer.hwnd, HWND_TOPMOST, layer.position.x, layer.position.y, layer.size.cx, layer.size.cy, SWP_NOACTIVATE | SWP_SHOWWINDOW);
+	}
 
-	UpdateLayeredWindow(_hwnd, deviceContext, &ptDst, &sizeWnd, memoryDeviceContext, &ptSrc, 0, &blend, ULW_ALPHA);
+	if (!layer.hwnd)
+	{
+		return false;
+	}
 
-	SelectObject(memoryDeviceContext, old);
-	DeleteDC(memoryDeviceContext);
-	ReleaseDC(nullptr, deviceContext);
+	layer.bitmap = AcquireBitmap(width, height, strip, stripIndex);
+	return layer.bitmap != nullptr;
 }
 
-void Overlay::CreateBitmap(const int32_t width, const int32_t height)
+void Overlay::OnFrame()
 {
-	if (_bitmap)
+	_clock->FrameHandled();
+
+	if (!_animation.IsRunning())
 	{
-		DeleteObject(_bitmap);
-		_bitmap = nullptr;
+		return;
 	}
 
-	_bitmapWidth = width;
-	_bitmapHeight = height;
+	ScopedSpan span(SpanFrame);
+
+	_pingFrames++;
 
-	BITMAPINFO bmi = {};
-	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-	bmi.bmiHeader.biWidth = width;
-	bmi.bmiHeader.biHeight = -height; // Top-down
-	bmi.bmiHeader.biPlanes = 1;
-	bmi.bmiHeader.biBitCount = 32;
-	bmi.bmiHeader.biCompression = BI_RGB;
+	// However many events came since the last frame, the overlay is laid out once. When saving power,
+	// it only follows the moves: a new size would need new surfaces.
+	if (_layoutPending)
+	{
+		_layoutPending = false;
+		Layout(_profile.followResize);
+		TrackProcess(_foreground);
+	}
 
-	void* bits = nullptr;
-	const auto hdcScreen = GetDC(nullptr);
-	_bitmap = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
-	ReleaseDC(nullptr, hdcScreen);
+	const auto alpha = _animation.Tick(_clock->Now());
+	UpdateAlpha(alpha);
 
-	if (!_bitmap || !bits)
+	if (_eventNs != 0 && alpha > 0)
 	{
-		return;
+		Tracer::Global().Record(SpanClipboardToVisible, _eventNs, Tracer::Now());
+		_eventNs = 0;
 	}
 
-	const int32_t stride = width * 4;
-	Bitmap gpBitmap(width, height, stride, PixelFormat32bppPARGB, (BYTE*)bits);
+	if (!_animation.IsRunning())
+	{
+		_clock->Stop();
+		StopTracking();
 
-	Graphics graphics(&gpBitmap);
-	graphics.Clear(Color(0, 0, 0, 0));
+		auto& stats = _powerStats[_profile.saver];
+		stats.pings++;
+		stats.frames += _pingFrames;
+		stats.lastWakeups = _clock->GetWakeups() - _pingWakeups;
+		stats.wakeups += stats.lastWakeups;
 
-	const BYTE r = GetRValue(_settings.overlayColor);
-	const BYTE g = GetGValue(_settings.overlayColor);
-	const BYTE b = GetBValue(_settings.overlayColor);
+		// The bitmaps stay in the cache for the next ping
+		for (auto& layer : _layers)
+		{
+			layer.bitmap = nullptr;
+		}
 
-	switch (_settings.overlayType)
-	{
-	case OverlayBorder:
-		CreateBorderBitmap(graphics, width, height, r, g, b);
-		break;
-	case OverlayAura:
-		CreateAuraBitmap(graphics, width, height, r, g, b);
-		break;
-	case OverlayBottom:
-		CreateBottomBitmap(graphics, width, height, r, g, b);
-		break;
-	case OverlayLeft:
-		CreateLeftBitmap(graphics, width, height, r, g, b);
-		break;
-	case OverlayRight:
-		CreateRightBitmap(graphics, width, height, r, g, b);
-		break;
-	case OverlayTop:
-		CreateTopBitmap(graphics, width, height, r, g, b);
-		break;
+		_layerCount = 0;
+		_context.Reset();
+		_peakAlpha = 255;
+
+		if (_scheduler.OnAnimationEnded())
+		{
+			Show();
+		}
 	}
 }
 
-void Overlay::CreateTopBitmap(Graphics& graphics, const int32_t width, const int32_t height, const BYTE r, const BYTE g, const BYTE b)
+void Overlay::StartTracking()
 {
-	int32_t gradientHeight = height * GradientHeightPct / 100;
-	gradientHeight = std::max(gradientHeight, 2);
+	s_tracking = this;
 
-	const LinearGradientBrush brush(
-		Point(0, 0),
-		Point(0, gradientHeight),
-		Color(0x50, r, g, b),
-		Color(0x00, r, g, b));
+	if (!_foregroundHook)
+	{
+		_foregroundHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, OnWinEvent, 0, 0, WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+	}
 
-	graphics.FillRectangle(&brush, 0, 0, width, gradientHeight);
+	TrackProcess(_foreground);
 }
 
-void Overlay::CreateBottomBitmap(Graphics& graphics, const int32_t width, const int32_t height, const BYTE r, const BYTE g, const BYTE b)
+void Overlay::StopTracking()
 {
-	int32_t gradientHeight = height * GradientHeightPct / 100;
-	gradientHeight = std::max(gradientHeight, 2);
+	if (_foregroundHook)
+	{
+		UnhookWinEvent(_foregroundHook);
+		_foregroundHook = nullptr;
+	}
+
+	if (_locationHook)
+	{
+		UnhookWinEvent(_locationHook);
+		_locationHook = nullptr;
+	}
 
-	LinearGradientBrush brush(
-		Point(0, height - gradientHeight),
-		Point(0, height),
-		Color(0x00, r, g, b),
-		Color(0x50, r, g, b));
-	brush.SetWrapMode(WrapModeTileFlipXY);
+	_trackedProcess = 0;
+	_layoutPending = false;
 
-	graphics.FillRectangle(&brush, 0, height - gradientHeight, width, gradientHeight);
+	if (s_tracking == this)
+	{
+		s_tracking = nullptr;
+	}
 }
 
-void Overlay::CreateLeftBitmap(Graphics& graphics, const int32_t width, const int32_t height, const BYTE r, const BYTE g, const BYTE b)
+void Overlay::TrackProcess(const HWND hwnd)
 {
-	int32_t gradientWidth = width * GradientHeightPct / 100;
-	gradientWidth = std::max(gradientWidth, 2);
+	if (!_foregroundHook)
+	{
+		return;
+	}
 
-	const LinearGradientBrush brush(
-		Point(0, 0),
-		Point(gradientWidth, 0),
-		Color(0x50, r, g, b),
-		Color(0x00, r, g, b));
+	// Location changes are only listened to in the process of the window, they're frequent system-wide
+	DWORD process = 0;
 
-	graphics.FillRectangle(&brush, 0, 0, gradientWidth, height);
-}
+	if (hwnd)
+	{
+		GetWindowThreadProcessId(hwnd, &process);
+	}
 
-void Overlay::CreateRightBitmap(Graphics& graphics, const int32_t width, const int32_t height, const BYTE r, const BYTE g, const BYTE b)
-{
-	int32_t gradientWidth = width * GradientHeightPct / 100;
-	gradientWidth = std::max(gradientWidth, 2);
+	if (process == _trackedProcess && (_locationHook || process == 0))
+	{
+		return;
+	}
 
-	const LinearGradientBrush brush(
-		Point(width - gradientWidth, 0),
-		Point(width, 0),
-		Color(0x00, r, g, b),
-		Color(0x50, r, g, b));
+	if (_locationHook)
+	{
+		UnhookWinEvent(_locationHook);
+		_locationHook = nullptr;
+	}
 
-	graphics.FillRectangle(&brush, width - gradientWidth, 0, gradientWidth, height);
-}
+	_trackedProcess = process;
 
-void Overlay::CreateBorderBitmap(Graphics& graphics, const int32_t width, const int32_t height, const BYTE r, const BYTE g, const BYTE b)
-{
-	const SolidBrush brush(Color(0x80, r, g, b));
-	const int t = BorderThickness;
-
-	// Top strip
-	graphics.FillRectangle(&brush, 0, 0, width, t);
-	// Bottom strip
-	graphics.FillRectangle(&brush, 0, height - t, width, t);
-	// Left strip
-	graphics.FillRectangle(&brush, 0, t, t, height - 2 * t);
-	// Right strip
-	graphics.FillRectangle(&brush, width - t, t, t, height - 2 * t);
+	if (process != 0)
+	{
+		_locationHook = SetWinEventHook(EVENT_OBJECT_LOCATIONCHANGE, EVENT_OBJECT_LOCATIONCHANGE, nullptr, OnWinEvent, process, 0, WINEVENT_OUTOFCONTEXT);
+	}
 }
 
-void Overlay::CreateAuraBitmap(Graphics& graphics, const int32_t width, const int32_t height, const BYTE r, const BYTE g, const BYTE b)
+void CALLBACK Overlay::OnWinEvent(HWINEVENTHOOK, const DWORD event, const HWND hwnd, const LONG idObject, const LONG idChild, DWORD, DWORD)
 {
-	int32_t depth = height * AuraDepthPct / 100;
-	depth = std::max(depth, 2);
+	const auto self = s_tracking;
 
-	// Top
+	if (!self)
 	{
-		const LinearGradientBrush brush(
-			Point(0, 0),
-			Point(0, depth),
-			Color(0x50, r, g, b),
-			Color(0x00, r, g, b));
-		graphics.FillRectangle(&brush, 0, 0, width, depth);
+		return;
 	}
 
-	// Bottom
+	// Carets and cursors report location changes too, only the window itself matters
+	if (event == EVENT_OBJECT_LOCATIONCHANGE && (hwnd != self->_foreground || idObject != OBJID_WINDOW || idChild != CHILDID_SELF))
 	{
-		const LinearGradientBrush brush(
-			Point(0, height - depth),
-			Point(0, height),
-			Color(0x00, r, g, b),
-			Color(0x50, r, g, b));
-		graphics.FillRectangle(&brush, 0, height - depth, width, depth);
+		return;
 	}
 
-	// Left
+	self->_layoutPending = true;
+}
+
+LRESULT CALLBACK Overlay::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+	if (msg == WM_NCCREATE)
 	{
-		const LinearGradientBrush brush(
-			Point(0, 0),
-			Point(depth, 0),
-			Color(0x50, r, g, b),
-			Color(0x00, r, g, b));
-		graphics.FillRectangle(&brush, 0, 0, depth, height);
+		const auto cs = (CREATESTRUCT*)lParam;
+		SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)cs->lpCreateParams);
+		return DefWindowProc(hwnd, msg, wParam, lParam);
 	}
 
-	// Right
+	auto* self = (Overlay*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+
+	if (msg == FrameMessage && self)
 	{
-		const LinearGradientBrush brush(
-			Point(width - depth, 0),
-			Point(width, 0),
-			Color(0x00, r, g, b),
-			Color(0x50, r, g, b));
-		graphics.FillRectangle(&brush, width - depth, 0, depth, height);
+		self->OnFrame();
+		return 0;
 	}
+
+	return DefWindowProc(hwnd, msg, wParam, lParam);
 }
 
-void Overlay::OnTimer()
+void Overlay::OnClipboardUpdate(const int64_t eventNs, const bool subtle)
 {
-	const auto now = GetTickCount();
-	const auto elapsed = now - _animStart;
+	_scheduler.SetPolicy(_settings.retriggerPolicy, _settings.coalesceMs);
+
+	const auto decision = _scheduler.OnEvent((uint64_t)eventNs / 1000000, _animation.IsRunning());
 
-	if (_phase == AnimFadeIn)
+	switch (decision)
 	{
-		if (elapsed >= FadeInMs)
-		{
-			UpdateAlpha(255);
-			_phase = AnimFadeOut;
-			_animStart = now;
-		}
-		else
+	case PingScheduler::DecisionShow:
+		_peakAlpha = subtle ? SubtleAlpha : 255;
+		Show();
+		break;
+	case PingScheduler::DecisionRestart:
+		// A subtle update never dims a ping that's already on screen
+		if (!subtle)
 		{
-			const double t = (double)elapsed / FadeInMs;
-			const auto alpha = (int32_t)(EaseOutCubic(t) * 255.0);
-			UpdateAlpha(alpha);
+			_peakAlpha = 255;
 		}
+
+		Restart();
+		break;
+	case PingScheduler::DecisionExtend:
+		_animation.Extend(_clock->Now(), _settings.extendHoldMs);
+		break;
+	default:
+		break;
+	}
+
+	if ((decision == PingScheduler::DecisionShow || decision == PingScheduler::DecisionRestart) && _animation.IsRunning())
+	{
+		_eventNs = eventNs;
 	}
-	else if (_phase == AnimFadeOut)
+}
+
+void Overlay::Show()
+{
+	ScopedSpan span(SpanShow);
+
+	if (_animation.IsRunning())
 	{
-		if (elapsed >= FadeOutMs)
+		return;
+	}
+
+	// Read at every ping, the power source can change at any time
+	_profile = PowerPolicy::GetProfile(_settings.powerMode, ReadPowerState());
+
+	if (!Layout())
+	{
+		return;
+	}
+
+	// The settings can change between pings, the clock follows them like it follows the power source
+	if (!_clock || _saverClock != _profile.saver || (!_profile.saver && _vsyncClock != _settings.vsyncPacing))
+	{
+		const auto target = _layers[0].hwnd;
+		_clock.reset();
+
+		if (_profile.saver)
 		{
-			KillTimer(_hwnd, 1);
-			UpdateAlpha(0);
-
-			if (_bitmap)
-			{
-				DeleteObject(_bitmap);
-				_bitmap = nullptr;
-				_bitmapWidth = 0;
-				_bitmapHeight = 0;
-			}
-
-			_phase = AnimNone;
+			_clock = std::make_unique<CoalescingClock>(target, FrameMessage, _profile.frameIntervalMs, _profile.toleranceMs);
+		}
+		else if (_settings.vsyncPacing)
+		{
+			_clock = std::make_unique<VsyncClock>(target, FrameMessage);
 		}
 		else
 		{
-			const double t = (double)elapsed / FadeOutMs;
-			const auto alpha = (int32_t)((1.0 - EaseInCubic(t)) * 255.0);
-			UpdateAlpha(alpha);
+			_clock = std::make_unique<QpcClock>(target, FrameMessage);
 		}
+
+		_saverClock = _profile.saver;
+		_vsyncClock = _settings.vsyncPacing;
 	}
+
+	_pingWakeups = _clock->GetWakeups();
+	_pingFrames = 0;
+	_animation.Start(_clock->Now());
+	UpdateAlpha(0);
+	_clock->Start();
+	StartTracking();
 }
 
-LRESULT CALLBACK Overlay::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+bool Overlay::ReleaseMemory()
 {
-	if (msg == WM_NCCREATE)
+	if (_animation.IsRunning())
 	{
-		const auto cs = (CREATESTRUCT*)lParam;
-		SetWindowLongPtr(hwnd, GWLP_USERDATA, (LONG_PTR)cs->lpCreateParams);
-		return DefWindowProc(hwnd, msg, wParam, lParam);
+		return false;
 	}
 
-	auto* self = (Overlay*)GetWindowLongPtr(hwnd, GWLP_USERDATA);
+	// The clock posts its frames to the first layer window, so it goes first
+	_clock.reset();
+	_context.Reset();
 
-	if (msg == WM_TIMER && wParam == 1 && self)
+	for (auto& layer : _layers)
 	{
-		self->OnTimer();
-		return 0;
+		if (layer.hwnd)
+		{
+			DestroyWindow(layer.hwnd);
+		}
+
+		layer = {};
 	}
 
-	return DefWindowProc(hwnd, msg, wParam, lParam);
+	_renderer.GetCache().Clear();
+	_renderer.ClearTemplates();
+	_renderer.ClearMasks();
+	return true;
 }
 
-void Overlay::Show()
+void Overlay::Restart()
 {
-	if (_phase != AnimNone)
+	if (!_animation.IsRunning())
 	{
+		Show();
 		return;
 	}
 
-	const auto foregroundRect = GetForegroundWindowRect();
+	// Follow the foreground window, which may have changed since the ping started
+	if (Layout())
+	{
+		TrackProcess(_foreground);
+
+		const auto now = _clock->Now();
+		_animation.Restart(now);
+		UpdateAlpha(_animation.Tick(now));
+	}
+}
+
+bool Overlay::Layout(const bool allowResize)
+{
+	const auto foreground = GetForegroundWindow();
+	const auto foregroundRect = GetWindowBounds(foreground);
 	const int width = foregroundRect.right - foregroundRect.left;
 
 	// Shrink by 1px, otherwise Windows detects this as a fullscreen window and automatically enables Focus Assist
 	const int height = foregroundRect.bottom - foregroundRect.top - 1;
 
-	if (width <= 0 || height <= 0)
+	if (width <= 0 || height <= 0 || (!allowResize && (width != _width || height != _height)))
 	{
-		return;
+		return false;
 	}
 
-	if (!_hwnd)
+	// The cache can only be cleared between animations, when none of its bitmaps is on screen
+	if (!_animation.IsRunning() && _settingsRevision != _settings.revision)
 	{
-		_hwnd = CreateWindowEx(
-			WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE,
-			L"ClipPingOverlay", L"",
-			WS_POPUP | WS_VISIBLE,
-			foregroundRect.left, foregroundRect.top, width, height,
-			nullptr, nullptr, GetModuleHandle(nullptr), this);
+		auto& cache = _renderer.GetCache();
+		cache.Clear();
+		cache.SetBudget((size_t)_settings.cacheBudgetMb * 1024 * 1024);
+		_renderer.ClearTemplates();
+		_settingsRevision = _settings.revision;
 	}
-	else
+
+	_renderer.GetCache().NextGeneration();
+	_style = ResolveStyle(foregroundRect);
+
+	const auto evictions = _renderer.GetCache().GetStats().evictions;
+
+	// In edge-strip mode, only the painted strips get a layered window, so the memory and the
+	// blending cost scale with the perimeter of the window rather than its area
+	Strip strips[Rasterizer::MaxStrips] = { { 0, 0, width, height } };
+	int32_t stripCount = 1;
+
+	const bool edgeStrips = _settings.edgeStrips || _profile.edgeStrips;
+
+	if (edgeStrips)
 	{
-		SetWindowPos(_hwnd, HWND_TOPMOST, foregroundRect.left, foregroundRect.top, width, height, SWP_NOACTIVATE);
+		stripCount = _style ? Rasterizer::GetStrips(*_style, width, height, strips) : Rasterizer::GetStrips(_settings.overlayType, width, height, strips);
 	}
 
-	if (!_hwnd)
+	const POINT origin = { foregroundRect.left, foregroundRect.top };
+	_layerCount = 0;
+
+	for (int32_t i = 0; i < stripCount; i++)
 	{
-		return;
+		if (!PrepareLayer(_layers[i], origin, width, height, strips[i], edgeStrips ? i : -1))
+		{
+			break;
+		}
+
+		_layerCount++;
 	}
 
-	CreateBitmap(width, height);
+	if (_layerCount < stripCount)
+	{
+		_layerCount = 0;
+	}
 
-	_phase = AnimFadeIn;
-	_animStart = GetTickCount();
-	UpdateAlpha(0);
-	SetTimer(_hwnd, 1, TimerInterval, nullptr);
+	// An evicted bitmap may have left its handle to a new one, so nothing can be assumed to be uploaded.
+	// Otherwise, a layer that only moved keeps its bitmap and isn't uploaded again.
+	if (_renderer.GetCache().GetStats().evictions != evictions)
+	{
+		_context.Reset();
+	}
+
+	for (int32_t i = 0; i < _layerCount; i++)
+	{
+		const auto& layer = _layers[i];
+		_context.Bind(i, layer.hwnd, layer.bitmap, layer.position, layer.size);
+	}
+
+	_context.SetLayerCount(_layerCount);
+
+	// Hide the windows that aren't part of this ping
+	for (int32_t i = _layerCount; i < MaxLayers; i++)
+	{
+		if (_layers[i].hwnd)
+		{
+			ShowWindow(_layers[i].hwnd, SW_HIDE);
+		}
+	}
+
+	_width = width;
+	_height = height;
+
+	// On failure, the overlay stays with the window it was laid over, and keeps tracking it
+	if (_layerCount == 0)
+	{
+		return false;
+	}
+
+	_foreground = foreground;
+	return true;
 }
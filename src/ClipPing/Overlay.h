@@ -1,8 +1,18 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <windows.h>
-#include <gdiplus.h>
+
+#include "Animation.h"
+#include "DibRenderTarget.h"
+#include "FrameClock.h"
+#include "OverlayRenderer.h"
+#include "PingScheduler.h"
+#include "PowerPolicy.h"
+#include "Rasterizer.h"
+#include "RenderContext.h"
+#include "SurfaceCache.h"
 
 class Settings;
 
@@ -15,40 +25,98 @@ public:
 	Overlay(const Overlay&) = delete;
 	Overlay& operator=(const Overlay&) = delete;
 
+	// Entry point for clipboard updates, which go through the ping scheduler. The time is a Tracer::Now() timestamp.
+	// Subtle pings only reach SubtleAlpha, they're used for updates that didn't change the content.
+	void OnClipboardUpdate(int64_t eventNs, bool subtle);
+
+	// Starts a ping right away, unless one is already running
 	void Show();
 
+	// Frees what's only needed during a ping: the surfaces, the templates, the layered windows and
+	// the frame clock. Returns false if a ping is on screen.
+	bool ReleaseMemory();
+	size_t GetSurfaceBytes() const { return _renderer.GetCache().GetStats().bytes + _renderer.GetTemplateBytes(); }
+
+	const SurfaceCache::Stats& GetCacheStats() const { return _renderer.GetCache().GetStats(); }
+	const PingScheduler::Stats& GetSchedulerStats() const { return _scheduler.GetStats(); }
+	const RenderContext::Stats& GetFrameStats() const { return _context.GetStats(); }
+
+	struct PowerStats
+	{
+		uint64_t pings = 0;
+		uint64_t frames = 0;
+		uint64_t wakeups = 0; // Of the frame clock, wakeups / pings compares the power profiles
+		uint64_t lastWakeups = 0; // During the last ping
+	};
+
+	const PowerStats& GetPowerStats(const bool saver) const { return _powerStats[saver]; }
+
 	static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 
 private:
-	void CreateBitmap(int32_t width, int32_t height);
-	void UpdateAlpha(int32_t alpha) const;
-	void OnTimer();
-
-	static void CreateTopBitmap(Gdiplus::Graphics& graphics, int32_t width, int32_t height, BYTE r, BYTE g, BYTE b);
-	static void CreateBottomBitmap(Gdiplus::Graphics& graphics, int32_t width, int32_t height, BYTE r, BYTE g, BYTE b);
-	static void CreateLeftBitmap(Gdiplus::Graphics& graphics, int32_t width, int32_t height, BYTE r, BYTE g, BYTE b);
-	static void CreateRightBitmap(Gdiplus::Graphics& graphics, int32_t width, int32_t height, BYTE r, BYTE g, BYTE b);
-	static void CreateBorderBitmap(Gdiplus::Graphics& graphics, int32_t width, int32_t height, BYTE r, BYTE g, BYTE b);
-	static void CreateAuraBitmap(Gdiplus::Graphics& graphics, int32_t width, int32_t height, BYTE r, BYTE g, BYTE b);
-
-	static constexpr double EaseOutCubic(double t);
-	static constexpr double EaseInCubic(double t);
-	static RECT GetForegroundWindowRect();
-
-	enum AnimPhase : uint8_t { AnimNone, AnimFadeIn, AnimFadeOut };
-
-	static constexpr int FadeInMs = 100;
-	static constexpr int FadeOutMs = 300;
-	static constexpr int TimerInterval = 16;
-	static constexpr int GradientHeightPct = 10;
-	static constexpr int AuraDepthPct = 5;
-	static constexpr int BorderThickness = 8;
+	// A layered window showing one strip of the overlay, or the whole overlay
+	struct Layer
+	{
+		HWND hwnd = nullptr;
+		HBITMAP bitmap = nullptr; // Owned by the renderer cache
+		POINT position = {};
+		SIZE size = {};
+	};
+
+	void Restart();
+	bool Layout(bool allowResize = true);
+
+	// While an animation runs, the overlay follows the foreground window: the hooks flag its moves and
+	// foreground changes, and the next frame lays the overlay out again
+	void StartTracking();
+	void StopTracking();
+	void TrackProcess(HWND hwnd);
+	static void CALLBACK OnWinEvent(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD thread, DWORD time);
+
+	// The draw list of the custom style at the DPI of the monitor, or nullptr for the built-in styles
+	const DrawList* ResolveStyle(const RECT& bounds);
+
+	bool PrepareLayer(Layer& layer, POINT origin, int32_t width, int32_t height, const Strip& strip, int32_t stripIndex);
+	HBITMAP AcquireBitmap(int32_t width, int32_t height, const Strip& strip, int32_t stripIndex);
+	void UpdateAlpha(int32_t alpha);
+	void OnFrame();
+
+	static RECT GetWindowBounds(HWND hwnd);
+
+	static constexpr UINT FrameMessage = WM_APP + 1;
+	static constexpr int MaxLayers = Rasterizer::MaxStrips;
+	static constexpr int32_t SubtleAlpha = 0x60;
 
 	const Settings& _settings;
-	HWND _hwnd = nullptr;
-	HBITMAP _bitmap = nullptr;
-	int32_t _bitmapWidth = 0;
-	int32_t _bitmapHeight = 0;
-	AnimPhase _phase = AnimNone;
-	DWORD _animStart = 0;
+	DibRenderTarget _target;
+	OverlayRenderer _renderer;
+	RenderContext _context;
+	uint32_t _settingsRevision = 0;
+	Layer _layers[MaxLayers];
+	int32_t _layerCount = 0;
+	std::unique_ptr<FrameClock> _clock;
+	FadeAnimation _animation;
+	PingScheduler _scheduler;
+	int32_t _peakAlpha = 255;
+	PowerProfile _profile;
+	bool _saverClock = false;
+	bool _vsyncClock = false; // VsyncPacing when the clock was made, the saver clock ignores it
+	PowerStats _powerStats[2];
+	uint64_t _pingWakeups = 0;
+	uint64_t _pingFrames = 0;
+	int32_t _width = 0; // Size of the current layout
+	int32_t _height = 0;
+	const DrawList* _style = nullptr; // Style of the current layout
+	DrawList _drawList;
+	uint32_t _drawListSerial = 0; // The compiled style and the DPI the draw list was resolved for
+	uint32_t _drawListDpi = 0;
+	int64_t _eventNs = 0; // Clipboard update waiting for its first visible frame, for tracing
+	HWND _foreground = nullptr; // The window the overlay is laid over
+	DWORD _trackedProcess = 0;
+	HWINEVENTHOOK _foregroundHook = nullptr;
+	HWINEVENTHOOK _locationHook = nullptr;
+	bool _layoutPending = false;
+
+	// Out-of-context hooks are called on the thread that set them, which owns this overlay
+	static thread_local Overlay* s_tracking;
 };
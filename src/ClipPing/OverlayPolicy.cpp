@@ -0,0 +1,97 @@
+// ReSharper disable CppCStyleCast
+#include "OverlayPolicy.h"
+
+#include <algorithm>
+
+std::wstring OverlayPolicy::ToLower(const std::wstring_view text)
+{
+	std::wstring result(text);
+
+	for (auto& c : result)
+	{
+		if (c >= L'A' && c <= L'Z')
+		{
+			c = (wchar_t)(c - L'A' + L'a');
+		}
+	}
+
+	return result;
+}
+
+void OverlayPolicy::SetProcessList(const std::wstring_view list)
+{
+	_processes.clear();
+	size_t start = 0;
+
+	while (start <= list.size())
+	{
+		auto end = list.find_first_of(L";,", start);
+		end = end == std::wstring_view::npos ? list.size() : end;
+
+		auto name = list.substr(start, end - start);
+
+		while (!name.empty() && (name.front() == L' ' || name.front() == L'\t'))
+		{
+			name.remove_prefix(1);
+		}
+
+		while (!name.empty() && (name.back() == L' ' || name.back() == L'\t'))
+		{
+			name.remove_suffix(1);
+		}
+
+		if (!name.empty())
+		{
+			_processes.push_back(ToLower(name));
+		}
+
+		start = end + 1;
+	}
+}
+
+bool OverlayPolicy::CoversMonitor(const ForegroundState& state)
+{
+	const auto& window = state.window;
+	const auto& monitor = state.monitor;
+
+	return monitor.right > monitor.left && monitor.bottom > monitor.top
+		&& window.left <= monitor.left && window.top <= monitor.top
+		&& window.right >= monitor.right && window.bottom >= monitor.bottom;
+}
+
+OverlayPolicy::Decision OverlayPolicy::Evaluate(const ForegroundState& state)
+{
+	_stats.evaluated++;
+
+	if (_mode == QuietOff)
+	{
+		return {};
+	}
+
+	const auto action = _mode == QuietSuppress ? ActionSuppress : ActionTrayFlash;
+
+	if (!state.processName.empty() && !_processes.empty())
+	{
+		const auto name = ToLower(state.processName);
+
+		if (std::find(_processes.begin(), _processes.end(), name) != _processes.end())
+		{
+			_stats.process++;
+			return { action, ReasonProcess };
+		}
+	}
+
+	if (state.busy)
+	{
+		_stats.busy++;
+		return { action, ReasonBusy };
+	}
+
+	if (state.hasWindow && !state.captioned && CoversMonitor(state))
+	{
+		_stats.fullscreen++;
+		return { action, ReasonFullscreen };
+	}
+
+	return {};
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What to do instead of the overlay when the foreground window shouldn't be covered
+enum QuietMode : int32_t
+{
+	QuietOff = 0, // Always show the overlay
+	QuietSuppress = 1, // No ping
+	QuietTrayFlash = 2, // Blink the tray icon instead
+	QuietMax
+};
+
+// What the policy knows of the foreground window, gathered by ForegroundProbe on Windows
+struct ForegroundState
+{
+	struct Bounds
+	{
+		int32_t left = 0;
+		int32_t top = 0;
+		int32_t right = 0;
+		int32_t bottom = 0;
+	};
+
+	bool busy = false; // The user notification state asks not to disturb: fullscreen app, Direct3D, presentation mode
+	bool hasWindow = false; // False for the desktop and when nothing has the focus
+	bool captioned = false; // Has a title bar, a maximized window can cover the monitor when the taskbar auto-hides
+	Bounds window;
+	Bounds monitor;
+	std::wstring processName; // File name of the executable, only filled in when there's a process list
+};
+
+// Decides whether a ping can cover the foreground window. Overlays over fullscreen games and video
+// force composition of a topmost layered window and cost frame time when it matters the most.
+class OverlayPolicy
+{
+public:
+	enum Action : uint8_t { ActionShow, ActionSuppress, ActionTrayFlash };
+	enum Reason : uint8_t { ReasonNone, ReasonBusy, ReasonFullscreen, ReasonProcess };
+
+	struct Decision
+	{
+		Action action = ActionShow;
+		Reason reason = ReasonNone;
+	};
+
+	struct Stats
+	{
+		uint64_t evaluated = 0;
+		uint64_t busy = 0;
+		uint64_t fullscreen = 0;
+		uint64_t process = 0;
+	};
+
+	void SetMode(QuietMode mode) { _mode = mode; }
+	QuietMode GetMode() const { return _mode; }
+
+	// Executable names separated by ';' or ',', like "vlc.exe; mpv.exe". Matching ignores the ASCII case.
+	void SetProcessList(std::wstring_view list);
+	bool HasProcessList() const { return !_processes.empty(); }
+
+	Decision Evaluate(const ForegroundState& state);
+
+	static bool CoversMonitor(const ForegroundState& state);
+
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	static std::wstring ToLower(std::wstring_view text);
+
+	QuietMode _mode = QuietTrayFlash;
+	std::vector<std::wstring> _processes; // Lowercase
+	Stats _stats;
+};
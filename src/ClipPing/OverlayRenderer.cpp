@@ -0,0 +1,165 @@
+// ReSharper disable CppCStyleCast
+#include "OverlayRenderer.h"
+
+#include <algorithm>
+
+#include "Trace.h"
+
+OverlayRenderer::OverlayRenderer(RenderTarget& target, const size_t cacheBudgetBytes)
+	: _target(target), _cache(cacheBudgetBytes, target)
+{
+}
+
+const SurfaceCache::Entry* OverlayRenderer::Render(const OverlayType type, const uint32_t color, const int32_t width, const int32_t height, const Strip& strip, const int32_t stripIndex, const DrawList* style)
+{
+	const SurfaceKey key = { type, color, width, height, stripIndex, style ? style->id : 0 };
+
+	if (const auto entry = _cache.Find(key))
+	{
+		return entry;
+	}
+
+	ScopedSpan span(SpanRenderSurface);
+
+	Surface surface;
+	const auto handle = _target.Allocate(strip.width, strip.height, surface);
+
+	if (!handle)
+	{
+		return nullptr;
+	}
+
+	// Overlays too small to be a nine-patch are rasterized directly
+	Insets insets;
+
+	if (style ? Rasterizer::GetInsets(*style, width, height, insets) : Rasterizer::GetInsets(type, width, height, insets))
+	{
+		const auto& source = GetTemplate(type, style, color, width, height, insets);
+		Rasterizer::ComposeRegion(surface, strip.x, strip.y, width, height, source.surface, insets);
+	}
+	else if (style)
+	{
+		Rasterizer::RenderRegion(surface, strip.x, strip.y, width, height, *style, (uint8_t)color, (uint8_t)(color >> 8), (uint8_t)(color >> 16));
+	}
+	else
+	{
+		Rasterizer::RenderRegion(
+			surface,
+			strip.x,
+			strip.y,
+			width,
+			height,
+			type,
+			(uint8_t)color,
+			(uint8_t)(color >> 8),
+			(uint8_t)(color >> 16));
+	}
+
+	return _cache.Insert(key, surface, handle);
+}
+
+const OverlayRenderer::Template& OverlayRenderer::GetTemplate(const OverlayType type, const DrawList* style, const uint32_t color, const int32_t width, const int32_t height, const Insets& insets)
+{
+	const uint32_t styleId = style ? style->id : 0;
+
+	for (size_t i = 0; i < _templates.size(); i++)
+	{
+		const auto& entry = _templates[i];
+
+		if (entry.type == type && entry.style == styleId && entry.color == color && entry.insets == insets)
+		{
+			std::rotate(_templates.begin(), _templates.begin() + (ptrdiff_t)i, _templates.begin() + (ptrdiff_t)i + 1);
+			return _templates.front();
+		}
+	}
+
+	if (_templates.size() >= MaxTemplates)
+	{
+		_templates.pop_back();
+	}
+
+	Template entry = { type, styleId, color, insets, {}, {} };
+	const int32_t templateWidth = insets.left + 1 + insets.right;
+	const int32_t templateHeight = insets.top + 1 + insets.bottom;
+	entry.pixels.resize((size_t)templateWidth * templateHeight);
+	entry.surface = { entry.pixels.data(), templateWidth, templateHeight, templateWidth };
+
+	const auto r = (uint8_t)color;
+	const auto g = (uint8_t)(color >> 8);
+	const auto b = (uint8_t)(color >> 16);
+
+	// Bands with colors of their own can't be tinted, their styles are rendered in each color
+	if (!style || style->tintable)
+	{
+		const auto& mask = GetMask(type, style, width, height, insets);
+		Rasterizer::Tint(entry.surface, mask.coverage.data(), templateWidth, r, g, b);
+	}
+	else
+	{
+		Rasterizer::RenderTemplate(entry.surface, insets, width, height, *style, r, g, b);
+	}
+
+	_templates.insert(_templates.begin(), std::move(entry));
+	return _templates.front();
+}
+
+const OverlayRenderer::Mask& OverlayRenderer::GetMask(const OverlayType type, const DrawList* style, const int32_t width, const int32_t height, const Insets& insets)
+{
+	const uint32_t styleId = style ? style->id : 0;
+
+	for (size_t i = 0; i < _masks.size(); i++)
+	{
+		const auto& entry = _masks[i];
+
+		if (entry.type == type && entry.style == styleId && entry.insets == insets)
+		{
+			std::rotate(_masks.begin(), _masks.begin() + (ptrdiff_t)i, _masks.begin() + (ptrdiff_t)i + 1);
+			return _masks.front();
+		}
+	}
+
+	if (_masks.size() >= MaxMasks)
+	{
+		_masks.pop_back();
+	}
+
+	Mask entry = { type, styleId, insets, {} };
+	const int32_t maskWidth = insets.left + 1 + insets.right;
+	const int32_t maskHeight = insets.top + 1 + insets.bottom;
+	entry.coverage.resize((size_t)maskWidth * maskHeight);
+
+	// Rendered in white, where the alpha is the same as in any other color
+	std::vector<uint32_t> pixels((size_t)maskWidth * maskHeight);
+	const Surface surface = { pixels.data(), maskWidth, maskHeight, maskWidth };
+
+	if (style)
+	{
+		Rasterizer::RenderTemplate(surface, insets, width, height, *style, 0xFF, 0xFF, 0xFF);
+	}
+	else
+	{
+		Rasterizer::RenderTemplate(surface, insets, width, height, type, 0xFF, 0xFF, 0xFF);
+	}
+
+	Rasterizer::ExtractCoverage(surface, entry.coverage.data(), maskWidth);
+
+	_masks.insert(_masks.begin(), std::move(entry));
+	return _masks.front();
+}
+
+size_t OverlayRenderer::GetTemplateBytes() const
+{
+	size_t bytes = 0;
+
+	for (const auto& entry : _templates)
+	{
+		bytes += entry.pixels.capacity() * sizeof(uint32_t);
+	}
+
+	for (const auto& entry : _masks)
+	{
+		bytes += entry.coverage.capacity();
+	}
+
+	return bytes;
+}
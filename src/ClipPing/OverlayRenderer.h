@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OverlayType.h"
+#include "Rasterizer.h"
+#include "RenderTarget.h"
+#include "SurfaceCache.h"
+
+// Turns overlay requests into cached surfaces: allocates from the render target and rasterizes on a
+// cache miss. It has no platform dependencies, the render target decides what backs the surfaces.
+// Surfaces are composed from a nine-patch template of the style, so a new window size only costs
+// filling memory. The style is rasterized once per insets into a coverage mask, and each color only
+// tints the mask into a template.
+class OverlayRenderer
+{
+public:
+	OverlayRenderer(RenderTarget& target, size_t cacheBudgetBytes);
+
+	OverlayRenderer(const OverlayRenderer&) = delete;
+	OverlayRenderer& operator=(const OverlayRenderer&) = delete;
+
+	// Returns the surface of one strip of a width x height overlay, or of the whole overlay when
+	// stripIndex is -1. The color is laid out as a COLORREF (0x00BBGGRR). Returns nullptr if the
+	// surface can't be allocated. A custom style replaces the type.
+	const SurfaceCache::Entry* Render(OverlayType type, uint32_t color, int32_t width, int32_t height, const Strip& strip, int32_t stripIndex, const DrawList* style = nullptr);
+
+	// Drops the templates, e.g. when the settings change. The masks only depend on the geometry and
+	// are kept, so a new color doesn't rasterize anything.
+	void ClearTemplates() { _templates.clear(); }
+	void ClearMasks() { _masks.clear(); }
+	size_t GetTemplateBytes() const;
+
+	SurfaceCache& GetCache() { return _cache; }
+	const SurfaceCache& GetCache() const { return _cache; }
+
+private:
+	struct Template
+	{
+		OverlayType type;
+		uint32_t style;
+		uint32_t color;
+		Insets insets;
+		std::vector<uint32_t> pixels;
+		Surface surface;
+	};
+
+	struct Mask
+	{
+		OverlayType type;
+		uint32_t style;
+		Insets insets;
+		std::vector<uint8_t> coverage; // The size of the template
+	};
+
+	static constexpr size_t MaxTemplates = 4;
+	static constexpr size_t MaxMasks = 4;
+
+	// Returns the template of the style, most recently used first
+	const Template& GetTemplate(OverlayType type, const DrawList* style, uint32_t color, int32_t width, int32_t height, const Insets& insets);
+
+	// Returns the coverage of the template, most recently used first
+	const Mask& GetMask(OverlayType type, const DrawList* style, int32_t width, int32_t height, const Insets& insets);
+
+	RenderTarget& _target;
+	SurfaceCache _cache;
+	std::vector<Template> _templates;
+	std::vector<Mask> _masks;
+};
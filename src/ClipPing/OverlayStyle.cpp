@@ -0,0 +1,328 @@
+// ReSharper disable CppCStyleCast
+#include "OverlayStyle.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+
+static bool EqualsIgnoreCase(const std::string_view left, const std::string_view right)
+{
+	return std::equal(left.begin(), left.end(), right.begin(), right.end(), [](const char a, const char b)
+	{
+		return (a >= 'A' && a <= 'Z' ? a - 'A' + 'a' : a) == (b >= 'A' && b <= 'Z' ? b - 'A' + 'a' : b);
+	});
+}
+
+// Splits on spaces and tabs, dropping the empty tokens
+static std::vector<std::string_view> Tokenize(const std::string_view text)
+{
+	std::vector<std::string_view> tokens;
+	size_t start = 0;
+
+	while (start < text.size())
+	{
+		auto end = text.find_first_of(" \t", start);
+		end = end == std::string_view::npos ? text.size() : end;
+
+		if (end > start)
+		{
+			tokens.push_back(text.substr(start, end - start));
+		}
+
+		start = end + 1;
+	}
+
+	return tokens;
+}
+
+// Parses the whole token as a number, strtof and strtoul need it null-terminated
+static bool ParseFloat(const std::string_view token, float& value)
+{
+	const std::string text(token);
+	char* end = nullptr;
+	value = strtof(text.c_str(), &end);
+	return !text.empty() && end == text.c_str() + text.size() && std::isfinite(value);
+}
+
+static bool ParseHex(const std::string_view token, const size_t maxDigits, uint32_t& value)
+{
+	if (token.empty() || token.size() > maxDigits)
+	{
+		return false;
+	}
+
+	const std::string text(token);
+	char* end = nullptr;
+	value = (uint32_t)strtoul(text.c_str(), &end, 16);
+	return end == text.c_str() + text.size();
+}
+
+static bool ParseEdges(const std::string_view token, uint32_t& edges)
+{
+	static const char* const Names[] = { "Top", "Bottom", "Left", "Right" };
+
+	if (EqualsIgnoreCase(token, "All"))
+	{
+		edges = 0xF;
+		return true;
+	}
+
+	edges = 0;
+	size_t start = 0;
+
+	while (start <= token.size())
+	{
+		auto end = token.find('+', start);
+		end = end == std::string_view::npos ? token.size() : end;
+
+		const auto name = token.substr(start, end - start);
+		const auto it = std::find_if(std::begin(Names), std::end(Names), [&](const char* n) { return EqualsIgnoreCase(name, n); });
+
+		if (it == std::end(Names))
+		{
+			return false;
+		}
+
+		edges |= 1u << (it - std::begin(Names));
+		start = end + 1;
+	}
+
+	return edges != 0;
+}
+
+std::shared_ptr<const OverlayStyle> OverlayStyle::Compile(const IniFile& ini, const std::string_view name)
+{
+	static std::atomic<uint32_t> s_nextSerial = 1;
+
+	if (name.empty())
+	{
+		return nullptr;
+	}
+
+	auto style = std::make_shared<OverlayStyle>();
+	style->_name = name;
+
+	// Invalid shapes are skipped like invalid settings, the others still make a style
+	for (int i = 1; i <= MaxShapes; i++)
+	{
+		const auto text = ini.GetString(name, "Shape" + std::to_string(i), "");
+		ParseShape(text, !style->_bands.empty(), style->_bands);
+	}
+
+	if (style->_bands.empty())
+	{
+		return nullptr;
+	}
+
+	style->_serial = s_nextSerial.fetch_add(1, std::memory_order_relaxed);
+	return style;
+}
+
+bool OverlayStyle::ParseShape(const std::string_view text, const bool blend, std::vector<Band>& bands)
+{
+	const auto tokens = Tokenize(text);
+
+	uint32_t edges = 0;
+	float thickness = 0;
+
+	if (tokens.size() < 3 || !ParseEdges(tokens[0], edges) || !ParseFloat(tokens[1], thickness) || thickness <= 0 || thickness > MaxThickness)
+	{
+		return false;
+	}
+
+	uint8_t alphas[MaxStops];
+	float positions[MaxStops];
+	int stopCount = 0;
+	bool ownColor = false;
+	uint32_t color = 0;
+
+	for (size_t i = 2; i < tokens.size(); i++)
+	{
+		const auto token = tokens[i];
+
+		// The color can only come last
+		if (token[0] == '#')
+		{
+			if (i + 1 != tokens.size() || token.size() != 7 || !ParseHex(token.substr(1), 6, color))
+			{
+				return false;
+			}
+
+			ownColor = true;
+			break;
+		}
+
+		if (stopCount == MaxStops)
+		{
+			return false;
+		}
+
+		const auto at = token.find('@');
+		uint32_t alpha = 0;
+
+		if (!ParseHex(token.substr(0, at), 2, alpha))
+		{
+			return false;
+		}
+
+		float position = NAN;
+
+		if (at != std::string_view::npos)
+		{
+			auto percent = token.substr(at + 1);
+
+			if (!percent.empty() && percent.back() == '%')
+			{
+				percent.remove_suffix(1);
+			}
+
+			if (!ParseFloat(percent, position))
+			{
+				return false;
+			}
+
+			position = std::clamp(position, 0.0f, 100.0f);
+		}
+
+		alphas[stopCount] = (uint8_t)alpha;
+		positions[stopCount] = position;
+		stopCount++;
+	}
+
+	if (stopCount == 0)
+	{
+		return false;
+	}
+
+	// Like CSS gradients: the ends default to 0% and 100%, stops without a position are spread evenly
+	// between their neighbors, and a position can't go back before the previous one
+	if (std::isnan(positions[0]))
+	{
+		positions[0] = 0;
+	}
+
+	if (std::isnan(positions[stopCount - 1]))
+	{
+		positions[stopCount - 1] = stopCount == 1 ? 0.0f : 100.0f;
+	}
+
+	for (int i = 1; i < stopCount; i++)
+	{
+		if (std::isnan(positions[i]))
+		{
+			int next = i + 1;
+
+			while (std::isnan(positions[next]))
+			{
+				next++;
+			}
+
+			positions[i] = positions[i - 1] + (positions[next] - positions[i - 1]) / (float)(next - i + 1);
+		}
+
+		positions[i] = std::max(positions[i], positions[i - 1]);
+	}
+
+	// Segments from the edge inwards, the alpha of the first and last stops extends to the ends
+	struct Segment
+	{
+		float from;
+		float to;
+		uint8_t alpha0;
+		uint8_t alpha1;
+	};
+
+	Segment segments[MaxStops + 1];
+	int segmentCount = 0;
+
+	const auto addSegment = [&](const float from, const float to, const uint8_t alpha0, const uint8_t alpha1)
+	{
+		if (to > from)
+		{
+			segments[segmentCount++] = { from * thickness / 100.0f, to * thickness / 100.0f, alpha0, alpha1 };
+		}
+	};
+
+	addSegment(0, positions[0], alphas[0], alphas[0]);
+
+	for (int i = 1; i < stopCount; i++)
+	{
+		addSegment(positions[i - 1], positions[i], alphas[i - 1], alphas[i]);
+	}
+
+	addSegment(positions[stopCount - 1], 100, alphas[stopCount - 1], alphas[stopCount - 1]);
+
+	// Left and right bands stop at the top and bottom bands of the same shape
+	const float spanStart = (edges & 1u << EdgeTop) ? thickness : 0.0f;
+	const float spanEnd = (edges & 1u << EdgeBottom) ? thickness : 0.0f;
+
+	for (int edge = EdgeTop; edge <= EdgeRight; edge++)
+	{
+		if (!(edges & 1u << edge))
+		{
+			continue;
+		}
+
+		const bool vertical = edge == EdgeLeft || edge == EdgeRight;
+
+		for (int i = 0; i < segmentCount; i++)
+		{
+			const auto& segment = segments[i];
+
+			bands.push_back({
+				(DrawEdge)edge,
+				segment.alpha0,
+				segment.alpha1,
+				blend,
+				ownColor,
+				color,
+				segment.from,
+				segment.to,
+				vertical ? spanStart : 0.0f,
+				vertical ? spanEnd : 0.0f });
+		}
+	}
+
+	return true;
+}
+
+DrawList OverlayStyle::Resolve(const uint32_t dpi) const
+{
+	DrawList list;
+	list.id = _serial << 16 | (dpi & 0xFFFF);
+
+	const float scale = (float)dpi / 96.0f;
+	const auto pixels = [&](const float dips) { return (int32_t)std::lround(dips * scale); };
+
+	list.ops.reserve(_bands.size());
+
+	for (const auto& band : _bands)
+	{
+		const DrawOp op = {
+			band.edge,
+			band.alpha0,
+			band.alpha1,
+			band.blend,
+			band.ownColor,
+			band.color,
+			pixels(band.from),
+			pixels(band.to),
+			pixels(band.spanStart),
+			pixels(band.spanEnd) };
+
+		// Thin segments can round to nothing at low DPIs
+		if (op.to <= op.from)
+		{
+			continue;
+		}
+
+		list.ops.push_back(op);
+		list.tintable = list.tintable && !op.ownColor;
+
+		auto& inset = op.edge == EdgeTop ? list.insets.top : op.edge == EdgeBottom ? list.insets.bottom : op.edge == EdgeLeft ? list.insets.left : list.insets.right;
+		inset = std::max(inset, op.to);
+	}
+
+	return list;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "IniFile.h"
+#include "Rasterizer.h"
+
+// A user-defined overlay style, read from a section of Styles.ini. Each shape is a band along one
+// or more edges, with a thickness in DIPs and an alpha gradient across it:
+//
+//   Shape1=<edges> <thickness> <stops> [#RRGGBB]
+//
+// Edges are All or names joined with '+' (Top+Bottom). Stops are hex alphas from the edge inwards,
+// evenly spaced unless they're given a position in percent of the thickness (80 20@40 00). A single
+// stop paints a solid band. Later shapes are painted over the earlier ones.
+//
+// The definition is compiled once into bands, which only have to be scaled for a DPI before rendering.
+class OverlayStyle
+{
+public:
+	static constexpr int MaxShapes = 8;
+	static constexpr int MaxStops = 8;
+	static constexpr float MaxThickness = 500.0f;
+
+	// Returns nullptr if the section doesn't exist or has no valid shape
+	static std::shared_ptr<const OverlayStyle> Compile(const IniFile& ini, std::string_view name);
+
+	// The bands scaled to the DPI, with an id unique to this compilation and the DPI
+	DrawList Resolve(uint32_t dpi) const;
+
+	const std::string& GetName() const { return _name; }
+	uint32_t GetSerial() const { return _serial; }
+	size_t GetBandCount() const { return _bands.size(); }
+
+private:
+	// A DrawOp in DIPs
+	struct Band
+	{
+		DrawEdge edge;
+		uint8_t alpha0;
+		uint8_t alpha1;
+		bool blend;
+		bool ownColor;
+		uint32_t color;
+		float from;
+		float to;
+		float spanStart;
+		float spanEnd;
+	};
+
+	static bool ParseShape(std::string_view text, bool blend, std::vector<Band>& bands);
+
+	std::string _name;
+	uint32_t _serial = 0;
+	std::vector<Band> _bands;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+enum OverlayType : int32_t
+{
+	OverlayTop = 0,
+	OverlayBorder = 1,
+	OverlayAura = 2,
+	OverlayBottom = 3,
+	OverlayLeft = 4,
+	OverlayRight = 5,
+	OverlayMax
+};
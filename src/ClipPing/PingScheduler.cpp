@@ -0,0 +1,69 @@
+// ReSharper disable CppCStyleCast
+#include "PingScheduler.h"
+
+void PingScheduler::SetPolicy(const RetriggerPolicy policy, const uint32_t coalesceMs)
+{
+	_policy = policy;
+	_coalesceMs = coalesceMs;
+}
+
+PingScheduler::Decision PingScheduler::OnEvent(const uint64_t timeMs, const bool animating)
+{
+	_stats.received++;
+
+	// The window starts at the last update that was acted upon, so a steady stream of updates still pings periodically
+	if (_hasAccepted && timeMs - _lastAccepted < _coalesceMs)
+	{
+		_stats.merged++;
+		return DecisionNone;
+	}
+
+	if (!animating)
+	{
+		Accept(timeMs);
+		return DecisionShow;
+	}
+
+	switch (_policy)
+	{
+	case RetriggerRestart:
+		_stats.restarted++;
+		Accept(timeMs);
+		return DecisionRestart;
+
+	case RetriggerExtend:
+		_stats.extended++;
+		Accept(timeMs);
+		return DecisionExtend;
+
+	case RetriggerQueue:
+		// Only one follow-up ping is kept
+		if (_queued)
+		{
+			_stats.merged++;
+			return DecisionNone;
+		}
+
+		_stats.queued++;
+		_queued = true;
+		Accept(timeMs);
+		return DecisionNone;
+
+	default:
+		_stats.dropped++;
+		return DecisionNone;
+	}
+}
+
+void PingScheduler::Accept(const uint64_t timeMs)
+{
+	_lastAccepted = timeMs;
+	_hasAccepted = true;
+}
+
+bool PingScheduler::OnAnimationEnded()
+{
+	const bool queued = _queued;
+	_queued = false;
+	return queued;
+}
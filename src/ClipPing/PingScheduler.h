@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+// What to do with a clipboard update that arrives while a ping is on screen
+enum RetriggerPolicy : int32_t
+{
+	RetriggerIgnore = 0,
+	RetriggerRestart = 1,
+	RetriggerExtend = 2,
+	RetriggerQueue = 3,
+	RetriggerMax
+};
+
+// Turns the stream of clipboard updates into pings. Bursts of updates (applications writing several
+// formats one after the other) are coalesced, and updates arriving during a ping follow the retrigger policy.
+class PingScheduler
+{
+public:
+	enum Decision : uint8_t { DecisionNone, DecisionShow, DecisionRestart, DecisionExtend };
+
+	struct Stats
+	{
+		uint64_t received = 0;
+		uint64_t merged = 0;
+		uint64_t dropped = 0;
+		uint64_t restarted = 0;
+		uint64_t extended = 0;
+		uint64_t queued = 0;
+	};
+
+	void SetPolicy(RetriggerPolicy policy, uint32_t coalesceMs);
+
+	// Called for each clipboard update. 'animating' tells whether a ping is currently on screen.
+	Decision OnEvent(uint64_t timeMs, bool animating);
+
+	// Called when a ping ends, returns true if a queued ping must start now
+	bool OnAnimationEnded();
+
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	void Accept(uint64_t timeMs);
+
+	RetriggerPolicy _policy = RetriggerIgnore;
+	uint32_t _coalesceMs = 0;
+	uint64_t _lastAccepted = 0;
+	bool _hasAccepted = false;
+	bool _queued = false;
+	Stats _stats;
+};
@@ -0,0 +1,14 @@
+// ReSharper disable CppCStyleCast
+#include "PowerPolicy.h"
+
+PowerProfile PowerPolicy::GetProfile(const PowerMode mode, const PowerState& state)
+{
+	const bool saver = mode == PowerSaver || (mode == PowerAuto && (state.onBattery || state.batterySaver));
+
+	if (!saver)
+	{
+		return {};
+	}
+
+	return { true, SaverFrameMs, SaverToleranceMs, true, false };
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+// How the overlay trades smoothness for power
+enum PowerMode : int32_t
+{
+	PowerAuto = 0, // Saves power on battery or when the battery saver is on
+	PowerFull = 1,
+	PowerSaver = 2,
+	PowerMax
+};
+
+struct PowerState
+{
+	bool onBattery = false;
+	bool batterySaver = false;
+};
+
+// Frame pacing and rendering limits of a ping
+struct PowerProfile
+{
+	bool saver = false;
+	uint32_t frameIntervalMs = 0; // 0 for the regular clocks, vsync or 60 Hz
+	uint32_t toleranceMs = 0; // How late the system may coalesce a frame timer with other wakeups
+	bool edgeStrips = false; // Forces the edge strips, the surfaces scale with the perimeter
+	bool followResize = true; // Renders surfaces for the new sizes of the tracked window, or only follows its moves
+};
+
+class PowerPolicy
+{
+public:
+	static PowerProfile GetProfile(PowerMode mode, const PowerState& state);
+
+	// 20 frames per second: the 400 ms ping takes 8 wakeups instead of 25
+	static constexpr uint32_t SaverFrameMs = 50;
+	static constexpr uint32_t SaverToleranceMs = 30;
+};
@@ -0,0 +1,30 @@
+// ReSharper disable CppCStyleCast
+#include "ProcessMemory.h"
+
+#include <windows.h>
+#include <psapi.h>
+
+#pragma comment(lib, "psapi.lib")
+
+ProcessMemory ProcessMemory::Read()
+{
+	ProcessMemory memory;
+
+	PROCESS_MEMORY_COUNTERS_EX counters = {};
+	counters.cb = sizeof(counters);
+
+	if (GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters)))
+	{
+		// The page file usage is the commit charge of the process, which is its private bytes
+		memory.privateBytes = counters.PrivateUsage;
+		memory.peakPrivateBytes = counters.PeakPagefileUsage;
+	}
+
+	memory.gdiObjects = GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS);
+	return memory;
+}
+
+void ProcessMemory::TrimWorkingSet()
+{
+	SetProcessWorkingSetSize(GetCurrentProcess(), (SIZE_T)-1, (SIZE_T)-1);
+}
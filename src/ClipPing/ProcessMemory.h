@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Footprint of the process, for the tray readout
+struct ProcessMemory
+{
+	size_t privateBytes = 0;
+	size_t peakPrivateBytes = 0;
+	uint32_t gdiObjects = 0;
+
+	static ProcessMemory Read();
+
+	// Hands the pages back to the system, the ones still in use are faulted in again on access
+	static void TrimWorkingSet();
+};
@@ -0,0 +1,1228 @@
+// ReSharper disable CppCStyleCast
+#include "Rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define CLIPPING_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC lets any intrinsic be used regardless of /arch, GCC and Clang need the target enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define CLIPPING_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CLIPPING_TARGET_AVX2
+#endif
+
+// Alpha ramp of a linear gradient, sampled at integer pixel positions like GDI+'s default pixel offset mode
+struct Ramp
+{
+	float bias; // alpha0 + 0.5, so that truncation rounds to nearest
+	float step;
+	uint32_t r;
+	uint32_t g;
+	uint32_t b;
+};
+
+struct Kernels
+{
+	void (*fill)(uint32_t* dst, int32_t count, uint32_t pixel);
+	void (*blendFill)(uint32_t* dst, int32_t count, uint32_t pixel);
+	void (*blend)(uint32_t* dst, const uint32_t* src, int32_t count);
+	void (*gradient)(uint32_t* dst, int32_t count, int32_t position, const Ramp& ramp);
+	void (*tint)(uint32_t* dst, const uint8_t* coverage, int32_t count, const Ramp& ramp);
+
+	// Non-temporal variants for surfaces too large to stay in cache, followed by a single fence
+	void (*streamFill)(uint32_t* dst, int32_t count, uint32_t pixel);
+	void (*streamCopy)(uint32_t* dst, const uint32_t* src, int32_t count);
+	void (*fence)();
+};
+
+static Ramp MakeRamp(const uint8_t alpha0, const uint8_t alpha1, const int32_t length, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	return { alpha0 + 0.5f, (float)(alpha1 - alpha0) / (float)length, r, g, b };
+}
+
+// Exact round(x / 255) for x in [0, 255 * 255]
+static constexpr uint32_t Div255(const uint32_t x)
+{
+	const uint32_t v = x + 128;
+	return (v + (v >> 8)) >> 8;
+}
+
+static constexpr uint32_t MakePixel(const uint32_t a, const uint32_t r, const uint32_t g, const uint32_t b)
+{
+	return (a << 24) | (Div255(r * a) << 16) | (Div255(g * a) << 8) | Div255(b * a);
+}
+
+static uint32_t RampPixel(const Ramp& ramp, const int32_t position)
+{
+	const auto alpha = (uint32_t)(ramp.bias + ramp.step * (float)position);
+	return MakePixel(alpha, ramp.r, ramp.g, ramp.b);
+}
+
+static uint32_t BlendPixel(const uint32_t src, const uint32_t dst)
+{
+	const uint32_t inv = 255 - (src >> 24);
+	uint32_t result = 0;
+
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		const uint32_t channel = ((src >> shift) & 0xFF) + Div255(((dst >> shift) & 0xFF) * inv);
+		result |= std::min(channel, 255u) << shift;
+	}
+
+	return result;
+}
+
+// Scalar kernels
+
+static void FillScalar(uint32_t* dst, const int32_t count, const uint32_t pixel)
+{
+	std::fill_n(dst, count, pixel);
+}
+
+static void BlendFillScalar(uint32_t* dst, const int32_t count, const uint32_t pixel)
+{
+	for (int32_t i = 0; i < count; i++)
+	{
+		dst[i] = BlendPixel(pixel, dst[i]);
+	}
+}
+
+static void BlendScalar(uint32_t* dst, const uint32_t* src, const int32_t count)
+{
+	for (int32_t i = 0; i < count; i++)
+	{
+		dst[i] = BlendPixel(src[i], dst[i]);
+	}
+}
+
+static void GradientScalar(uint32_t* dst, const int32_t count, const int32_t position, const Ramp& ramp)
+{
+	for (int32_t i = 0; i < count; i++)
+	{
+		dst[i] = RampPixel(ramp, position + i);
+	}
+}
+
+// Only the color of the ramp is used, the alpha comes from the coverage
+static void TintScalar(uint32_t* dst, const uint8_t* coverage, const int32_t count, const Ramp& ramp)
+{
+	for (int32_t i = 0; i < count; i++)
+	{
+		dst[i] = MakePixel(coverage[i], ramp.r, ramp.g, ramp.b);
+	}
+}
+
+static void CopyScalar(uint32_t* dst, const uint32_t* src, const int32_t count)
+{
+	memcpy(dst, src, (size_t)count * sizeof(uint32_t));
+}
+
+static void FenceScalar()
+{
+}
+
+#ifdef CLIPPING_X86
+
+// SSE2 kernels, 4 pixels at a time. x64 guarantees SSE2 so these need no runtime check.
+
+static __m128i Div255Epi16(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Channels and alpha are in the low byte of each 32-bit lane, so a 16-bit multiply is enough
+static __m128i MulDiv255Epi32(const __m128i channel, const __m128i alpha)
+{
+	const __m128i x = _mm_add_epi32(_mm_mullo_epi16(channel, alpha), _mm_set1_epi32(128));
+	return _mm_srli_epi32(_mm_add_epi32(x, _mm_srli_epi32(x, 8)), 8);
+}
+
+static __m128i BlendPixelsSse2(const __m128i src, const __m128i dst)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i inv = _mm_sub_epi32(_mm_set1_epi32(255), _mm_srli_epi32(src, 24));
+	const __m128i inv16 = _mm_or_si128(inv, _mm_slli_epi32(inv, 16));
+	const __m128i lo = Div255Epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_unpacklo_epi32(inv16, inv16)));
+	const __m128i hi = Div255Epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_unpackhi_epi32(inv16, inv16)));
+	return _mm_adds_epu8(src, _mm_packus_epi16(lo, hi));
+}
+
+static void FillSse2(uint32_t* dst, const int32_t count, const uint32_t pixel)
+{
+	const __m128i value = _mm_set1_epi32((int)pixel);
+	int32_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128((__m128i*)(dst + i), value);
+	}
+
+	FillScalar(dst + i, count - i, pixel);
+}
+
+static void BlendFillSse2(uint32_t* dst, const int32_t count, const uint32_t pixel)
+{
+	const __m128i src = _mm_set1_epi32((int)pixel);
+	int32_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		_mm_storeu_si128((__m128i*)(dst + i), BlendPixelsSse2(src, d));
+	}
+
+	BlendFillScalar(dst + i, count - i, pixel);
+}
+
+static void BlendSse2(uint32_t* dst, const uint32_t* src, const int32_t count)
+{
+	int32_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+		_mm_storeu_si128((__m128i*)(dst + i), BlendPixelsSse2(s, d));
+	}
+
+	BlendScalar(dst + i, src + i, count - i);
+}
+
+static void GradientSse2(uint32_t* dst, const int32_t count, const int32_t position, const Ramp& ramp)
+{
+	const __m128 bias = _mm_set1_ps(ramp.bias);
+	const __m128 step = _mm_set1_ps(ramp.step);
+	const __m128i r = _mm_set1_epi32((int)ramp.r);
+	const __m128i g = _mm_set1_epi32((int)ramp.g);
+	const __m128i b = _mm_set1_epi32((int)ramp.b);
+	__m128 pos = _mm_add_ps(_mm_set1_ps((float)position), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+	int32_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m128i alpha = _mm_cvttps_epi32(_mm_add_ps(bias, _mm_mul_ps(step, pos)));
+		const __m128i pixel = _mm_or_si128(
+			_mm_or_si128(_mm_slli_epi32(alpha, 24), _mm_slli_epi32(MulDiv255Epi32(r, alpha), 16)),
+			_mm_or_si128(_mm_slli_epi32(MulDiv255Epi32(g, alpha), 8), MulDiv255Epi32(b, alpha)));
+		_mm_storeu_si128((__m128i*)(dst + i), pixel);
+		pos = _mm_add_ps(pos, _mm_set1_ps(4.0f));
+	}
+
+	GradientScalar(dst + i, count - i, position + i, ramp);
+}
+
+// The coverage of each pixel is repeated in its four 16-bit channels and multiplied by (b, g, r, 255)
+static __m128i TintPixelsSse2(const uint8_t* coverage, const __m128i color)
+{
+	int packed;
+	memcpy(&packed, coverage, sizeof(packed));
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bytes = _mm_cvtsi32_si128(packed);
+	const __m128i pairs = _mm_unpacklo_epi8(bytes, bytes);
+	const __m128i quads = _mm_unpacklo_epi16(pairs, pairs);
+	const __m128i lo = Div255Epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(quads, zero), color));
+	const __m128i hi = Div255Epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(quads, zero), color));
+	return _mm_packus_epi16(lo, hi);
+}
+
+static void TintSse2(uint32_t* dst, const uint8_t* coverage, const int32_t count, const Ramp& ramp)
+{
+	const __m128i color = _mm_set_epi16(255, (short)ramp.r, (short)ramp.g, (short)ramp.b, 255, (short)ramp.r, (short)ramp.g, (short)ramp.b);
+	int32_t i = 0;
+
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128((__m128i*)(dst + i), TintPixelsSse2(coverage + i, color));
+	}
+
+	TintScalar(dst + i, coverage + i, count - i, ramp);
+}
+
+// Streaming stores need aligned addresses, the unaligned head of the span goes through regular stores
+static int32_t AlignedHead(const uint32_t* dst, const int32_t count, const uintptr_t alignment)
+{
+	const auto misalignment = (uintptr_t)dst & (alignment - 1);
+	const auto head = misalignment == 0 ? 0 : (int32_t)((alignment - misalignment) / sizeof(uint32_t));
+	return std::min(head, count);
+}
+
+static void StreamFillSse2(uint32_t* dst, const int32_t count, const uint32_t pixel)
+{
+	int32_t i = AlignedHead(dst, count, 16);
+	FillScalar(dst, i, pixel);
+
+	const __m128i value = _mm_set1_epi32((int)pixel);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_stream_si128((__m128i*)(dst + i), value);
+	}
+
+	FillScalar(dst + i, count - i, pixel);
+}
+
+static void StreamCopySse2(uint32_t* dst, const uint32_t* src, const int32_t count)
+{
+	int32_t i = AlignedHead(dst, count, 16);
+	CopyScalar(dst, src, i);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_stream_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+	}
+
+	CopyScalar(dst + i, src + i, count - i);
+}
+
+static void FenceSse2()
+{
+	_mm_sfence();
+}
+
+// AVX2 kernels, 8 pixels at a time. Unpack and pack both work per 128-bit lane, so pixel order is preserved.
+
+CLIPPING_TARGET_AVX2 static __m256i Div255Epi16Avx2(__m256i x)
+{
+	x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+CLIPPING_TARGET_AVX2 static __m256i MulDiv255Epi32Avx2(const __m256i channel, const __m256i alpha)
+{
+	const __m256i x = _mm256_add_epi32(_mm256_mullo_epi16(channel, alpha), _mm256_set1_epi32(128));
+	return _mm256_srli_epi32(_mm256_add_epi32(x, _mm256_srli_epi32(x, 8)), 8);
+}
+
+CLIPPING_TARGET_AVX2 static __m256i BlendPixelsAvx2(const __m256i src, const __m256i dst)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i inv = _mm256_sub_epi32(_mm256_set1_epi32(255), _mm256_srli_epi32(src, 24));
+	const __m256i inv16 = _mm256_or_si256(inv, _mm256_slli_epi32(inv, 16));
+	const __m256i lo = Div255Epi16Avx2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), _mm256_unpacklo_epi32(inv16, inv16)));
+	const __m256i hi = Div255Epi16Avx2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), _mm256_unpackhi_epi32(inv16, inv16)));
+	return _mm256_adds_epu8(src, _mm256_packus_epi16(lo, hi));
+}
+
+CLIPPING_TARGET_AVX2 static void FillAvx2(uint32_t* dst, const int32_t count, const uint32_t pixel)
+{
+	const __m256i value = _mm256_set1_epi32((int)pixel);
+	int32_t i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_si256((__m256i*)(dst + i), value);
+	}
+
+	_mm256_zeroupper();
+	FillSse2(dst + i, count - i, pixel);
+}
+
+CLIPPING_TARGET_AVX2 static void BlendFillAvx2(uint32_t* dst, const int32_t count, const uint32_t pixel)
+{
+	const __m256i src = _mm256_set1_epi32((int)pixel);
+	int32_t i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+		_mm256_storeu_si256((__m256i*)(dst + i), BlendPixelsAvx2(src, d));
+	}
+
+	_mm256_zeroupper();
+	BlendFillSse2(dst + i, count - i, pixel);
+}
+
+CLIPPING_TARGET_AVX2 static void BlendAvx2(uint32_t* dst, const uint32_t* src, const int32_t count)
+{
+	int32_t i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+		_mm256_storeu_si256((__m256i*)(dst + i), BlendPixelsAvx2(s, d));
+	}
+
+	_mm256_zeroupper();
+	BlendSse2(dst + i, src + i, count - i);
+}
+
+CLIPPING_TARGET_AVX2 static void GradientAvx2(uint32_t* dst, const int32_t count, const int32_t position, const Ramp& ramp)
+{
+	const __m256 bias = _mm256_set1_ps(ramp.bias);
+	const __m256 step = _mm256_set1_ps(ramp.step);
+	const __m256i r = _mm256_set1_epi32((int)ramp.r);
+	const __m256i g = _mm256_set1_epi32((int)ramp.g);
+	const __m256i b = _mm256_set1_epi32((int)ramp.b);
+	__m256 pos = _mm256_add_ps(_mm256_set1_ps((float)position), _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+	int32_t i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m256i alpha = _mm256_cvttps_epi32(_mm256_add_ps(bias, _mm256_mul_ps(step, pos)));
+		const __m256i pixel = _mm256_or_si256(
+			_mm256_or_si256(_mm256_slli_epi32(alpha, 24), _mm256_slli_epi32(MulDiv255Epi32Avx2(r, alpha), 16)),
+			_mm256_or_si256(_mm256_slli_epi32(MulDiv255Epi32Avx2(g, alpha), 8), MulDiv255Epi32Avx2(b, alpha)));
+		_mm256_storeu_si256((__m256i*)(dst + i), pixel);
+		pos = _mm256_add_ps(pos, _mm256_set1_ps(8.0f));
+	}
+
+	_mm256_zeroupper();
+	GradientSse2(dst + i, count - i, position + i, ramp);
+}
+
+// Like TintPixelsSse2 for 8 pixels. The pack interleaves the 128-bit lanes, which the permute restores.
+CLIPPING_TARGET_AVX2 static __m256i TintPixelsAvx2(const uint8_t* coverage, const __m256i color)
+{
+	const __m128i bytes = _mm_loadl_epi64((const __m128i*)coverage);
+	const __m128i pairs = _mm_unpacklo_epi8(bytes, bytes);
+	const __m256i lo = Div255Epi16Avx2(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi16(pairs, pairs)), color));
+	const __m256i hi = Div255Epi16Avx2(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_unpackhi_epi16(pairs, pairs)), color));
+	return _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+}
+
+CLIPPING_TARGET_AVX2 static void TintAvx2(uint32_t* dst, const uint8_t* coverage, const int32_t count, const Ramp& ramp)
+{
+	const __m256i color = _mm256_set1_epi64x((int64_t)(255ull << 48 | (uint64_t)ramp.r << 32 | (uint64_t)ramp.g << 16 | ramp.b));
+	int32_t i = 0;
+
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_si256((__m256i*)(dst + i), TintPixelsAvx2(coverage + i, color));
+	}
+
+	_mm256_zeroupper();
+	TintSse2(dst + i, coverage + i, count - i, ramp);
+}
+
+CLIPPING_TARGET_AVX2 static void StreamFillAvx2(uint32_t* dst, const int32_t count, const uint32_t pixel)
+{
+	int32_t i = AlignedHead(dst, count, 32);
+	FillScalar(dst, i, pixel);
+
+	const __m256i value = _mm256_set1_epi32((int)pixel);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_stream_si256((__m256i*)(dst + i), value);
+	}
+
+	FillScalar(dst + i, count - i, pixel);
+}
+
+CLIPPING_TARGET_AVX2 static void StreamCopyAvx2(uint32_t* dst, const uint32_t* src, const int32_t count)
+{
+	int32_t i = AlignedHead(dst, count, 32);
+	CopyScalar(dst, src, i);
+
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_stream_si256((__m256i*)(dst + i), _mm256_loadu_si256((const __m256i*)(src + i)));
+	}
+
+	CopyScalar(dst + i, src + i, count - i);
+}
+
+static bool CpuHasAvx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+
+	if (info[0] < 7)
+	{
+		return false;
+	}
+
+	// The OS must save the YMM registers on context switches (OSXSAVE + XCR0 bits 1 and 2)
+	__cpuid(info, 1);
+	constexpr int osxsaveAndAvx = (1 << 27) | (1 << 28);
+
+	if ((info[2] & osxsaveAndAvx) != osxsaveAndAvx || (_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+static constexpr Kernels ScalarKernels = { FillScalar, BlendFillScalar, BlendScalar, GradientScalar, TintScalar, FillScalar, CopyScalar, FenceScalar };
+
+#ifdef CLIPPING_X86
+static constexpr Kernels Sse2Kernels = { FillSse2, BlendFillSse2, BlendSse2, GradientSse2, TintSse2, StreamFillSse2, StreamCopySse2, FenceSse2 };
+static constexpr Kernels Avx2Kernels = { FillAvx2, BlendFillAvx2, BlendAvx2, GradientAvx2, TintAvx2, StreamFillAvx2, StreamCopyAvx2, FenceSse2 };
+#endif
+
+static Rasterizer::Isa MaxSupportedIsa()
+{
+#ifdef CLIPPING_X86
+	static const auto isa = CpuHasAvx2() ? Rasterizer::IsaAvx2 : Rasterizer::IsaSse2;
+	return isa;
+#else
+	return Rasterizer::IsaScalar;
+#endif
+}
+
+static Rasterizer::Isa s_isa = MaxSupportedIsa();
+
+static const Kernels& ActiveKernels()
+{
+#ifdef CLIPPING_X86
+	switch (s_isa)
+	{
+	case Rasterizer::IsaAvx2:
+		return Avx2Kernels;
+	case Rasterizer::IsaSse2:
+		return Sse2Kernels;
+	default:
+		break;
+	}
+#endif
+
+	return ScalarKernels;
+}
+
+// Aura glow: a rounded frame mask blurred into a soft falloff, in premultiplied pixels for one depth and color.
+// Away from the corners the glow only depends on the distance to the edge, so a corner tile and an edge
+// profile are enough to compose it at any size.
+struct AuraTiles
+{
+	int32_t depth;
+	uint32_t color; // 0x00RRGGBB
+	std::vector<uint32_t> corner; // depth x depth, top-left corner of the overlay
+	std::vector<uint32_t> cornerMirror; // The same rows, right to left
+	std::vector<uint32_t> edge; // From the edge inwards
+	std::vector<uint32_t> edgeMirror;
+};
+
+// Box blur with clamped borders over 'count' values 'stride' apart, using a running sum
+static void BoxBlur(float* values, const int32_t count, const int32_t stride, const int32_t radius, std::vector<float>& scratch)
+{
+	scratch.resize((size_t)count);
+
+	for (int32_t i = 0; i < count; i++)
+	{
+		scratch[i] = values[(size_t)i * stride];
+	}
+
+	const auto at = [&](const int32_t i) { return scratch[std::clamp(i, 0, count - 1)]; };
+	const float scale = 1.0f / (float)(2 * radius + 1);
+	float sum = 0;
+
+	for (int32_t i = -radius; i <= radius; i++)
+	{
+		sum += at(i);
+	}
+
+	for (int32_t i = 0; i < count; i++)
+	{
+		values[(size_t)i * stride] = sum * scale;
+		sum += at(i + radius + 1) - at(i - radius);
+	}
+}
+
+static std::shared_ptr<const AuraTiles> BuildAuraTiles(const int32_t depth, const uint8_t alpha, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	// The glow comes from a band along the edges whose inner side is a rounded rectangle. Three box blurs
+	// make a close approximation of a Gaussian with sigma ~ radius, which fades out well before 'depth'.
+	const int32_t band = std::max(depth / 6, 1);
+	const int32_t rounding = std::max(depth / 2, 1);
+	const int32_t radius = std::max(depth / 4, 1);
+
+	// Corner of the mask, large enough for the blur to reach the tiles. Clamping at the borders extends
+	// it outwards (the band) and inwards along the edges (away from the corner).
+	const int32_t size = depth + 3 * radius + 1;
+	std::vector<float> glow((size_t)size * size);
+
+	for (int32_t y = 0; y < size; y++)
+	{
+		for (int32_t x = 0; x < size; x++)
+		{
+			const float dx = std::max((float)(band + rounding) - ((float)x + 0.5f), 0.0f);
+			const float dy = std::max((float)(band + rounding) - ((float)y + 0.5f), 0.0f);
+			const bool inside = x >= band && y >= band && dx * dx + dy * dy <= (float)(rounding * rounding);
+			glow[(size_t)y * size + x] = inside ? 0.0f : 1.0f;
+		}
+	}
+
+	std::vector<float> scratch;
+
+	for (int pass = 0; pass < 3; pass++)
+	{
+		for (int32_t y = 0; y < size; y++)
+		{
+			BoxBlur(glow.data() + (size_t)y * size, size, 1, radius, scratch);
+		}
+
+		for (int32_t x = 0; x < size; x++)
+		{
+			BoxBlur(glow.data() + x, size, size, radius, scratch);
+		}
+	}
+
+	// The edge, away from the corner, peaks at the given alpha. The corner is only brighter by the
+	// little light the blur lost along the edge, and is capped to the same peak.
+	const auto edgeAt = [&](const int32_t i) { return glow[(size_t)i * size + size - 1]; };
+	const float scale = (float)alpha / edgeAt(0);
+
+	const auto pixel = [&](const float value)
+	{
+		return MakePixel((uint32_t)std::min(std::lround(value * scale), (long)alpha), r, g, b);
+	};
+
+	auto tiles = std::make_shared<AuraTiles>();
+	tiles->depth = depth;
+	tiles->color = (uint32_t)r << 16 | (uint32_t)g << 8 | b;
+	tiles->corner.resize((size_t)depth * depth);
+	tiles->cornerMirror.resize((size_t)depth * depth);
+	tiles->edge.resize((size_t)depth);
+	tiles->edgeMirror.resize((size_t)depth);
+
+	for (int32_t i = 0; i < depth; i++)
+	{
+		tiles->edge[i] = pixel(edgeAt(i));
+		tiles->edgeMirror[depth - 1 - i] = tiles->edge[i];
+
+		for (int32_t x = 0; x < depth; x++)
+		{
+			const auto value = pixel(glow[(size_t)i * size + x]);
+			tiles->corner[(size_t)i * depth + x] = value;
+			tiles->cornerMirror[(size_t)i * depth + depth - 1 - x] = value;
+		}
+	}
+
+	return tiles;
+}
+
+// A few recent (depth, color) pairs: an overlay is rendered at a handful of window sizes in one color
+static std::mutex s_auraMutex;
+static std::vector<std::shared_ptr<const AuraTiles>> s_auraTiles; // Most recent first
+
+static std::shared_ptr<const AuraTiles> GetAuraTiles(const int32_t depth, const uint8_t alpha, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	constexpr size_t Capacity = 4;
+
+	const uint32_t color = (uint32_t)r << 16 | (uint32_t)g << 8 | b;
+
+	{
+		std::lock_guard lock(s_auraMutex);
+
+		for (auto it = s_auraTiles.begin(); it != s_auraTiles.end(); ++it)
+		{
+			if ((*it)->depth == depth && (*it)->color == color)
+			{
+				std::rotate(s_auraTiles.begin(), it, it + 1);
+				return s_auraTiles.front();
+			}
+		}
+	}
+
+	auto tiles = BuildAuraTiles(depth, alpha, r, g, b);
+
+	std::lock_guard lock(s_auraMutex);
+	s_auraTiles.insert(s_auraTiles.begin(), tiles);
+
+	if (s_auraTiles.size() > Capacity)
+	{
+		s_auraTiles.pop_back();
+	}
+
+	return tiles;
+}
+
+void Rasterizer::ReleaseCaches()
+{
+	std::lock_guard lock(s_auraMutex);
+	s_auraTiles.clear();
+	s_auraTiles.shrink_to_fit();
+}
+
+Rasterizer::Isa Rasterizer::GetIsa()
+{
+	return s_isa;
+}
+
+Rasterizer::Isa Rasterizer::SetIsa(const Isa isa)
+{
+	s_isa = std::min(isa, MaxSupportedIsa());
+	return s_isa;
+}
+
+void Rasterizer::Clear(const Target& target)
+{
+	const auto& surface = target.surface;
+	const auto& kernels = ActiveKernels();
+
+	for (int32_t y = 0; y < surface.height; y++)
+	{
+		auto* dst = surface.bits + (size_t)y * surface.stride;
+
+		if (target.stream)
+		{
+			kernels.streamFill(dst, surface.width, 0);
+		}
+		else
+		{
+			memset(dst, 0, (size_t)surface.width * sizeof(uint32_t));
+		}
+	}
+}
+
+void Rasterizer::FillRect(const Target& target, const int32_t x, const int32_t y, const int32_t width, const int32_t height, const uint32_t pixel, const bool blend)
+{
+	const auto& surface = target.surface;
+	const int32_t x0 = std::max(x - target.x, 0);
+	const int32_t x1 = std::min(x + width - target.x, surface.width);
+	const int32_t y0 = std::max(y - target.y, 0);
+	const int32_t y1 = std::min(y + height - target.y, surface.height);
+
+	if (x0 >= x1)
+	{
+		return;
+	}
+
+	const auto& kernels = ActiveKernels();
+	const auto fill = blend ? kernels.blendFill : target.stream ? kernels.streamFill : kernels.fill;
+
+	for (int32_t row = y0; row < y1; row++)
+	{
+		fill(surface.bits + (size_t)row * surface.stride + x0, x1 - x0, pixel);
+	}
+}
+
+void Rasterizer::VerticalGradient(const Target& target, const int32_t x, const int32_t y, const int32_t width, const int32_t height, const uint8_t alpha0, const uint8_t alpha1, const uint8_t r, const uint8_t g, const uint8_t b, const bool blend)
+{
+	// Every row of a vertical gradient is a single color
+	const auto ramp = MakeRamp(alpha0, alpha1, height, r, g, b);
+	const int32_t y0 = std::max(y, target.y);
+	const int32_t y1 = std::min(y + height, target.y + target.surface.height);
+
+	for (int32_t row = y0; row < y1; row++)
+	{
+		FillRect(target, x, row, width, 1, RampPixel(ramp, row - y), blend);
+	}
+}
+
+void Rasterizer::HorizontalGradient(const Target& target, const int32_t x, const int32_t y, const int32_t width, const int32_t height, const uint8_t alpha0, const uint8_t alpha1, const uint8_t r, const uint8_t g, const uint8_t b, const bool blend)
+{
+	const auto& surface = target.surface;
+	const auto ramp = MakeRamp(alpha0, alpha1, width, r, g, b);
+	const int32_t x0 = std::max(x - target.x, 0);
+	const int32_t x1 = std::min(x + width - target.x, surface.width);
+	const int32_t y0 = std::max(y - target.y, 0);
+	const int32_t y1 = std::min(y + height - target.y, surface.height);
+
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return;
+	}
+
+	// Every row of a horizontal gradient is identical: evaluate the profile once, then replicate it
+	const auto& kernels = ActiveKernels();
+	const int32_t count = x1 - x0;
+	std::vector<uint32_t> profile((size_t)count);
+	kernels.gradient(profile.data(), count, x0 + target.x - x, ramp);
+
+	const auto copy = target.stream ? kernels.streamCopy : CopyScalar;
+
+	for (int32_t row = y0; row < y1; row++)
+	{
+		auto* dst = surface.bits + (size_t)row * surface.stride + x0;
+
+		if (blend)
+		{
+			kernels.blend(dst, profile.data(), count);
+		}
+		else
+		{
+			copy(dst, profile.data(), count);
+		}
+	}
+}
+
+int32_t Rasterizer::GradientSize(const int32_t size)
+{
+	return std::max(size * GradientHeightPct / 100, 2);
+}
+
+int32_t Rasterizer::AuraDepth(const int32_t height)
+{
+	return std::max(height * AuraDepthPct / 100, 2);
+}
+
+void Rasterizer::Render(const Surface& surface, const OverlayType type, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	RenderRegion(surface, 0, 0, surface.width, surface.height, type, r, g, b);
+}
+
+void Rasterizer::RenderRegion(const Surface& surface, const int32_t x, const int32_t y, const int32_t width, const int32_t height, const OverlayType type, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	if (!surface.bits || surface.width <= 0 || surface.height <= 0 || width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	const auto bytes = (size_t)surface.stride * surface.height * sizeof(uint32_t);
+
+	// Every pixel is written once, which is better done with streaming stores on surfaces that don't fit in cache
+	const bool stream = bytes >= StreamingBytes;
+	const Target target = { surface, x, y, width, height, stream };
+
+	// The aura writes all of its pixels, the transparent ones included
+	if (type != OverlayAura)
+	{
+		Clear(target);
+	}
+
+	switch (type)
+	{
+	case OverlayBorder:
+		RenderBorder(target, r, g, b);
+		break;
+	case OverlayAura:
+		RenderAura(target, r, g, b);
+		break;
+	case OverlayBottom:
+		RenderBottom(target, r, g, b);
+		break;
+	case OverlayLeft:
+		RenderLeft(target, r, g, b);
+		break;
+	case OverlayRight:
+		RenderRight(target, r, g, b);
+		break;
+	case OverlayTop:
+		RenderTop(target, r, g, b);
+		break;
+	default:
+		break;
+	}
+
+	if (stream)
+	{
+		ActiveKernels().fence();
+	}
+}
+
+void Rasterizer::RenderRegion(const Surface& surface, const int32_t x, const int32_t y, const int32_t width, const int32_t height, const DrawList& list, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	if (!surface.bits || surface.width <= 0 || surface.height <= 0 || width <= 0 || height <= 0)
+	{
+		return;
+	}
+
+	const bool stream = (size_t)surface.stride * surface.height * sizeof(uint32_t) >= StreamingBytes;
+	const Target target = { surface, x, y, width, height, stream };
+
+	// Opposite bands only overlap on overlays too small for the style, where everything has to be composited
+	Insets insets;
+	const bool overlap = !GetInsets(list, width, height, insets);
+
+	Clear(target);
+
+	for (const auto& op : list.ops)
+	{
+		RenderOp(target, op, op.blend || overlap, r, g, b);
+	}
+
+	if (stream)
+	{
+		ActiveKernels().fence();
+	}
+}
+
+bool Rasterizer::GetInsets(const OverlayType type, const int32_t width, const int32_t height, Insets& insets)
+{
+	switch (type)
+	{
+	case OverlayTop:
+		insets = { GradientSize(height), 0, 0, 0 };
+		break;
+	case OverlayBottom:
+		insets = { 0, GradientSize(height), 0, 0 };
+		break;
+	case OverlayLeft:
+		insets = { 0, 0, GradientSize(width), 0 };
+		break;
+	case OverlayRight:
+		insets = { 0, 0, 0, GradientSize(width) };
+		break;
+	case OverlayBorder:
+		insets = { BorderThickness, BorderThickness, BorderThickness, BorderThickness };
+		break;
+	case OverlayAura:
+	{
+		const auto depth = AuraDepth(height);
+		insets = { depth, depth, depth, depth };
+		break;
+	}
+	default:
+		return false;
+	}
+
+	return width > insets.left + insets.right && height > insets.top + insets.bottom;
+}
+
+bool Rasterizer::GetInsets(const DrawList& list, const int32_t width, const int32_t height, Insets& insets)
+{
+	insets = list.insets;
+	return width > insets.left + insets.right && height > insets.top + insets.bottom;
+}
+
+template <typename RenderPatch>
+void Rasterizer::ForEachPatch(const Surface& surface, const Insets& insets, const int32_t width, const int32_t height, const RenderPatch& render)
+{
+	// Each patch is rendered from the matching region of the full overlay, so the template holds exactly its pixels
+	const int32_t rows[3][2] = { { 0, insets.top }, { insets.top, 1 }, { height - insets.bottom, insets.bottom } };
+	const int32_t columns[3][2] = { { 0, insets.left }, { insets.left, 1 }, { width - insets.right, insets.right } };
+	int32_t top = 0;
+
+	for (const auto& row : rows)
+	{
+		int32_t left = 0;
+
+		for (const auto& column : columns)
+		{
+			const Surface patch = { surface.bits + (size_t)top * surface.stride + left, column[1], row[1], surface.stride };
+			render(patch, column[0], row[0]);
+			left += column[1];
+		}
+
+		top += row[1];
+	}
+}
+
+void Rasterizer::RenderTemplate(const Surface& surface, const Insets& insets, const int32_t width, const int32_t height, const OverlayType type, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	ForEachPatch(surface, insets, width, height, [&](const Surface& patch, const int32_t x, const int32_t y)
+	{
+		RenderRegion(patch, x, y, width, height, type, r, g, b);
+	});
+}
+
+void Rasterizer::RenderTemplate(const Surface& surface, const Insets& insets, const int32_t width, const int32_t height, const DrawList& list, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	ForEachPatch(surface, insets, width, height, [&](const Surface& patch, const int32_t x, const int32_t y)
+	{
+		RenderRegion(patch, x, y, width, height, list, r, g, b);
+	});
+}
+
+void Rasterizer::ComposeRegion(const Surface& surface, const int32_t x, const int32_t y, const int32_t width, const int32_t height, const Surface& source, const Insets& insets)
+{
+	if (!surface.bits || surface.width <= 0 || surface.height <= 0)
+	{
+		return;
+	}
+
+	const auto& kernels = ActiveKernels();
+	const bool stream = (size_t)surface.stride * surface.height * sizeof(uint32_t) >= StreamingBytes;
+	const auto copy = stream ? kernels.streamCopy : CopyScalar;
+	const auto fill = stream ? kernels.streamFill : kernels.fill;
+
+	// Columns [0, left) and [right, width) are copied from the template, the ones in between are filled
+	const int32_t left = insets.left;
+	const int32_t right = width - insets.right;
+	const int32_t x0 = x;
+	const int32_t x1 = x + surface.width;
+
+	for (int32_t row = 0; row < surface.height; row++)
+	{
+		const int32_t overlayRow = y + row;
+		int32_t sourceRow = insets.top;
+
+		if (overlayRow < insets.top)
+		{
+			sourceRow = overlayRow;
+		}
+		else if (overlayRow >= height - insets.bottom)
+		{
+			sourceRow = insets.top + 1 + overlayRow - (height - insets.bottom);
+		}
+
+		const auto* src = source.bits + (size_t)sourceRow * source.stride;
+		auto* line = surface.bits + (size_t)row * surface.stride;
+
+		if (const int32_t from = std::max(x0, 0), to = std::min(x1, left); from < to)
+		{
+			copy(line + from - x0, src + from, to - from);
+		}
+
+		if (const int32_t from = std::max(x0, left), to = std::min(x1, right); from < to)
+		{
+			fill(line + from - x0, to - from, src[left]);
+		}
+
+		if (const int32_t from = std::max(x0, right), to = std::min(x1, width); from < to)
+		{
+			copy(line + from - x0, src + left + 1 + from - right, to - from);
+		}
+	}
+
+	if (stream)
+	{
+		kernels.fence();
+	}
+}
+
+void Rasterizer::ExtractCoverage(const Surface& surface, uint8_t* coverage, const int32_t coverageStride)
+{
+	for (int32_t y = 0; y < surface.height; y++)
+	{
+		const auto* src = surface.bits + (size_t)y * surface.stride;
+		auto* dst = coverage + (size_t)y * coverageStride;
+
+		for (int32_t x = 0; x < surface.width; x++)
+		{
+			dst[x] = (uint8_t)(src[x] >> 24);
+		}
+	}
+}
+
+void Rasterizer::Tint(const Surface& surface, const uint8_t* coverage, const int32_t coverageStride, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	if (!surface.bits || surface.width <= 0 || surface.height <= 0)
+	{
+		return;
+	}
+
+	// The coverage is read as the pixels are written, streaming stores don't make that any faster
+	const auto tint = ActiveKernels().tint;
+	const auto ramp = MakeRamp(0, 0, 1, r, g, b);
+
+	for (int32_t y = 0; y < surface.height; y++)
+	{
+		tint(surface.bits + (size_t)y * surface.stride, coverage + (size_t)y * coverageStride, surface.width, ramp);
+	}
+}
+
+int32_t Rasterizer::GetStrips(const OverlayType type, const int32_t width, const int32_t height, Strip (&strips)[MaxStrips])
+{
+	int32_t count = 0;
+
+	const auto addFrame = [&](const int32_t thickness)
+	{
+		// Top and bottom strips span the corners, left and right strips fill the space in between
+		if (width <= 2 * thickness || height <= 2 * thickness)
+		{
+			return false;
+		}
+
+		strips[count++] = { 0, 0, width, thickness };
+		strips[count++] = { 0, height - thickness, width, thickness };
+		strips[count++] = { 0, thickness, thickness, height - 2 * thickness };
+		strips[count++] = { width - thickness, thickness, thickness, height - 2 * thickness };
+		return true;
+	};
+
+	switch (type)
+	{
+	case OverlayTop:
+		strips[count++] = { 0, 0, width, std::min(GradientSize(height), height) };
+		break;
+	case OverlayBottom:
+		strips[count++] = { 0, std::max(height - GradientSize(height), 0), width, std::min(GradientSize(height), height) };
+		break;
+	case OverlayLeft:
+		strips[count++] = { 0, 0, std::min(GradientSize(width), width), height };
+		break;
+	case OverlayRight:
+		strips[count++] = { std::max(width - GradientSize(width), 0), 0, std::min(GradientSize(width), width), height };
+		break;
+	case OverlayBorder:
+		addFrame(BorderThickness);
+		break;
+	case OverlayAura:
+		addFrame(AuraDepth(height));
+		break;
+	default:
+		break;
+	}
+
+	if (count == 0)
+	{
+		strips[count++] = { 0, 0, width, height };
+	}
+
+	return count;
+}
+
+int32_t Rasterizer::GetStrips(const DrawList& list, const int32_t width, const int32_t height, Strip (&strips)[MaxStrips])
+{
+	const auto& insets = list.insets;
+	int32_t count = 0;
+
+	// Same layout as the frame of the built-in styles, with a thickness per edge and no strip for the unused edges
+	if (width > insets.left + insets.right && height > insets.top + insets.bottom)
+	{
+		const int32_t middle = height - insets.top - insets.bottom;
+
+		if (insets.top > 0)
+		{
+			strips[count++] = { 0, 0, width, insets.top };
+		}
+
+		if (insets.bottom > 0)
+		{
+			strips[count++] = { 0, height - insets.bottom, width, insets.bottom };
+		}
+
+		if (insets.left > 0)
+		{
+			strips[count++] = { 0, insets.top, insets.left, middle };
+		}
+
+		if (insets.right > 0)
+		{
+			strips[count++] = { width - insets.right, insets.top, insets.right, middle };
+		}
+	}
+
+	if (count == 0)
+	{
+		strips[count++] = { 0, 0, width, height };
+	}
+
+	return count;
+}
+
+void Rasterizer::RenderTop(const Target& target, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	VerticalGradient(target, 0, 0, target.width, GradientSize(target.height), GradientAlpha, 0x00, r, g, b, false);
+}
+
+void Rasterizer::RenderBottom(const Target& target, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	const int32_t gradientHeight = GradientSize(target.height);
+	VerticalGradient(target, 0, target.height - gradientHeight, target.width, gradientHeight, 0x00, GradientAlpha, r, g, b, false);
+}
+
+void Rasterizer::RenderLeft(const Target& target, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	HorizontalGradient(target, 0, 0, GradientSize(target.width), target.height, GradientAlpha, 0x00, r, g, b, false);
+}
+
+void Rasterizer::RenderRight(const Target& target, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	const int32_t gradientWidth = GradientSize(target.width);
+	HorizontalGradient(target, target.width - gradientWidth, 0, gradientWidth, target.height, 0x00, GradientAlpha, r, g, b, false);
+}
+
+void Rasterizer::RenderBorder(const Target& target, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	const auto pixel = MakePixel(BorderAlpha, r, g, b);
+	const int32_t width = target.width;
+	const int32_t height = target.height;
+	const int32_t t = BorderThickness;
+
+	// The strips only overlap on windows smaller than twice the thickness, where they have to be composited
+	const bool overlapX = width < 2 * t;
+	const bool overlapY = height < 2 * t;
+
+	// Top strip
+	FillRect(target, 0, 0, width, t, pixel, false);
+	// Bottom strip
+	FillRect(target, 0, height - t, width, t, pixel, overlapY);
+	// Left strip
+	FillRect(target, 0, t, t, height - 2 * t, pixel, false);
+	// Right strip
+	FillRect(target, width - t, t, t, height - 2 * t, pixel, overlapX);
+}
+
+void Rasterizer::RenderAura(const Target& target, const uint8_t r, const uint8_t g, const uint8_t b)
+{
+	const auto& surface = target.surface;
+	const int32_t width = target.width;
+	const int32_t height = target.height;
+	const int32_t depth = AuraDepth(height);
+	const auto tiles = GetAuraTiles(depth, GradientAlpha, r, g, b);
+
+	const auto& kernels = ActiveKernels();
+	const auto copy = target.stream ? kernels.streamCopy : CopyScalar;
+	const auto fill = target.stream ? kernels.streamFill : kernels.fill;
+
+	// Columns [0, left) come from the left tiles and [right, width) from the mirrored ones. Windows
+	// narrower than two depths are split in the middle.
+	const int32_t left = std::min(depth, (width + 1) / 2);
+	const int32_t right = std::max(width - depth, left);
+	const int32_t x0 = target.x;
+	const int32_t x1 = target.x + surface.width;
+
+	for (int32_t row = 0; row < surface.height; row++)
+	{
+		const int32_t y = target.y + row;
+		const int32_t distance = std::min(y, height - 1 - y);
+		auto* line = surface.bits + (size_t)row * surface.stride;
+
+		const bool band = distance < depth;
+		const auto* leftTile = band ? tiles->corner.data() + (size_t)distance * depth : tiles->edge.data();
+		const auto* rightTile = band ? tiles->cornerMirror.data() + (size_t)distance * depth : tiles->edgeMirror.data();
+		const uint32_t middle = band ? tiles->edge[distance] : 0;
+
+		// Spans in overlay coordinates, clipped to the region
+		if (const int32_t from = std::max(x0, 0), to = std::min(x1, left); from < to)
+		{
+			copy(line + from - x0, leftTile + from, to - from);
+		}
+
+		if (const int32_t from = std::max(x0, left), to = std::min(x1, right); from < to)
+		{
+			fill(line + from - x0, to - from, middle);
+		}
+
+		if (const int32_t from = std::max(x0, right), to = std::min(x1, width); from < to)
+		{
+			copy(line + from - x0, rightTile + from - (width - depth), to - from);
+		}
+	}
+}
+
+void Rasterizer::RenderOp(const Target& target, const DrawOp& op, const bool blend, uint8_t r, uint8_t g, uint8_t b)
+{
+	if (op.ownColor)
+	{
+		r = (uint8_t)(op.color >> 16);
+		g = (uint8_t)(op.color >> 8);
+		b = (uint8_t)op.color;
+	}
+
+	const int32_t thickness = op.to - op.from;
+	const int32_t span = target.height - op.spanStart - op.spanEnd;
+
+	// The ramps run from the edge inwards, so the bottom and right ones are reversed
+	switch (op.edge)
+	{
+	case EdgeTop:
+		VerticalGradient(target, 0, op.from, target.width, thickness, op.alpha0, op.alpha1, r, g, b, blend);
+		break;
+	case EdgeBottom:
+		VerticalGradient(target, 0, target.height - op.to, target.width, thickness, op.alpha1, op.alpha0, r, g, b, blend);
+		break;
+	case EdgeLeft:
+		HorizontalGradient(target, op.from, op.spanStart, thickness, span, op.alpha0, op.alpha1, r, g, b, blend);
+		break;
+	case EdgeRight:
+		HorizontalGradient(target, target.width - op.to, op.spanStart, thickness, span, op.alpha1, op.alpha0, r, g, b, blend);
+		break;
+	}
+}
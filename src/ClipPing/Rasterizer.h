@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "OverlayType.h"
+
+// A view over 32bpp premultiplied BGRA pixels (the layout of a top-down DIB section).
+struct Surface
+{
+	uint32_t* bits = nullptr;
+	int32_t width = 0;
+	int32_t height = 0;
+	int32_t stride = 0; // In pixels
+};
+
+// A rectangle in overlay coordinates
+struct Strip
+{
+	int32_t x = 0;
+	int32_t y = 0;
+	int32_t width = 0;
+	int32_t height = 0;
+};
+
+// Thickness of the painted bands along each edge of an overlay
+struct Insets
+{
+	int32_t top = 0;
+	int32_t bottom = 0;
+	int32_t left = 0;
+	int32_t right = 0;
+
+	bool operator==(const Insets&) const = default;
+};
+
+enum DrawEdge : uint8_t { EdgeTop, EdgeBottom, EdgeLeft, EdgeRight };
+
+// A band of a custom style running along one edge, with its distances to the edge in pixels.
+// Top and bottom bands span the whole width, left and right bands leave out the rows of the
+// top and bottom bands of their shape so that the corners aren't painted twice.
+struct DrawOp
+{
+	DrawEdge edge = EdgeTop;
+	uint8_t alpha0 = 0; // At 'from', the side nearest to the edge
+	uint8_t alpha1 = 0; // At 'to'
+	bool blend = false; // Composited over the shapes drawn before
+	bool ownColor = false; // Otherwise painted in the overlay color
+	uint32_t color = 0; // 0x00RRGGBB
+	int32_t from = 0;
+	int32_t to = 0;
+	int32_t spanStart = 0; // Rows left out at the top by left and right bands
+	int32_t spanEnd = 0; // And at the bottom
+};
+
+// A custom style resolved at one DPI, run by the rasterizer in order
+struct DrawList
+{
+	uint32_t id = 0; // Identifies the style and the DPI, 0 for an empty list
+	std::vector<DrawOp> ops;
+	Insets insets; // The deepest band along each edge
+	bool tintable = true; // Every band is in the overlay color, so the list has a coverage mask
+};
+
+// Software rasterizer for the overlay styles. It has no platform dependencies and writes
+// straight into the surface. The gradients and the border match the pixels GDI+ produced within +/-1
+// per channel; the aura is a blurred glow composed from tiles cached per depth and color. Custom
+// styles come as draw lists of gradient bands, run with the same kernels.
+class Rasterizer
+{
+public:
+	enum Isa : uint8_t { IsaScalar, IsaSse2, IsaAvx2 };
+
+	static constexpr int MaxStrips = 4;
+
+	static void Render(const Surface& surface, OverlayType type, uint8_t r, uint8_t g, uint8_t b);
+
+	// Renders the part of a width x height overlay that starts at (x, y) and has the size of the surface
+	static void RenderRegion(const Surface& surface, int32_t x, int32_t y, int32_t width, int32_t height, OverlayType type, uint8_t r, uint8_t g, uint8_t b);
+	static void RenderRegion(const Surface& surface, int32_t x, int32_t y, int32_t width, int32_t height, const DrawList& list, uint8_t r, uint8_t g, uint8_t b);
+
+	// Splits a width x height overlay into the strips that contain all of its painted pixels.
+	// Always returns at least one strip, the whole overlay when the style can't be split.
+	static int32_t GetStrips(OverlayType type, int32_t width, int32_t height, Strip (&strips)[MaxStrips]);
+	static int32_t GetStrips(const DrawList& list, int32_t width, int32_t height, Strip (&strips)[MaxStrips]);
+
+	// Every style is a nine-patch: fixed corners, edges that only vary across, and a uniform interior.
+	// Returns false if the overlay is too small for its edges to be separated by at least one pixel.
+	static bool GetInsets(OverlayType type, int32_t width, int32_t height, Insets& insets);
+	static bool GetInsets(const DrawList& list, int32_t width, int32_t height, Insets& insets);
+
+	// Renders the template of a width x height overlay: the overlay with its middle row and column collapsed
+	// to a single pixel. The surface must be (left + 1 + right) x (top + 1 + bottom).
+	static void RenderTemplate(const Surface& surface, const Insets& insets, int32_t width, int32_t height, OverlayType type, uint8_t r, uint8_t g, uint8_t b);
+	static void RenderTemplate(const Surface& surface, const Insets& insets, int32_t width, int32_t height, const DrawList& list, uint8_t r, uint8_t g, uint8_t b);
+
+	// Renders the region of a width x height overlay starting at (x, y) from its template, with copies and fills only
+	static void ComposeRegion(const Surface& surface, int32_t x, int32_t y, int32_t width, int32_t height, const Surface& source, const Insets& insets);
+
+	// A style is only shaped by the alpha of its pixels, every channel being the overlay color times the
+	// alpha. The coverage is that alpha, so the style is rasterized once and tinted for each color.
+	static void ExtractCoverage(const Surface& surface, uint8_t* coverage, int32_t coverageStride);
+
+	// Writes the premultiplied pixels of the color at the coverage, which has the size of the surface
+	static void Tint(const Surface& surface, const uint8_t* coverage, int32_t coverageStride, uint8_t r, uint8_t g, uint8_t b);
+
+	// Drops the aura tiles kept between renders, they're rebuilt on the next aura
+	static void ReleaseCaches();
+
+	// Returns the instruction set used by the kernels. SetIsa is clamped to what the CPU supports.
+	static Isa GetIsa();
+	static Isa SetIsa(Isa isa);
+
+	static constexpr int GradientHeightPct = 10;
+	static constexpr int AuraDepthPct = 5;
+	static constexpr int BorderThickness = 8;
+	static constexpr uint8_t GradientAlpha = 0x50;
+	static constexpr uint8_t BorderAlpha = 0x80;
+
+private:
+	// The surface holds the region of a width x height overlay starting at (x, y)
+	struct Target
+	{
+		Surface surface;
+		int32_t x;
+		int32_t y;
+		int32_t width;
+		int32_t height;
+		bool stream; // Use non-temporal stores for pixels that are written once
+	};
+
+	static constexpr size_t StreamingBytes = 8 * 1024 * 1024;
+
+	static void Clear(const Target& target);
+	static void FillRect(const Target& target, int32_t x, int32_t y, int32_t width, int32_t height, uint32_t pixel, bool blend);
+	static void VerticalGradient(const Target& target, int32_t x, int32_t y, int32_t width, int32_t height, uint8_t alpha0, uint8_t alpha1, uint8_t r, uint8_t g, uint8_t b, bool blend);
+	static void HorizontalGradient(const Target& target, int32_t x, int32_t y, int32_t width, int32_t height, uint8_t alpha0, uint8_t alpha1, uint8_t r, uint8_t g, uint8_t b, bool blend);
+
+	static int32_t GradientSize(int32_t size);
+	static int32_t AuraDepth(int32_t height);
+
+	static void RenderTop(const Target& target, uint8_t r, uint8_t g, uint8_t b);
+	static void RenderBottom(const Target& target, uint8_t r, uint8_t g, uint8_t b);
+	static void RenderLeft(const Target& target, uint8_t r, uint8_t g, uint8_t b);
+	static void RenderRight(const Target& target, uint8_t r, uint8_t g, uint8_t b);
+	static void RenderBorder(const Target& target, uint8_t r, uint8_t g, uint8_t b);
+	static void RenderAura(const Target& target, uint8_t r, uint8_t g, uint8_t b);
+	static void RenderOp(const Target& target, const DrawOp& op, bool blend, uint8_t r, uint8_t g, uint8_t b);
+
+	template <typename RenderPatch>
+	static void ForEachPatch(const Surface& surface, const Insets& insets, int32_t width, int32_t height, const RenderPatch& render);
+};
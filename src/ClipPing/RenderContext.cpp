@@ -0,0 +1,137 @@
+// ReSharper disable CppCStyleCast
+#include "RenderContext.h"
+
+#include <algorithm>
+
+#include "Trace.h"
+
+static uint64_t GetThreadCycles()
+{
+	ULONG64 cycles = 0;
+	QueryThreadCycleTime(GetCurrentThread(), &cycles);
+	return cycles;
+}
+
+RenderContext::~RenderContext()
+{
+	if (_memoryDeviceContext)
+	{
+		DeleteDC(_memoryDeviceContext);
+	}
+}
+
+void RenderContext::Bind(const int32_t index, const HWND hwnd, const HBITMAP bitmap, const POINT position, const SIZE size)
+{
+	if (index < 0 || index >= MaxLayers)
+	{
+		return;
+	}
+
+	auto& layer = _layers[index];
+	const bool unchanged = layer.uploaded && layer.hwnd == hwnd && layer.bitmap == bitmap && layer.size.cx == size.cx && layer.size.cy == size.cy;
+
+	layer = { hwnd, bitmap, position, size, unchanged };
+}
+
+void RenderContext::SetLayerCount(const int32_t count)
+{
+	_layerCount = std::clamp(count, 0, MaxLayers);
+}
+
+void RenderContext::Reset()
+{
+	for (auto& layer : _layers)
+	{
+		layer.uploaded = false;
+	}
+
+	_layerCount = 0;
+}
+
+void RenderContext::Present(const uint8_t alpha)
+{
+	if (_layerCount == 0)
+	{
+		return;
+	}
+
+	const auto startCycles = GetThreadCycles();
+
+	BLENDFUNCTION blend = {};
+	blend.BlendOp = AC_SRC_OVER;
+	blend.SourceConstantAlpha = alpha;
+	blend.AlphaFormat = AC_SRC_ALPHA;
+
+	// Without a source DC, the window keeps its content and position and only the alpha changes
+	UPDATELAYEREDWINDOWINFO info = {};
+	info.cbSize = sizeof(info);
+	info.pblend = &blend;
+	info.dwFlags = ULW_ALPHA;
+
+	bool uploaded = false;
+
+	for (int32_t i = 0; i < _layerCount; i++)
+	{
+		auto& layer = _layers[i];
+
+		if (!layer.uploaded)
+		{
+			uploaded |= Upload(layer, blend);
+			continue;
+		}
+
+		ScopedSpan span(SpanUpdateLayeredWindow);
+		UpdateLayeredWindowIndirect(layer.hwnd, &info);
+	}
+
+	// Deselect the last bitmap, the cache can't delete it while it's selected
+	if (uploaded)
+	{
+		SelectObject(_memoryDeviceContext, _defaultBitmap);
+	}
+
+	const auto cycles = GetThreadCycles() - startCycles;
+	_stats.frames++;
+	_stats.lastCycles = cycles;
+	_stats.totalCycles += cycles;
+	_stats.maxCycles = std::max(_stats.maxCycles, cycles);
+}
+
+bool RenderContext::Upload(Layer& layer, const BLENDFUNCTION& blend)
+{
+	if (!_memoryDeviceContext)
+	{
+		_memoryDeviceContext = CreateCompatibleDC(nullptr);
+
+		if (!_memoryDeviceContext)
+		{
+			return false;
+		}
+	}
+
+	const auto previous = SelectObject(_memoryDeviceContext, layer.bitmap);
+
+	if (!previous)
+	{
+		return false;
+	}
+
+	_defaultBitmap = _defaultBitmap ? _defaultBitmap : previous;
+
+	POINT source = { 0, 0 };
+
+	UPDATELAYEREDWINDOWINFO info = {};
+	info.cbSize = sizeof(info);
+	info.pptDst = &layer.position;
+	info.psize = &layer.size;
+	info.hdcSrc = _memoryDeviceContext;
+	info.pptSrc = &source;
+	info.pblend = &blend;
+	info.dwFlags = ULW_ALPHA;
+
+	ScopedSpan span(SpanUpdateLayeredWindow);
+	layer.uploaded = UpdateLayeredWindowIndirect(layer.hwnd, &info) != FALSE;
+	_stats.uploads += layer.uploaded;
+
+	return true;
+}
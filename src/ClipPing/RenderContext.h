@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <windows.h>
+
+#include "Rasterizer.h"
+
+// Presents the layered windows of the overlay. The memory DC lives as long as the context, and the bitmap
+// of a layer is only uploaded with the first frame after it's bound: the next frames of the animation
+// just change the constant alpha, with a single UpdateLayeredWindowIndirect call per window and no DC.
+class RenderContext
+{
+public:
+	struct Stats
+	{
+		uint64_t frames = 0;
+		uint64_t uploads = 0; // Layers whose bitmap and position were pushed
+		uint64_t lastCycles = 0; // CPU cycles of the calling thread per frame, from QueryThreadCycleTime
+		uint64_t maxCycles = 0;
+		uint64_t totalCycles = 0;
+	};
+
+	RenderContext() = default;
+	~RenderContext();
+
+	RenderContext(const RenderContext&) = delete;
+	RenderContext& operator=(const RenderContext&) = delete;
+
+	// The bitmap must stay alive until the layer is bound again or the context reset. A layer that keeps
+	// its window, bitmap and size isn't uploaded again: moving the window is enough.
+	void Bind(int32_t index, HWND hwnd, HBITMAP bitmap, POINT position, SIZE size);
+	void SetLayerCount(int32_t count);
+
+	// Unbinds every layer and forgets the uploads, e.g. when a bitmap handle may have been recycled
+	void Reset();
+
+	void Present(uint8_t alpha);
+
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	struct Layer
+	{
+		HWND hwnd = nullptr;
+		HBITMAP bitmap = nullptr;
+		POINT position = {};
+		SIZE size = {};
+		bool uploaded = false;
+	};
+
+	static constexpr int MaxLayers = Rasterizer::MaxStrips;
+
+	bool Upload(Layer& layer, const BLENDFUNCTION& blend);
+
+	HDC _memoryDeviceContext = nullptr;
+	HGDIOBJ _defaultBitmap = nullptr;
+	Layer _layers[MaxLayers];
+	int32_t _layerCount = 0;
+	Stats _stats;
+};
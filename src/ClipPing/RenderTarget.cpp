@@ -0,0 +1,37 @@
+// ReSharper disable CppCStyleCast
+#include "RenderTarget.h"
+
+#include <new>
+
+void* MemoryRenderTarget::Allocate(const int32_t width, const int32_t height, Surface& surface)
+{
+	if (width <= 0 || height <= 0)
+	{
+		return nullptr;
+	}
+
+	const size_t bytes = (size_t)width * height * sizeof(uint32_t);
+	const auto memory = (uint8_t*)operator new(Alignment + bytes, std::align_val_t(Alignment), std::nothrow);
+
+	if (!memory)
+	{
+		return nullptr;
+	}
+
+	*(size_t*)memory = bytes;
+	_allocatedBytes += bytes;
+
+	surface = { (uint32_t*)(memory + Alignment), width, height, width };
+	return memory;
+}
+
+void MemoryRenderTarget::Release(void* handle)
+{
+	if (!handle)
+	{
+		return;
+	}
+
+	_allocatedBytes -= *(size_t*)handle;
+	operator delete(handle, std::align_val_t(Alignment));
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Rasterizer.h"
+
+// Allocates the surfaces the overlays are rendered into. The handle owns the pixel memory and is
+// what the presentation layer works with (an HBITMAP for DibRenderTarget).
+class RenderTarget
+{
+public:
+	virtual ~RenderTarget() = default;
+
+	// Returns nullptr on failure, otherwise the surface is width x height with a stride of width
+	virtual void* Allocate(int32_t width, int32_t height, Surface& surface) = 0;
+	virtual void Release(void* handle) = 0;
+};
+
+// Plain memory surfaces, for rendering without a desktop (benchmarks, image dumps)
+class MemoryRenderTarget final : public RenderTarget
+{
+public:
+	void* Allocate(int32_t width, int32_t height, Surface& surface) override;
+	void Release(void* handle) override;
+
+	size_t GetAllocatedBytes() const { return _allocatedBytes; }
+
+private:
+	// Each allocation starts with a header recording its size, the pixels follow on a cache line
+	static constexpr size_t Alignment = 64;
+
+	size_t _allocatedBytes = 0;
+};
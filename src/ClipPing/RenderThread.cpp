@@ -0,0 +1,258 @@
+// ReSharper disable CppCStyleCast
+#include "RenderThread.h"
+
+#include "Overlay.h"
+#include "ProcessMemory.h"
+#include "Rasterizer.h"
+#include "Trace.h"
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+bool RenderThread::Start(const Settings& settings)
+{
+	_settings.store(std::make_shared<const Settings>(settings));
+	return Resume();
+}
+
+bool RenderThread::Resume()
+{
+	if (_thread.joinable())
+	{
+		return true;
+	}
+
+	const auto settings = _settings.load();
+
+	if (!settings)
+	{
+		return false;
+	}
+
+	// PostThreadMessage fails until the thread has a message queue, so wait for it
+	_ready = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+	if (!_ready)
+	{
+		return false;
+	}
+
+	_thread = std::thread(&RenderThread::Run, this, settings);
+	WaitForSingleObject(_ready, INFINITE);
+	CloseHandle(_ready);
+	_ready = nullptr;
+
+	return true;
+}
+
+void RenderThread::Stop()
+{
+	Suspend();
+	_settings.store(nullptr);
+}
+
+void RenderThread::Suspend()
+{
+	if (!_thread.joinable())
+	{
+		return;
+	}
+
+	PostThreadMessage(_threadId, WM_QUIT, 0, 0);
+	Join();
+}
+
+void RenderThread::Join()
+{
+	_thread.join();
+	_stats.surfaceBytes = 0;
+
+	// Commands the thread didn't get to would otherwise run on the next start, as a ping nobody asked for
+	Command command;
+
+	while (_queue.TryPop(command))
+	{
+	}
+}
+
+bool RenderThread::SuspendIfIdle()
+{
+	if (!_thread.joinable())
+	{
+		return true;
+	}
+
+	_idleReply = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+	if (!_idleReply)
+	{
+		return false;
+	}
+
+	// Only this thread posts commands, nothing can be queued behind this one while it waits
+	_idle = false;
+
+	if (Post({ Command::SuspendIfIdle }))
+	{
+		WaitForSingleObject(_idleReply, INFINITE);
+	}
+
+	CloseHandle(_idleReply);
+	_idleReply = nullptr;
+
+	if (!_idle)
+	{
+		return false;
+	}
+
+	// The render thread is already leaving its message loop
+	Join();
+	return true;
+}
+
+void RenderThread::OnClipboardUpdate(const bool sameContent)
+{
+	Post({ sameContent ? Command::SameContentUpdate : Command::ClipboardUpdate });
+}
+
+void RenderThread::Preview()
+{
+	Post({ Command::Preview });
+}
+
+void RenderThread::UpdateSettings(const Settings& settings)
+{
+	// Unlike a command this can't be rejected, and consecutive updates only cost the thread one copy.
+	// A suspended thread starts with the latest settings anyway.
+	_settings.store(std::make_shared<const Settings>(settings));
+
+	if (_thread.joinable())
+	{
+		PostThreadMessage(_threadId, WakeMessage, 0, 0);
+	}
+}
+
+void RenderThread::ReleaseMemory()
+{
+	if (_thread.joinable())
+	{
+		Post({ Command::ReleaseMemory });
+	}
+}
+
+bool RenderThread::Post(Command command)
+{
+	if (!Resume())
+	{
+		return false;
+	}
+
+	command.enqueuedAt = Tracer::Now();
+
+	if (!_queue.TryPush(std::move(command)))
+	{
+		_stats.rejected++;
+		return false;
+	}
+
+	PostThreadMessage(_threadId, WakeMessage, 0, 0);
+	return true;
+}
+
+void RenderThread::RecordHandoff(const int64_t enqueuedAt)
+{
+	const auto now = Tracer::Now();
+	Tracer::Global().Record(SpanHandoff, enqueuedAt, now);
+
+	const auto us = (uint64_t)(now - enqueuedAt) / 1000;
+
+	_stats.commands++;
+	_stats.lastHandoffUs = us;
+	_stats.totalHandoffUs += us;
+
+	if (us > _stats.maxHandoffUs)
+	{
+		_stats.maxHandoffUs = us;
+	}
+}
+
+void RenderThread::Run(std::shared_ptr<const Settings> settings)
+{
+	_threadId = GetCurrentThreadId();
+
+	MSG msg;
+	PeekMessage(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+	SetEvent(_ready);
+
+	// Only this thread creates overlay windows, so the class is registered here rather than at startup
+	WNDCLASS wc = {};
+	wc.lpfnWndProc = Overlay::WndProc;
+	wc.hInstance = GetModuleHandle(nullptr);
+	wc.lpszClassName = L"ClipPingOverlay";
+	RegisterClass(&wc);
+
+	// The overlay reads the current snapshot through this copy, which only this thread touches
+	Settings current = *settings;
+	Overlay overlay(current);
+	auto applied = std::move(settings);
+
+	while (GetMessage(&msg, nullptr, 0, 0) > 0)
+	{
+		if (msg.hwnd == nullptr && msg.message == WakeMessage)
+		{
+			// Before the commands, which were posted after the settings they expect
+			if (auto latest = _settings.load(); latest != applied)
+			{
+				current = *latest;
+				applied = std::move(latest);
+			}
+
+			Command command;
+
+			while (_queue.TryPop(command))
+			{
+				RecordHandoff(command.enqueuedAt);
+
+				switch (command.type)
+				{
+				case Command::ClipboardUpdate:
+				case Command::SameContentUpdate:
+					overlay.OnClipboardUpdate(command.enqueuedAt, command.type == Command::SameContentUpdate);
+					break;
+				case Command::Preview:
+					overlay.Show();
+					break;
+				case Command::ReleaseMemory:
+					if (overlay.ReleaseMemory())
+					{
+						Rasterizer::ReleaseCaches();
+						ProcessMemory::TrimWorkingSet();
+					}
+
+					break;
+				case Command::SuspendIfIdle:
+					_idle = overlay.ReleaseMemory();
+
+					// The listener joins as soon as it has the reply, the overlay is destroyed on the way out
+					if (_idle)
+					{
+						PostQuitMessage(0);
+					}
+
+					SetEvent(_idleReply);
+					break;
+				}
+			}
+		}
+		else
+		{
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+		}
+
+		// Surfaces are rendered by the commands and by the frames that follow the foreground window
+		_stats.surfaceBytes.store(overlay.GetSurfaceBytes(), std::memory_order_relaxed);
+	}
+}
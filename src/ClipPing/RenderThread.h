@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <windows.h>
+
+#include "Settings.h"
+#include "SpscQueue.h"
+
+// Runs the overlay (surface creation, rasterization, UpdateLayeredWindow and the animation) on its own thread
+// with its own message loop, so the listener thread and its modal dialogs never wait on rendering.
+// Commands are handed over through a lock-free queue, all methods must be called from the listener thread.
+// The settings aren't a command: the latest snapshot is published and read by the thread when it wakes up.
+// The thread can be suspended to free its memory while idle, the next command starts it again.
+class RenderThread
+{
+public:
+	struct Stats
+	{
+		std::atomic<uint64_t> commands = 0;
+		std::atomic<uint64_t> rejected = 0; // Queue full
+		std::atomic<uint64_t> lastHandoffUs = 0;
+		std::atomic<uint64_t> maxHandoffUs = 0;
+		std::atomic<uint64_t> totalHandoffUs = 0;
+		std::atomic<uint64_t> surfaceBytes = 0; // Surface cache and templates, published by the render thread
+	};
+
+	RenderThread() = default;
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	bool Start(const Settings& settings);
+	void Stop();
+
+	// Ends the thread, with the overlay, its windows and its surfaces
+	void Suspend();
+
+	// Suspends the thread unless a ping is on screen, which only the render thread can tell after the
+	// commands already queued. Returns true if the thread isn't running anymore.
+	bool SuspendIfIdle();
+	bool IsRunning() const { return _thread.joinable(); }
+
+	// Frees the surfaces and the overlay windows and trims the working set, unless a ping is on screen
+	void ReleaseMemory();
+
+	// 'sameContent' makes a fainter ping, for updates that rewrote the content the clipboard already had
+	void OnClipboardUpdate(bool sameContent = false);
+	void Preview();
+
+	// Publishes a copy of the settings, the overlay never reads the listener's instance
+	void UpdateSettings(const Settings& settings);
+
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	struct Command
+	{
+		enum Type : uint8_t { ClipboardUpdate, SameContentUpdate, Preview, ReleaseMemory, SuspendIfIdle };
+
+		Type type = ClipboardUpdate;
+		int64_t enqueuedAt = 0; // Tracer::Now() timestamp
+	};
+
+	static constexpr UINT WakeMessage = WM_APP + 1;
+
+	bool Resume();
+	void Join();
+	bool Post(Command command);
+	void Run(std::shared_ptr<const Settings> settings);
+	void RecordHandoff(int64_t enqueuedAt);
+
+	std::atomic<std::shared_ptr<const Settings>> _settings; // Latest snapshot, also the one to resume with
+	SpscQueue<Command, 64> _queue;
+	std::thread _thread;
+	DWORD _threadId = 0;
+	HANDLE _ready = nullptr;
+	HANDLE _idleReply = nullptr; // Set by the render thread once it has handled SuspendIfIdle
+	bool _idle = false;
+	Stats _stats;
+};
@@ -3,7 +3,7 @@
 
 #include <format>
 
-#include "Overlay.h"
+#include "RenderThread.h"
 #include "resource.h"
 
 #include <shlobj.h>
@@ -14,6 +14,57 @@
 static const wchar_t* const kRunKey = L"Software\\Microsoft\\Windows\\CurrentVersion\\Run";
 static const wchar_t* const kValueName = L"ClipPing";
 
+static std::wstring FromUtf8(const std::string& text)
+{
+	const auto length = text.empty() ? 0 : MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), nullptr, 0);
+
+	if (length <= 0)
+	{
+		return {};
+	}
+
+	std::wstring result((size_t)length, L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, text.data(), (int)text.size(), result.data(), length);
+	return result;
+}
+
+// Writes to the Run registry key and to the INI model, which is saved in one go on Flush
+class Settings::Backend final : public PersistenceBackend
+{
+public:
+	explicit Backend(Settings& settings) : _settings(settings) {}
+
+	bool ReadAutoStart() override { return GetAutoStart(); }
+	void WriteAutoStart(const bool enable) override { SetAutoStart(enable); }
+
+	void WriteOverlayColor(const uint32_t color) override
+	{
+		const auto colorStr = std::format("{:02X}{:02X}{:02X}", GetRValue(color), GetGValue(color), GetBValue(color));
+		_settings._ini.SetString("Overlay", "Color", colorStr);
+	}
+
+	void WriteOverlayType(const OverlayType type) override
+	{
+		_settings._ini.SetInt("Overlay", "Type", type);
+	}
+
+	void WriteOverlayStyle(const std::string_view style) override
+	{
+		_settings._ini.SetString("Overlay", "Style", style);
+	}
+
+	void Flush() override
+	{
+		if (!_settings._iniPath.empty() && _settings._ini.IsDirty())
+		{
+			_settings._ini.Write(_settings._iniPath);
+		}
+	}
+
+private:
+	Settings& _settings;
+};
+
 bool Settings::GetAutoStart()
 {
 	HKEY hKey = nullptr;
@@ -105,8 +156,19 @@ void Settings::EnsureIniPath()
 	}
 }
 
+std::wstring Settings::GetIniDirectory() const
+{
+	const auto separator = _iniPath.find_last_of(L'\\');
+	return separator == std::wstring::npos ? std::wstring() : _iniPath.substr(0, separator);
+}
+
 void Settings::Load()
 {
+	if (!_persistence)
+	{
+		_persistence = std::make_shared<SettingsPersistence>(std::make_unique<Backend>(*this));
+	}
+
 	EnsureIniPath();
 
 	if (_iniPath.empty())
@@ -114,42 +176,149 @@ void Settings::Load()
 		return;
 	}
 
-	isFirstLaunch = GetFileAttributes(_iniPath.c_str()) == INVALID_FILE_ATTRIBUTES;
+	std::error_code error;
+	_iniWriteTime = std::filesystem::last_write_time(_iniPath, error);
+
+	isFirstLaunch = !_ini.Read(_iniPath);
+	ReadStyles();
+	Apply();
+}
+
+bool Settings::Reload()
+{
+	// The dialog owns the settings while it's open, and saves them when it closes
+	if (_iniPath.empty() || _dialogHwnd)
+	{
+		return false;
+	}
+
+	// The whole directory is watched, writes to the history log land here too
+	bool changed = ReadStyles();
+
+	std::error_code error;
+	const auto writeTime = std::filesystem::last_write_time(_iniPath, error);
+
+	if (!error && writeTime != _iniWriteTime)
+	{
+		_iniWriteTime = writeTime;
+		IniFile ini;
+
+		// Also filters out the notifications caused by our own writes
+		if (ini.Read(_iniPath) && ini.Serialize() != _ini.Serialize())
+		{
+			_ini = std::move(ini);
+			changed = true;
+		}
+	}
 
-	std::wstring colorBuf(16, L'\0');
-	GetPrivateProfileString(L"Overlay", L"Color", L"FF0000", colorBuf.data(), (DWORD)colorBuf.size(), _iniPath.c_str());
+	if (changed)
+	{
+		Apply();
+	}
+
+	return changed;
+}
+
+bool Settings::ReadStyles()
+{
+	// A missing file has the minimum write time, so deleting it is a change too
+	std::error_code error;
+	const auto path = GetIniDirectory() + L"\\Styles.ini";
+	const auto writeTime = std::filesystem::last_write_time(path, error);
+
+	if (writeTime == _stylesWriteTime)
+	{
+		return false;
+	}
+
+	_stylesWriteTime = writeTime;
+	_styles = IniFile();
+	_styles.Read(path);
+	_stylesChanged = true;
+	return true;
+}
+
+void Settings::Apply()
+{
 	try
 	{
-		const auto hex = std::stoul(colorBuf, nullptr, 16);
+		const auto hex = std::stoul(_ini.GetString("Overlay", "Color", "FF0000"), nullptr, 16);
 		overlayColor = RGB((hex >> 16) & 0xFF, (hex >> 8) & 0xFF, hex & 0xFF);
 	}
 	catch (...) {}
 
-	const auto type = GetPrivateProfileInt(L"Overlay", L"Type", 0, _iniPath.c_str());
-	
+	const auto type = (uint32_t)_ini.GetInt("Overlay", "Type", 0);
+
 	if (type < OverlayMax)
 	{
 		overlayType = (OverlayType)type;
 	}
-}
 
-void Settings::Save()
-{
-	EnsureIniPath();
+	// The style is only compiled again when it's another one or the file changed
+	if (auto style = _ini.GetString("Overlay", "Style", ""); style != overlayStyle || _stylesChanged)
+	{
+		overlayStyle = std::move(style);
+		customStyle = OverlayStyle::Compile(_styles, overlayStyle);
+		_stylesChanged = false;
+	}
 
-	if (_iniPath.empty())
+	cacheBudgetMb = (uint32_t)_ini.GetInt("Overlay", "CacheBudgetMB", 64);
+	edgeStrips = _ini.GetInt("Overlay", "EdgeStrips", 1) != 0;
+	vsyncPacing = _ini.GetInt("Overlay", "VsyncPacing", 1) != 0;
+
+	const auto retrigger = (uint32_t)_ini.GetInt("Overlay", "Retrigger", RetriggerIgnore);
+
+	if (retrigger < RetriggerMax)
 	{
-		return;
+		retriggerPolicy = (RetriggerPolicy)retrigger;
 	}
 
-	const auto colorStr = std::format(L"{:02X}{:02X}{:02X}", GetRValue(overlayColor), GetGValue(overlayColor), GetBValue(overlayColor));
-	WritePrivateProfileString(L"Overlay", L"Color", colorStr.c_str(), _iniPath.c_str());
+	coalesceMs = (uint32_t)_ini.GetInt("Overlay", "CoalesceMs", 50);
+	extendHoldMs = (uint32_t)_ini.GetInt("Overlay", "ExtendHoldMs", 200);
+
+	const auto dedup = (uint32_t)_ini.GetInt("Overlay", "Dedup", DedupOff);
 
-	const auto typeStr = std::to_wstring(overlayType);
-	WritePrivateProfileString(L"Overlay", L"Type", typeStr.c_str(), _iniPath.c_str());
+	if (dedup < DedupMax)
+	{
+		dedupMode = (DedupMode)dedup;
+	}
+
+	dedupMaxKb = (uint32_t)_ini.GetInt("Overlay", "DedupMaxKB", 1024);
+	historyMb = (uint32_t)_ini.GetInt("History", "HistoryMB", 0);
+
+	const auto quiet = (uint32_t)_ini.GetInt("Overlay", "Quiet", QuietTrayFlash);
+
+	if (quiet < QuietMax)
+	{
+		quietMode = (QuietMode)quiet;
+	}
+
+	quietProcesses = FromUtf8(_ini.GetString("Overlay", "QuietProcesses", ""));
+
+	const auto power = (uint32_t)_ini.GetInt("Overlay", "Power", PowerAuto);
+
+	if (power < PowerMax)
+	{
+		powerMode = (PowerMode)power;
+	}
+
+	idleReleaseSec = (uint32_t)_ini.GetInt("Memory", "IdleReleaseSec", 60);
+	idleStopRenderer = _ini.GetInt("Memory", "IdleStopRenderer", 0) != 0;
+	revision++;
 }
 
-bool Settings::ShowDialog(HWND parent, HINSTANCE instance, Overlay& overlay)
+PersistedState Settings::GetPersistedState(const bool autoStart) const
+{
+	return { overlayColor, overlayType, overlayStyle, autoStart };
+}
+
+void Settings::Commit(const bool autoStart)
+{
+	// Closing the dialog without changes doesn't touch the file or the registry
+	_persistence->Commit(GetPersistedState(autoStart));
+}
+
+bool Settings::ShowDialog(HWND parent, HINSTANCE instance, RenderThread& renderer)
 {
 	if (_dialogHwnd)
 	{
@@ -158,7 +327,8 @@ bool Settings::ShowDialog(HWND parent, HINSTANCE instance, Overlay& overlay)
 	}
 
 	_dlgColor = overlayColor;
-	DlgContext ctx(this, &overlay);
+	_dlgStyle = customStyle;
+	DlgContext ctx(this, &renderer);
 	return DialogBoxParam(instance, MAKEINTRESOURCE(IDD_SETTINGS), parent, DlgProc, (LPARAM)&ctx) == IDOK;
 }
 
@@ -174,9 +344,12 @@ INT_PTR CALLBACK Settings::DlgProc(HWND dialog, UINT msg, WPARAM wParam, LPARAM
 		SetWindowLongPtr(dialog, DWLP_USER, lParam);
 		ctx->settings->_dialogHwnd = dialog;
 
-		CheckDlgButton(dialog, IDC_CHK_AUTOSTART,
-			(ctx->settings->isFirstLaunch || GetAutoStart()) ? BST_CHECKED : BST_UNCHECKED);
-		ctx->settings->isFirstLaunch = false;
+		const auto settings = ctx->settings;
+		const bool autoStart = settings->_persistence->GetAutoStart();
+		settings->_persistence->Begin(settings->GetPersistedState(autoStart), !settings->isFirstLaunch);
+
+		CheckDlgButton(dialog, IDC_CHK_AUTOSTART, (settings->isFirstLaunch || autoStart) ? BST_CHECKED : BST_UNCHECKED);
+		settings->isFirstLaunch = false;
 
 		const auto hCombo = GetDlgItem(dialog, IDC_CMB_OVERLAY);
 		SendMessage(hCombo, CB_ADDSTRING, 0, (LPARAM)L"Top");
@@ -185,7 +358,14 @@ INT_PTR CALLBACK Settings::DlgProc(HWND dialog, UINT msg, WPARAM wParam, LPARAM
 		SendMessage(hCombo, CB_ADDSTRING, 0, (LPARAM)L"Bottom");
 		SendMessage(hCombo, CB_ADDSTRING, 0, (LPARAM)L"Left");
 		SendMessage(hCombo, CB_ADDSTRING, 0, (LPARAM)L"Right");
-		SendMessage(hCombo, CB_SETCURSEL, (WPARAM)ctx->settings->overlayType, 0);
+
+		// The custom style from Styles.ini comes last, so that it can be picked again after trying the others
+		if (settings->_dlgStyle)
+		{
+			SendMessage(hCombo, CB_ADDSTRING, 0, (LPARAM)FromUtf8(settings->_dlgStyle->GetName()).c_str());
+		}
+
+		SendMessage(hCombo, CB_SETCURSEL, settings->customStyle ? (WPARAM)OverlayMax : (WPARAM)settings->overlayType, 0);
 
 		return TRUE;
 	}
@@ -239,8 +419,10 @@ INT_PTR CALLBACK Settings::DlgProc(HWND dialog, UINT msg, WPARAM wParam, LPARAM
 			{
 				ctx->settings->_dlgColor = cc.rgbResult;
 				ctx->settings->overlayColor = cc.rgbResult;
+				ctx->settings->revision++;
 				InvalidateRect(GetDlgItem(dialog, IDC_COLOR_PREVIEW), nullptr, TRUE);
-				ctx->overlay->Show();
+				ctx->renderer->UpdateSettings(*ctx->settings);
+				ctx->renderer->Preview();
 			}
 
 			return TRUE;
@@ -250,8 +432,25 @@ INT_PTR CALLBACK Settings::DlgProc(HWND dialog, UINT msg, WPARAM wParam, LPARAM
 		{
 			if (HIWORD(wParam) == CBN_SELCHANGE)
 			{
-				ctx->settings->overlayType = (OverlayType)SendMessage((HWND)lParam, CB_GETCURSEL, 0, 0);
-				ctx->overlay->Show();
+				const auto settings = ctx->settings;
+				const auto selection = (uint32_t)SendMessage((HWND)lParam, CB_GETCURSEL, 0, 0);
+
+				// The custom style replaces the type, picking a built-in one has to clear it
+				if (selection < OverlayMax)
+				{
+					settings->overlayType = (OverlayType)selection;
+					settings->overlayStyle.clear();
+					settings->customStyle = nullptr;
+				}
+				else if (selection == OverlayMax && settings->_dlgStyle)
+				{
+					settings->overlayStyle = settings->_dlgStyle->GetName();
+					settings->customStyle = settings->_dlgStyle;
+				}
+
+				settings->revision++;
+				ctx->renderer->UpdateSettings(*ctx->settings);
+				ctx->renderer->Preview();
 				return TRUE;
 			}
 			break;
@@ -259,24 +458,20 @@ INT_PTR CALLBACK Settings::DlgProc(HWND dialog, UINT msg, WPARAM wParam, LPARAM
 
 		case IDC_BTN_PREVIEW:
 		{
-			ctx->overlay->Show();
+			ctx->renderer->Preview();
 			return TRUE;
 		}
 
 		case IDOK:
 		{
-			const bool autoStart = IsDlgButtonChecked(dialog, IDC_CHK_AUTOSTART) == BST_CHECKED;
-			SetAutoStart(autoStart);
-			ctx->settings->Save();
+			ctx->settings->Commit(IsDlgButtonChecked(dialog, IDC_CHK_AUTOSTART) == BST_CHECKED);
 			EndDialog(dialog, IDOK);
 			return TRUE;
 		}
 
 		case IDC_BTN_EXIT:
 		{
-			const bool autoStart = IsDlgButtonChecked(dialog, IDC_CHK_AUTOSTART) == BST_CHECKED;
-			SetAutoStart(autoStart);
-			ctx->settings->Save();
+			ctx->settings->Commit(IsDlgButtonChecked(dialog, IDC_CHK_AUTOSTART) == BST_CHECKED);
 			const auto parent = GetParent(dialog);
 			EndDialog(dialog, IDOK);
 			PostMessage(parent, WM_COMMAND, IDM_EXIT, 0);
@@ -285,9 +480,7 @@ INT_PTR CALLBACK Settings::DlgProc(HWND dialog, UINT msg, WPARAM wParam, LPARAM
 
 		case IDCANCEL:
 		{
-			const bool autoStart = IsDlgButtonChecked(dialog, IDC_CHK_AUTOSTART) == BST_CHECKED;
-			SetAutoStart(autoStart);
-			ctx->settings->Save();
+			ctx->settings->Commit(IsDlgButtonChecked(dialog, IDC_CHK_AUTOSTART) == BST_CHECKED);
 			EndDialog(dialog, IDOK);
 			return TRUE;
 		}
@@ -2,27 +2,34 @@
 
 #include <windows.h>
 #include <cstdint>
+#include <filesystem>
+#include <memory>
 #include <string>
 
-class Overlay;
+#include "ClipboardDedup.h"
+#include "IniFile.h"
+#include "OverlayPolicy.h"
+#include "OverlayStyle.h"
+#include "OverlayType.h"
+#include "PingScheduler.h"
+#include "PowerPolicy.h"
+#include "SettingsPersistence.h"
 
-enum OverlayType : int32_t
-{
-	OverlayTop = 0,
-	OverlayBorder = 1,
-	OverlayAura = 2,
-	OverlayBottom = 3,
-	OverlayLeft = 4,
-	OverlayRight = 5,
-	OverlayMax
-};
+class RenderThread;
 
 class Settings
 {
 public:
 	void Load();
-	void Save();
-	bool ShowDialog(HWND parent, HINSTANCE instance, Overlay& overlay);
+
+	// Re-reads the file after an external edit. Returns true if the settings changed.
+	bool Reload();
+
+	// The directory holding the settings file, empty if it couldn't be determined
+	std::wstring GetIniDirectory() const;
+	bool ShowDialog(HWND parent, HINSTANCE instance, RenderThread& renderer);
+
+	const SettingsPersistence::Stats& GetPersistenceStats() const { return _persistence->GetStats(); }
 
 	static bool GetAutoStart();
 	static void SetAutoStart(bool enable);
@@ -30,20 +37,56 @@ public:
 	bool isFirstLaunch = false;
 	COLORREF overlayColor = RGB(255, 0, 0);
 	OverlayType overlayType = OverlayTop;
+	std::string overlayStyle; // Section of Styles.ini, replaces the type when it's a valid style
+	std::shared_ptr<const OverlayStyle> customStyle; // Compiled once, shared with the copies on the render thread
+	uint32_t cacheBudgetMb = 64;
+	bool edgeStrips = true;
+	bool vsyncPacing = true;
+	RetriggerPolicy retriggerPolicy = RetriggerIgnore;
+	uint32_t coalesceMs = 50;
+	uint32_t extendHoldMs = 200;
+	DedupMode dedupMode = DedupOff;
+	uint32_t dedupMaxKb = 1024;
+	uint32_t historyMb = 0; // 0 disables the clipboard history
+	QuietMode quietMode = QuietTrayFlash; // Over fullscreen windows and the listed processes
+	std::wstring quietProcesses;
+	PowerMode powerMode = PowerAuto;
+	uint32_t idleReleaseSec = 60; // Frees the surfaces after that long without a ping, 0 never does
+	bool idleStopRenderer = false; // Also ends the render thread
+
+	// Incremented whenever a setting changes, so that state derived from the settings can be invalidated
+	uint32_t revision = 1;
 
 private:
+	class Backend;
+
 	struct DlgContext
 	{
 		Settings* settings;
-		Overlay* overlay;
+		RenderThread* renderer;
 
-		DlgContext(Settings* s, Overlay* o) : settings(s), overlay(o) {}
+		DlgContext(Settings* s, RenderThread* r) : settings(s), renderer(r) {}
 	};
 
 	static INT_PTR CALLBACK DlgProc(HWND dialog, UINT msg, WPARAM wParam, LPARAM lParam);
 	void EnsureIniPath();
 
+	// Returns true if Styles.ini changed since it was last read
+	bool ReadStyles();
+	void Apply();
+	PersistedState GetPersistedState(bool autoStart) const;
+	void Commit(bool autoStart);
+
 	COLORREF _dlgColor = 0;
+	std::shared_ptr<const OverlayStyle> _dlgStyle;
 	HWND _dialogHwnd = nullptr;
 	std::wstring _iniPath;
+	std::filesystem::file_time_type _iniWriteTime;
+	IniFile _ini;
+	IniFile _styles;
+	std::filesystem::file_time_type _stylesWriteTime;
+	bool _stylesChanged = false;
+
+	// Shared with the copies sent to the render thread, which never persist anything
+	std::shared_ptr<SettingsPersistence> _persistence;
 };
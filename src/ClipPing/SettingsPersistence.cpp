@@ -0,0 +1,69 @@
+// ReSharper disable CppCStyleCast
+#include "SettingsPersistence.h"
+
+SettingsPersistence::SettingsPersistence(std::unique_ptr<PersistenceBackend> backend)
+	: _backend(std::move(backend))
+{
+}
+
+bool SettingsPersistence::GetAutoStart()
+{
+	if (!_autoStartKnown)
+	{
+		_autoStart = _backend->ReadAutoStart();
+		_autoStartKnown = true;
+		_stats.autoStartReads++;
+	}
+
+	return _autoStart;
+}
+
+void SettingsPersistence::Begin(const PersistedState& state, const bool stored)
+{
+	_snapshot = state;
+	_stored = stored;
+}
+
+int32_t SettingsPersistence::Commit(const PersistedState& state)
+{
+	int32_t writes = 0;
+
+	if (!_stored || state.overlayColor != _snapshot.overlayColor)
+	{
+		_backend->WriteOverlayColor(state.overlayColor);
+		writes++;
+	}
+
+	if (!_stored || state.overlayType != _snapshot.overlayType)
+	{
+		_backend->WriteOverlayType(state.overlayType);
+		writes++;
+	}
+
+	if (!_stored || state.overlayStyle != _snapshot.overlayStyle)
+	{
+		_backend->WriteOverlayStyle(state.overlayStyle);
+		writes++;
+	}
+
+	if (!_stored || state.autoStart != _snapshot.autoStart)
+	{
+		_backend->WriteAutoStart(state.autoStart);
+		_autoStart = state.autoStart;
+		_autoStartKnown = true;
+		writes++;
+	}
+
+	if (writes > 0)
+	{
+		_backend->Flush();
+	}
+
+	_stats.commits++;
+	_stats.writes += writes;
+	_stats.skippedWrites += FieldCount - writes;
+
+	_snapshot = state;
+	_stored = true;
+	return writes;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "OverlayType.h"
+
+// The part of the settings written back when the settings dialog closes
+struct PersistedState
+{
+	uint32_t overlayColor = 0;
+	OverlayType overlayType = OverlayTop;
+	std::string overlayStyle;
+	bool autoStart = false;
+
+	bool operator==(const PersistedState&) const = default;
+};
+
+// Where the persisted state lives: the INI file and the Run registry key on Windows
+class PersistenceBackend
+{
+public:
+	virtual ~PersistenceBackend() = default;
+
+	virtual bool ReadAutoStart() = 0;
+	virtual void WriteAutoStart(bool enable) = 0;
+	virtual void WriteOverlayColor(uint32_t color) = 0;
+	virtual void WriteOverlayType(OverlayType type) = 0;
+	virtual void WriteOverlayStyle(std::string_view style) = 0;
+
+	// Called once after the writes of a commit, if there were any
+	virtual void Flush() = 0;
+};
+
+// Snapshots the persisted state when the settings dialog opens and, when it closes, only writes the
+// fields that differ. The auto-start state is read from the backend once, then tracked in memory.
+class SettingsPersistence
+{
+public:
+	struct Stats
+	{
+		uint64_t commits = 0;
+		uint64_t writes = 0;
+		uint64_t skippedWrites = 0;
+		uint64_t autoStartReads = 0;
+	};
+
+	explicit SettingsPersistence(std::unique_ptr<PersistenceBackend> backend);
+
+	bool GetAutoStart();
+
+	// 'stored' is false when nothing has been persisted yet, then the next commit writes every field
+	void Begin(const PersistedState& state, bool stored);
+
+	// Returns the number of fields written
+	int32_t Commit(const PersistedState& state);
+
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	static constexpr int32_t FieldCount = 4;
+
+	std::unique_ptr<PersistenceBackend> _backend;
+	PersistedState _snapshot;
+	bool _stored = false;
+	bool _autoStartKnown = false;
+	bool _autoStart = false;
+	Stats _stats;
+};
@@ -0,0 +1,91 @@
+// ReSharper disable CppCStyleCast
+#include "SettingsWatcher.h"
+
+SettingsWatcher::~SettingsWatcher()
+{
+	Stop();
+}
+
+bool SettingsWatcher::Start(const std::wstring& directory, HWND target, UINT message)
+{
+	if (_thread.joinable() || directory.empty())
+	{
+		return false;
+	}
+
+	_notification = FindFirstChangeNotification(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+
+	if (_notification == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+
+	if (!_stopEvent)
+	{
+		FindCloseChangeNotification(_notification);
+		_notification = INVALID_HANDLE_VALUE;
+		return false;
+	}
+
+	_target = target;
+	_message = message;
+	_thread = std::thread(&SettingsWatcher::Run, this);
+	return true;
+}
+
+void SettingsWatcher::Stop()
+{
+	if (_thread.joinable())
+	{
+		SetEvent(_stopEvent);
+		_thread.join();
+	}
+
+	if (_notification != INVALID_HANDLE_VALUE)
+	{
+		FindCloseChangeNotification(_notification);
+		_notification = INVALID_HANDLE_VALUE;
+	}
+
+	if (_stopEvent)
+	{
+		CloseHandle(_stopEvent);
+		_stopEvent = nullptr;
+	}
+}
+
+void SettingsWatcher::Run()
+{
+	const HANDLE handles[] = { _stopEvent, _notification };
+	bool changed = false;
+
+	while (true)
+	{
+		const auto result = WaitForMultipleObjects(2, handles, FALSE, changed ? SettleMs : INFINITE);
+
+		if (result == WAIT_OBJECT_0 + 1)
+		{
+			changed = true;
+
+			if (!FindNextChangeNotification(_notification))
+			{
+				return;
+			}
+		}
+		else if (result == WAIT_TIMEOUT)
+		{
+			changed = false;
+
+			if (!_pending.exchange(true))
+			{
+				PostMessage(_target, _message, 0, 0);
+			}
+		}
+		else
+		{
+			return;
+		}
+	}
+}
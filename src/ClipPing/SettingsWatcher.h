@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <windows.h>
+
+// Watches the settings directory for external edits. A worker thread waits on a change notification
+// and posts a message to the target window once writes have settled.
+class SettingsWatcher
+{
+public:
+	SettingsWatcher() = default;
+	~SettingsWatcher();
+
+	SettingsWatcher(const SettingsWatcher&) = delete;
+	SettingsWatcher& operator=(const SettingsWatcher&) = delete;
+
+	bool Start(const std::wstring& directory, HWND target, UINT message);
+	void Stop();
+
+	// Called when the message is handled. Changes are coalesced while one is pending.
+	void ChangeHandled() { _pending = false; }
+
+private:
+	void Run();
+
+	// Editors often save in several steps, so the message waits for this long without changes
+	static constexpr DWORD SettleMs = 100;
+
+	HANDLE _notification = INVALID_HANDLE_VALUE;
+	HANDLE _stopEvent = nullptr;
+	HWND _target = nullptr;
+	UINT _message = 0;
+	std::thread _thread;
+	std::atomic<bool> _pending = false;
+};
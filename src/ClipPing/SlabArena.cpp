@@ -0,0 +1,159 @@
+// ReSharper disable CppCStyleCast
+#include "SlabArena.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+
+int32_t SlabArena::GetClass(const size_t size)
+{
+	if (size > PageSize)
+	{
+		return -1;
+	}
+
+	const auto rounded = std::bit_ceil(std::max(size, MinBlockSize));
+	return std::countr_zero(rounded) - std::countr_zero(MinBlockSize);
+}
+
+size_t SlabArena::GetCost(const size_t size) const
+{
+	const auto sizeClass = GetClass(size);
+
+	if (sizeClass < 0)
+	{
+		return size;
+	}
+
+	return _partialPages[sizeClass].empty() ? PageSize : 0;
+}
+
+SlabArena::Block SlabArena::Allocate(const size_t size)
+{
+	const auto sizeClass = GetClass(size);
+
+	if (sizeClass < 0)
+	{
+		const auto data = new (std::nothrow) uint8_t[size];
+
+		if (!data)
+		{
+			return {};
+		}
+
+		_footprint += size;
+		return { data, (uint32_t)size, LargePage };
+	}
+
+	auto& partial = _partialPages[sizeClass];
+
+	if (partial.empty())
+	{
+		uint32_t index;
+
+		if (!_releasedPages.empty())
+		{
+			index = _releasedPages.back();
+			_releasedPages.pop_back();
+		}
+		else
+		{
+			index = (uint32_t)_pages.size();
+			_pages.emplace_back();
+		}
+
+		auto& page = _pages[index];
+		page.memory.reset(new (std::nothrow) uint8_t[PageSize]);
+
+		if (!page.memory)
+		{
+			_releasedPages.push_back(index);
+			return {};
+		}
+
+		page.blockSize = (uint32_t)(MinBlockSize << sizeClass);
+		page.used = 0;
+		page.freeSlot = NoSlot;
+		page.untouched = 0;
+		page.sizeClass = sizeClass;
+
+		_footprint += PageSize;
+		partial.push_back(index);
+	}
+
+	const auto index = partial.back();
+	auto& page = _pages[index];
+	uint32_t slot;
+
+	if (page.freeSlot != NoSlot)
+	{
+		slot = page.freeSlot;
+		memcpy(&page.freeSlot, page.memory.get() + (size_t)slot * page.blockSize, sizeof(uint32_t));
+	}
+	else
+	{
+		slot = page.untouched++;
+	}
+
+	page.used++;
+
+	if (page.used == PageSize / page.blockSize)
+	{
+		partial.pop_back();
+	}
+
+	return { page.memory.get() + (size_t)slot * page.blockSize, page.blockSize, index };
+}
+
+void SlabArena::Free(const Block& block)
+{
+	if (!block.data)
+	{
+		return;
+	}
+
+	if (block.page == LargePage)
+	{
+		delete[] block.data;
+		_footprint -= block.size;
+		return;
+	}
+
+	auto& page = _pages[block.page];
+	const auto slot = (uint32_t)((block.data - page.memory.get()) / page.blockSize);
+	const bool wasFull = page.used == PageSize / page.blockSize;
+
+	memcpy(block.data, &page.freeSlot, sizeof(uint32_t));
+	page.freeSlot = slot;
+	page.used--;
+
+	if (page.used == 0)
+	{
+		ReleasePage(block.page);
+	}
+	else if (wasFull)
+	{
+		_partialPages[page.sizeClass].push_back(block.page);
+	}
+}
+
+void SlabArena::ReleasePage(const uint32_t index)
+{
+	auto& page = _pages[index];
+	auto& partial = _partialPages[page.sizeClass];
+
+	// A page with a single slot goes straight from full to empty and was never listed
+	const auto it = std::find(partial.begin(), partial.end(), index);
+
+	if (it != partial.end())
+	{
+		*it = partial.back();
+		partial.pop_back();
+	}
+
+	page.memory.reset();
+	page.sizeClass = -1;
+	_footprint -= PageSize;
+	_releasedPages.push_back(index);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Size-class allocator for variable-sized payloads. Small blocks are carved from 64 KB pages dedicated
+// to one power-of-two class, larger ones get their own allocation. A page is released as soon as its
+// last block is freed, so the footprint follows the live data instead of the peak.
+class SlabArena
+{
+public:
+	struct Block
+	{
+		uint8_t* data = nullptr;
+		uint32_t size = 0; // Capacity, rounded up to the class size
+		uint32_t page = 0; // LargePage for blocks with their own allocation
+	};
+
+	// Blocks must be freed before the arena is destroyed, large ones aren't tracked by the arena
+	SlabArena() = default;
+
+	SlabArena(const SlabArena&) = delete;
+	SlabArena& operator=(const SlabArena&) = delete;
+
+	// Returns a block with a null pointer on failure
+	Block Allocate(size_t size);
+	void Free(const Block& block);
+
+	// Memory held by the arena, including the free space of partially used pages
+	size_t GetFootprint() const { return _footprint; }
+
+	// What Allocate(size) would add to the footprint
+	size_t GetCost(size_t size) const;
+
+	static constexpr size_t PageSize = 64 * 1024;
+	static constexpr size_t MinBlockSize = 64;
+
+private:
+	static constexpr uint32_t LargePage = UINT32_MAX;
+	static constexpr uint32_t NoSlot = UINT32_MAX;
+	static constexpr int ClassCount = 11; // 64 B to 64 KB
+
+	struct Page
+	{
+		std::unique_ptr<uint8_t[]> memory;
+		uint32_t blockSize = 0;
+		uint32_t used = 0;
+		uint32_t freeSlot = NoSlot; // Free slots are linked through their first 4 bytes
+		uint32_t untouched = 0; // Slots past this one have never been allocated
+		int32_t sizeClass = -1;
+	};
+
+	static int32_t GetClass(size_t size);
+	void ReleasePage(uint32_t index);
+
+	std::vector<Page> _pages;
+	std::vector<uint32_t> _releasedPages; // Entries of _pages that can be reused
+	std::vector<uint32_t> _partialPages[ClassCount]; // Pages with at least one free slot
+	size_t _footprint = 0;
+};
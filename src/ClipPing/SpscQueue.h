@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	// Producer side, returns false if the queue is full
+	bool TryPush(T value)
+	{
+		const auto tail = _tail.load(std::memory_order_relaxed);
+
+		if (tail - _head.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+
+		_items[tail & (Capacity - 1)] = std::move(value);
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side, returns false if the queue is empty
+	bool TryPop(T& value)
+	{
+		const auto head = _head.load(std::memory_order_relaxed);
+
+		if (head == _tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		value = std::move(_items[head & (Capacity - 1)]);
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	// Each index on its own cache line, so the two threads don't invalidate each other's line
+	alignas(64) std::atomic<size_t> _head = 0;
+	alignas(64) std::atomic<size_t> _tail = 0;
+	T _items[Capacity];
+};
@@ -0,0 +1,87 @@
+// ReSharper disable CppCStyleCast
+#include "SurfaceCache.h"
+
+SurfaceCache::SurfaceCache(const size_t budgetBytes, RenderTarget& target)
+	: _budget(budgetBytes), _target(target)
+{
+}
+
+SurfaceCache::~SurfaceCache()
+{
+	Clear();
+}
+
+const SurfaceCache::Entry* SurfaceCache::Find(const SurfaceKey& key)
+{
+	for (auto it = _entries.begin(); it != _entries.end(); ++it)
+	{
+		if (it->key == key)
+		{
+			_entries.splice(_entries.begin(), _entries, it);
+			_entries.front().generation = _generation;
+			_stats.hits++;
+			return &_entries.front();
+		}
+	}
+
+	_stats.misses++;
+	return nullptr;
+}
+
+const SurfaceCache::Entry* SurfaceCache::Insert(const SurfaceKey& key, const Surface& surface, void* handle)
+{
+	for (auto it = _entries.begin(); it != _entries.end(); ++it)
+	{
+		if (it->key == key)
+		{
+			Release(*it);
+			_entries.erase(it);
+			break;
+		}
+	}
+
+	_entries.push_front({ key, surface, handle, _generation });
+	_stats.bytes += SizeOf(surface);
+	_stats.entries++;
+	Trim();
+
+	return &_entries.front();
+}
+
+void SurfaceCache::Clear()
+{
+	for (const auto& entry : _entries)
+	{
+		Release(entry);
+	}
+
+	_entries.clear();
+}
+
+void SurfaceCache::SetBudget(const size_t budgetBytes)
+{
+	_budget = budgetBytes;
+	Trim();
+}
+
+void SurfaceCache::Trim()
+{
+	// Entries are ordered by last use, so once the oldest one is current, all of them are
+	while (_stats.bytes > _budget && !_entries.empty() && _entries.back().generation != _generation)
+	{
+		Release(_entries.back());
+		_entries.pop_back();
+		_stats.evictions++;
+	}
+}
+
+void SurfaceCache::Release(const Entry& entry)
+{
+	_stats.bytes -= SizeOf(entry.surface);
+	_stats.entries--;
+
+	if (entry.handle)
+	{
+		_target.Release(entry.handle);
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+
+#include "OverlayType.h"
+#include "Rasterizer.h"
+#include "RenderTarget.h"
+
+struct SurfaceKey
+{
+	OverlayType type = OverlayTop;
+	uint32_t color = 0;
+	int32_t width = 0;
+	int32_t height = 0;
+	int32_t strip = -1; // Index of the edge strip, or -1 for the whole overlay
+	uint32_t style = 0; // Id of the custom draw list, which replaces the type, or 0
+
+	bool operator==(const SurfaceKey&) const = default;
+};
+
+// Bounded LRU cache of rendered overlay surfaces. The cache owns the handle backing each surface
+// and hands it back to the render target that allocated it on eviction.
+class SurfaceCache
+{
+public:
+	struct Entry
+	{
+		SurfaceKey key;
+		Surface surface;
+		void* handle = nullptr;
+		uint64_t generation = 0;
+	};
+
+	struct Stats
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+		size_t bytes = 0;
+		size_t entries = 0;
+	};
+
+	SurfaceCache(size_t budgetBytes, RenderTarget& target);
+	~SurfaceCache();
+
+	SurfaceCache(const SurfaceCache&) = delete;
+	SurfaceCache& operator=(const SurfaceCache&) = delete;
+
+	// Returns the cached entry and marks it as most recently used, or nullptr on a miss
+	const Entry* Find(const SurfaceKey& key);
+
+	// Takes ownership of the handle. Entries used since the last NextGeneration are never evicted,
+	// even if they alone exceed the budget, because they may be on screen.
+	const Entry* Insert(const SurfaceKey& key, const Surface& surface, void* handle);
+
+	void NextGeneration() { _generation++; }
+
+	void Clear();
+	void SetBudget(size_t budgetBytes);
+
+	size_t GetBudget() const { return _budget; }
+	const Stats& GetStats() const { return _stats; }
+
+	static size_t SizeOf(const Surface& surface) { return (size_t)surface.stride * surface.height * sizeof(uint32_t); }
+
+private:
+	void Trim();
+	void Release(const Entry& entry);
+
+	std::list<Entry> _entries; // Most recently used first
+	size_t _budget;
+	RenderTarget& _target;
+	uint64_t _generation = 0;
+	Stats _stats;
+};
@@ -0,0 +1,290 @@
+// ReSharper disable CppCStyleCast
+#include "Trace.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <iterator>
+
+static const char* const SpanNames[] = { "ClipboardToVisible", "Handoff", "Show", "RenderSurface", "UpdateLayeredWindow", "Frame", "Startup", "DeferredInit" };
+
+static_assert(sizeof(SpanNames) / sizeof(SpanNames[0]) == SpanMax);
+
+static void Append(std::string& text, const char* format, ...)
+{
+	char buffer[256];
+
+	va_list args;
+	va_start(args, format);
+	const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	if (length > 0)
+	{
+		text.append(buffer, std::min((size_t)length, sizeof(buffer) - 1));
+	}
+}
+
+size_t LatencyHistogram::BucketIndex(const uint64_t ns)
+{
+	if (ns < HalfSubBuckets * 2)
+	{
+		return (size_t)ns;
+	}
+
+	const int shift = std::bit_width(ns) - SubBucketBits;
+	return (size_t)shift * HalfSubBuckets + (size_t)(ns >> shift);
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(const size_t index)
+{
+	if (index < HalfSubBuckets * 2)
+	{
+		return index;
+	}
+
+	const auto shift = index / HalfSubBuckets - 1;
+	return (uint64_t)(index - shift * HalfSubBuckets) << shift;
+}
+
+void LatencyHistogram::Record(const uint64_t ns)
+{
+	// The single writer makes these plain loads and stores, a locked add costs as much as the rest of a span
+	auto& count = _counts[BucketIndex(ns)];
+	count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	_total.store(_total.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+
+	if (ns > _max.load(std::memory_order_relaxed))
+	{
+		_max.store(ns, std::memory_order_relaxed);
+	}
+}
+
+void LatencyHistogram::Add(const LatencyHistogram& other)
+{
+	for (size_t i = 0; i < BucketCount; i++)
+	{
+		_counts[i].store(_counts[i].load(std::memory_order_relaxed) + other._counts[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	_total.store(_total.load(std::memory_order_relaxed) + other.GetTotal(), std::memory_order_relaxed);
+	_max.store(std::max(GetMax(), other.GetMax()), std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::GetCount() const
+{
+	uint64_t count = 0;
+
+	for (const auto& bucket : _counts)
+	{
+		count += bucket.load(std::memory_order_relaxed);
+	}
+
+	return count;
+}
+
+uint64_t LatencyHistogram::GetPercentile(const double percentile) const
+{
+	const auto count = GetCount();
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	const auto rank = std::max<uint64_t>(1, (uint64_t)(percentile / 100.0 * (double)count + 0.5));
+	uint64_t seen = 0;
+
+	for (size_t i = 0; i < BucketCount; i++)
+	{
+		seen += _counts[i].load(std::memory_order_relaxed);
+
+		if (seen >= rank)
+		{
+			const auto lower = BucketLowerBound(i);
+			const auto upper = i + 1 < BucketCount ? BucketLowerBound(i + 1) : lower;
+			return std::min(lower + (upper - lower) / 2, GetMax());
+		}
+	}
+
+	return GetMax();
+}
+
+int64_t Tracer::Now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* Tracer::GetName(const TraceSpan span)
+{
+	return span < SpanMax ? SpanNames[span] : "Unknown";
+}
+
+Tracer::Tracer()
+	: _id([]
+	{
+		static std::atomic<uint64_t> s_nextId = 1;
+		return s_nextId.fetch_add(1, std::memory_order_relaxed);
+	}())
+{
+}
+
+Tracer& Tracer::Global()
+{
+	static Tracer tracer;
+	return tracer;
+}
+
+uint32_t Tracer::CurrentThread()
+{
+	static std::atomic<uint32_t> s_nextThread = 1;
+
+	// Zero-initialized, so that reading it doesn't go through a thread-local initialization guard
+	thread_local uint32_t thread = 0;
+
+	if (thread == 0)
+	{
+		thread = s_nextThread.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return thread;
+}
+
+LatencyHistogram* Tracer::GetHistograms()
+{
+	struct Cache
+	{
+		uint64_t tracer;
+		LatencyHistogram* histograms;
+	};
+
+	// Almost every span goes through the same tracer as the previous one on the thread
+	thread_local Cache cache = {};
+
+	if (cache.tracer == _id)
+	{
+		return cache.histograms;
+	}
+
+	const auto thread = CurrentThread();
+	std::lock_guard lock(_shardMutex);
+
+	auto it = std::find_if(_shards.begin(), _shards.end(), [&](const auto& shard) { return shard->thread == thread; });
+
+	if (it == _shards.end())
+	{
+		_shards.push_back(std::make_unique<Shard>());
+		_shards.back()->thread = thread;
+		it = std::prev(_shards.end());
+	}
+
+	cache = { _id, (*it)->histograms };
+	return cache.histograms;
+}
+
+void Tracer::GetHistogram(const TraceSpan span, LatencyHistogram& histogram) const
+{
+	std::lock_guard lock(_shardMutex);
+
+	for (const auto& shard : _shards)
+	{
+		histogram.Add(shard->histograms[span]);
+	}
+}
+
+void Tracer::Record(const TraceSpan span, const int64_t start, const int64_t end)
+{
+	const auto duration = std::max<int64_t>(0, end - start);
+	const auto index = _next.fetch_add(1, std::memory_order_relaxed);
+	auto& slot = _slots[index & (Capacity - 1)];
+
+	slot.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.start.store(start, std::memory_order_relaxed);
+	slot.duration.store(duration, std::memory_order_relaxed);
+	slot.info.store(CurrentThread() << 8 | span, std::memory_order_relaxed);
+	slot.sequence.store(index + 1, std::memory_order_release);
+
+	GetHistograms()[span].Record((uint64_t)duration);
+}
+
+std::vector<Tracer::Event> Tracer::GetEvents() const
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	const auto next = _next.load(std::memory_order_acquire);
+	const auto first = next > Capacity ? next - Capacity : 0;
+
+	std::vector<Event> events;
+	events.reserve((size_t)(next - first));
+
+	for (auto index = first; index < next; index++)
+	{
+		const auto& slot = _slots[index & (Capacity - 1)];
+
+		const auto before = slot.sequence.load(std::memory_order_acquire);
+		const auto start = slot.start.load(std::memory_order_relaxed);
+		const auto duration = slot.duration.load(std::memory_order_relaxed);
+		const auto info = slot.info.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		// Skip the slots being written, or already overwritten by a newer event
+		if (before != index + 1 || slot.sequence.load(std::memory_order_relaxed) != before)
+		{
+			continue;
+		}
+
+		events.push_back({ start, duration, (TraceSpan)(info & 0xFF), info >> 8 });
+	}
+
+	return events;
+}
+
+std::string Tracer::ToJson() const
+{
+	std::string json = "{\n  \"unit\": \"us\",\n  \"spans\": [";
+
+	for (int span = 0; span < SpanMax; span++)
+	{
+		LatencyHistogram histogram;
+		GetHistogram((TraceSpan)span, histogram);
+		const auto count = histogram.GetCount();
+		const auto mean = count ? (double)histogram.GetTotal() / (double)count : 0.0;
+
+		Append(json, "%s\n    { \"name\": \"%s\", \"count\": %llu, \"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f }",
+			span ? "," : "",
+			SpanNames[span],
+			(unsigned long long)count,
+			mean / 1000.0,
+			(double)histogram.GetPercentile(50) / 1000.0,
+			(double)histogram.GetPercentile(90) / 1000.0,
+			(double)histogram.GetPercentile(99) / 1000.0,
+			(double)histogram.GetMax() / 1000.0);
+	}
+
+	json += "\n  ]\n}\n";
+	return json;
+}
+
+std::string Tracer::ToChromeTrace() const
+{
+	const auto events = GetEvents();
+	std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		const auto& event = events[i];
+
+		Append(json, "%s\n{\"name\":\"%s\",\"cat\":\"clipping\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			i ? "," : "",
+			SpanNames[event.span],
+			event.thread,
+			(double)event.start / 1000.0,
+			(double)event.duration / 1000.0);
+	}
+
+	json += "\n]}\n";
+	return json;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum TraceSpan : uint8_t
+{
+	SpanClipboardToVisible, // From WM_CLIPBOARDUPDATE to the first frame with a visible overlay
+	SpanHandoff, // From the listener thread to the render thread
+	SpanShow,
+	SpanRenderSurface, // Allocating and rasterizing a surface on a cache miss
+	SpanUpdateLayeredWindow,
+	SpanFrame,
+	SpanStartup, // From the process creation to the clipboard listener being registered
+	SpanDeferredInit, // Initialization left out of the startup, on first use or when idle
+	SpanMax
+};
+
+// Log-linear latency histogram in the style of HdrHistogram: values are bucketed with 3 bits of
+// precision (at most 12.5% error) over the whole 64-bit range, in a fixed 2 KB table. There can only be
+// one writer, which records without read-modify-writes, readers can load the counts at any time.
+class LatencyHistogram
+{
+public:
+	void Record(uint64_t ns);
+
+	// Adds the values recorded in the other histogram, which can still be written to
+	void Add(const LatencyHistogram& other);
+
+	uint64_t GetCount() const;
+	uint64_t GetMax() const { return _max.load(std::memory_order_relaxed); }
+	uint64_t GetTotal() const { return _total.load(std::memory_order_relaxed); }
+
+	// Returns the midpoint of the bucket holding the given percentile (0-100)
+	uint64_t GetPercentile(double percentile) const;
+
+	static size_t BucketIndex(uint64_t ns);
+	static uint64_t BucketLowerBound(size_t index);
+
+private:
+	static constexpr int SubBucketBits = 4;
+	static constexpr size_t HalfSubBuckets = size_t(1) << (SubBucketBits - 1);
+	static constexpr size_t BucketCount = (64 - SubBucketBits + 2) * HalfSubBuckets;
+
+	std::atomic<uint32_t> _counts[BucketCount] = {};
+	std::atomic<uint64_t> _total = 0;
+	std::atomic<uint64_t> _max = 0;
+};
+
+// Low-overhead span recorder. Spans go into a fixed-size ring buffer that keeps the most recent ones
+// for trace dumps, and into a latency histogram per span kind and thread, merged when they're read.
+// Recording is lock-free after the first span of a thread and can happen on any thread; readers use a
+// sequence number per slot to skip the ones being overwritten.
+class Tracer
+{
+public:
+	struct Event
+	{
+		int64_t start; // In ns, from Now()
+		int64_t duration;
+		TraceSpan span;
+		uint32_t thread;
+	};
+
+	static constexpr size_t Capacity = 4096;
+
+	Tracer();
+
+	Tracer(const Tracer&) = delete;
+	Tracer& operator=(const Tracer&) = delete;
+
+	void Record(TraceSpan span, int64_t start, int64_t end);
+
+	// Copies the events currently in the ring buffer, oldest first
+	std::vector<Event> GetEvents() const;
+
+	// Merges the histograms of the threads that recorded the span kind
+	void GetHistogram(TraceSpan span, LatencyHistogram& histogram) const;
+
+	// Latency summary per span kind
+	std::string ToJson() const;
+
+	// Trace Event Format, for chrome://tracing and Perfetto
+	std::string ToChromeTrace() const;
+
+	static int64_t Now();
+	static const char* GetName(TraceSpan span);
+
+	// The recorder used by the application
+	static Tracer& Global();
+
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence = 0; // Index of the event + 1, 0 while it's being written
+		std::atomic<int64_t> start = 0;
+		std::atomic<int64_t> duration = 0;
+		std::atomic<uint32_t> info = 0; // Thread in the high bits, span kind in the low byte
+	};
+
+	struct Shard
+	{
+		uint32_t thread = 0;
+		LatencyHistogram histograms[SpanMax];
+	};
+
+	static uint32_t CurrentThread();
+
+	// The histograms of the calling thread
+	LatencyHistogram* GetHistograms();
+
+	const uint64_t _id; // Identifies the tracer in the per-thread cache, unlike its address it's never reused
+	std::atomic<uint64_t> _next = 0;
+	Slot _slots[Capacity];
+
+	// Only locked for the first span of a thread, and by the readers
+	mutable std::mutex _shardMutex;
+	std::vector<std::unique_ptr<Shard>> _shards;
+};
+
+// Records the lifetime of the object as a span
+class ScopedSpan
+{
+public:
+	explicit ScopedSpan(const TraceSpan span, Tracer& tracer = Tracer::Global())
+		: _tracer(tracer), _start(Tracer::Now()), _span(span)
+	{
+	}
+
+	~ScopedSpan() { _tracer.Record(_span, _start, Tracer::Now()); }
+
+	ScopedSpan(const ScopedSpan&) = delete;
+	ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+	Tracer& _tracer;
+	int64_t _start;
+	TraceSpan _span;
+};
@@ -0,0 +1,337 @@
+// ReSharper disable CppCStyleCast
+#include "TrigramIndex.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+std::u16string TrigramIndex::Widen(const std::string_view text)
+{
+	std::u16string wide;
+	wide.reserve(text.size());
+
+	for (const auto c : text)
+	{
+		if (c == '\0')
+		{
+			break;
+		}
+
+		wide.push_back((char16_t)(uint8_t)c);
+	}
+
+	return wide;
+}
+
+void TrigramIndex::Add(const uint64_t id, std::u16string_view text)
+{
+	if (_numbers.count(id))
+	{
+		Touch(id);
+		return;
+	}
+
+	// Clipboard text is NUL-terminated, and the allocation can be larger than the text
+	text = text.substr(0, std::min(text.find(u'\0'), MaxIndexedChars));
+
+	std::u16string folded(text);
+
+	for (auto& c : folded)
+	{
+		c = Fold(c);
+	}
+
+	Insert(id, std::move(folded));
+}
+
+void TrigramIndex::Insert(const uint64_t id, std::u16string text)
+{
+	// Numbers only grow, so appending keeps the posting lists sorted and a repeated
+	// trigram of the same document is always at the back of its list
+	const auto number = (uint32_t)_documents.size();
+	uint32_t postings = 0;
+
+	const auto post = [&](const uint64_t key)
+	{
+		auto& list = _postings[key];
+
+		if (list.empty() || list.back() != number)
+		{
+			list.push_back(number);
+			postings++;
+		}
+	};
+
+	if (text.size() >= 2)
+	{
+		post(Anchor(text.data()));
+	}
+
+	for (size_t i = 0; i + 2 <= text.size(); i++)
+	{
+		post(Bigram(text.data() + i));
+
+		if (i + 3 <= text.size())
+		{
+			post(Trigram(text.data() + i));
+		}
+	}
+
+	_livePostings += postings;
+	_textBytes += text.size() * sizeof(char16_t);
+	_numbers[id] = number;
+	_documents.push_back({ id, std::move(text), postings, true });
+}
+
+void TrigramIndex::Touch(const uint64_t id)
+{
+	const auto it = _numbers.find(id);
+
+	if (it == _numbers.end() || it->second + 1 == _documents.size())
+	{
+		return;
+	}
+
+	// Indexed again under a new number, the old postings die with the old number
+	Insert(id, Kill(it->second));
+}
+
+void TrigramIndex::Remove(const uint64_t id)
+{
+	const auto it = _numbers.find(id);
+
+	if (it == _numbers.end())
+	{
+		return;
+	}
+
+	const auto number = it->second;
+	_numbers.erase(it);
+
+	// Nothing to keep, that's the cheapest compaction
+	if (_numbers.empty())
+	{
+		Clear();
+		return;
+	}
+
+	Kill(number);
+}
+
+std::u16string TrigramIndex::Kill(const uint32_t number)
+{
+	auto& document = _documents[number];
+	_livePostings -= document.postings;
+	_deadPostings += document.postings + 1;
+	_textBytes -= document.text.size() * sizeof(char16_t);
+
+	document.live = false;
+	auto text = std::move(document.text);
+	document.text = {};
+
+	if (_deadPostings > MinCompaction && _deadPostings > _livePostings)
+	{
+		Compact();
+	}
+
+	return text;
+}
+
+void TrigramIndex::Clear()
+{
+	_postings.clear();
+	_documents.clear();
+	_numbers.clear();
+	_livePostings = 0;
+	_deadPostings = 0;
+	_textBytes = 0;
+}
+
+void TrigramIndex::Compact()
+{
+	// Renumber the live documents, in the same order
+	std::vector<uint32_t> numbers(_documents.size(), UINT32_MAX);
+	uint32_t next = 0;
+
+	for (uint32_t number = 0; number < _documents.size(); number++)
+	{
+		if (_documents[number].live)
+		{
+			numbers[number] = next;
+			_numbers[_documents[number].id] = next;
+
+			// Moving a string onto itself can empty it
+			if (next != number)
+			{
+				_documents[next] = std::move(_documents[number]);
+			}
+
+			next++;
+		}
+	}
+
+	_documents.resize(next);
+
+	for (auto it = _postings.begin(); it != _postings.end();)
+	{
+		auto& list = it->second;
+		size_t kept = 0;
+
+		for (const auto number : list)
+		{
+			if (numbers[number] != UINT32_MAX)
+			{
+				list[kept++] = numbers[number];
+			}
+		}
+
+		if (kept == 0)
+		{
+			it = _postings.erase(it);
+		}
+		else
+		{
+			list.resize(kept);
+			list.shrink_to_fit();
+			++it;
+		}
+	}
+
+	_deadPostings = 0;
+}
+
+bool TrigramIndex::Matches(const Document& document, const std::u16string_view query, const QueryMode mode)
+{
+	const std::u16string_view text = document.text;
+	return mode == QueryPrefix ? text.substr(0, query.size()) == query : text.find(query) != std::u16string_view::npos;
+}
+
+void TrigramIndex::Search(const std::u16string_view query, const QueryMode mode, const size_t limit, std::vector<uint64_t>& results) const
+{
+	size_t found = 0;
+
+	std::u16string folded(query);
+
+	for (auto& c : folded)
+	{
+		c = Fold(c);
+	}
+
+	if (folded.size() < 2)
+	{
+		for (auto number = _documents.size(); number-- > 0 && found < limit;)
+		{
+			const auto& document = _documents[number];
+
+			if (document.live && Matches(document, folded, mode))
+			{
+				results.push_back(document.id);
+				found++;
+			}
+		}
+
+		return;
+	}
+
+	std::vector<uint64_t> keys;
+
+	if (mode == QueryPrefix)
+	{
+		keys.push_back(Anchor(folded.data()));
+	}
+
+	if (folded.size() == 2 && mode == QuerySubstring)
+	{
+		keys.push_back(Bigram(folded.data()));
+	}
+
+	for (size_t i = 0; i + 3 <= folded.size(); i++)
+	{
+		keys.push_back(Trigram(folded.data() + i));
+	}
+
+	// Remaining part of each posting list, shrinking from the end as the search goes down
+	std::vector<std::pair<const uint32_t*, const uint32_t*>> lists;
+
+	for (const auto key : keys)
+	{
+		const auto it = _postings.find(key);
+
+		if (it == _postings.end())
+		{
+			return;
+		}
+
+		lists.emplace_back(it->second.data(), it->second.data() + it->second.size());
+	}
+
+	// Shortest first, they discard the most candidates
+	std::sort(lists.begin(), lists.end(), [](const auto& left, const auto& right)
+	{
+		return left.second - left.first != right.second - right.first
+			? left.second - left.first < right.second - right.first
+			: std::less<>()(left.first, right.first);
+	});
+	lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+	// Leapfrog join from the most recent number: each list in turn moves the target down to its
+	// largest number not above it, until all of them agree
+	uint32_t target = UINT32_MAX;
+	size_t agreed = 0;
+
+	for (size_t l = 0; found < limit; l = (l + 1) % lists.size())
+	{
+		auto& [begin, end] = lists[l];
+
+		// Galloping from the end: in the dense lists, the next number is usually right there
+		size_t step = 1;
+
+		while ((size_t)(end - begin) > step && end[-(ptrdiff_t)step] > target)
+		{
+			step *= 2;
+		}
+
+		end = std::upper_bound(end - std::min(step, (size_t)(end - begin)), end - step / 2, target);
+
+		if (end == begin)
+		{
+			break;
+		}
+
+		if (end[-1] != target)
+		{
+			target = end[-1];
+			agreed = 0;
+		}
+
+		if (++agreed < lists.size())
+		{
+			continue;
+		}
+
+		// Trigrams can match out of order, so the text has the final say
+		const auto& document = _documents[target];
+
+		if (document.live && Matches(document, folded, mode))
+		{
+			results.push_back(document.id);
+			found++;
+		}
+
+		if (target == 0)
+		{
+			break;
+		}
+
+		target--;
+		agreed = 0;
+	}
+}
+
+size_t TrigramIndex::GetMemoryUsage() const
+{
+	return _textBytes
+		+ _livePostings * sizeof(uint32_t)
+		+ _postings.size() * ListOverhead
+		+ _documents.size() * DocumentOverhead;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Incremental trigram inverted index over text documents, for substring and prefix search ranked by
+// recency. Text is indexed as UTF-16 code units with ASCII case folding; bigrams are indexed as well for
+// two-character queries, and the first two characters of each document for prefix queries. Documents are numbered in the
+// order they were added or touched, so the posting lists are sorted by recency and a search walks them
+// from the end, stopping after enough matches. Adding or touching a document costs O(length); removals
+// are lazy, the dead postings are dropped in bulk once they outnumber the live ones.
+class TrigramIndex
+{
+public:
+	enum QueryMode : uint8_t { QuerySubstring, QueryPrefix };
+
+	// Only the start of long documents is indexed
+	static constexpr size_t MaxIndexedChars = 4096;
+
+	void Add(uint64_t id, std::u16string_view text);
+
+	// Makes the document the most recent one
+	void Touch(uint64_t id);
+	void Remove(uint64_t id);
+	void Clear();
+
+	// Appends the ids of up to 'limit' matching documents, most recent first.
+	// Queries of a single character scan the documents from the most recent.
+	void Search(std::u16string_view query, QueryMode mode, size_t limit, std::vector<uint64_t>& results) const;
+
+	size_t GetCount() const { return _numbers.size(); }
+
+	// Estimate of the memory used by the text, the live postings and the tables, in constant time.
+	// Postings of removed documents come on top, until the next compaction.
+	size_t GetMemoryUsage() const;
+
+	// Decodes 8-bit text (ANSI, treated as Latin-1) up to the first NUL
+	static std::u16string Widen(std::string_view text);
+
+private:
+	struct Document
+	{
+		uint64_t id;
+		std::u16string text; // Folded, truncated to MaxIndexedChars. Empty once removed.
+		uint32_t postings; // Distinct grams
+		bool live;
+	};
+
+	static char16_t Fold(char16_t c) { return c >= u'A' && c <= u'Z' ? (char16_t)(c + (u'a' - u'A')) : c; }
+	// Keys of the posting lists: the characters in the low 48 bits, the kind of gram above
+	static uint64_t Trigram(const char16_t* text) { return (uint64_t)text[0] << 32 | (uint64_t)text[1] << 16 | text[2]; }
+	static uint64_t Bigram(const char16_t* text) { return 1ull << 48 | (uint64_t)text[0] << 16 | text[1]; }
+	static uint64_t Anchor(const char16_t* text) { return 2ull << 48 | (uint64_t)text[0] << 16 | text[1]; }
+
+	static bool Matches(const Document& document, std::u16string_view query, QueryMode mode);
+
+	void Insert(uint64_t id, std::u16string text);
+	// Returns the text of the document, which is no longer counted
+	std::u16string Kill(uint32_t number);
+	void Compact();
+
+	// Below this, dead postings are cheaper to skip than to compact
+	static constexpr size_t MinCompaction = 64 * 1024;
+
+	// Hash table nodes: key, value and the links
+	static constexpr size_t ListOverhead = sizeof(uint64_t) + sizeof(std::vector<uint32_t>) + 2 * sizeof(void*);
+	static constexpr size_t DocumentOverhead = sizeof(Document) + sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void*);
+
+	std::unordered_map<uint64_t, std::vector<uint32_t>> _postings; // Gram to sorted document numbers
+	std::vector<Document> _documents; // By number, oldest first
+	std::unordered_map<uint64_t, uint32_t> _numbers; // Document id to number
+	size_t _livePostings = 0;
+	size_t _deadPostings = 0; // Including one per dead document, for the slot
+	size_t _textBytes = 0;
+};
@@ -4,6 +4,7 @@
 #define IDM_EXIT        1001
 #define IDM_SETTINGS    1002
 #define IDM_ABOUT       1003
+#define IDM_EXPORTTRACE 1004
 
 #define IDD_SETTINGS    200
 #define IDC_BTN_COLOR   201
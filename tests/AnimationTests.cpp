@@ -0,0 +1,187 @@
+// ReSharper disable CppCStyleCast
+#include <algorithm>
+#include <cstdlib>
+
+#include "Animation.h"
+#include "Test.h"
+
+// The fade of a ping, driven by a virtual clock
+
+static constexpr double FrameMs = 1000.0 / 60.0;
+
+static int32_t Expected(const double alpha)
+{
+	return (int32_t)(alpha * 255.0);
+}
+
+TEST(FadeInFollowsTheCurve)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Start(clock.Now());
+
+	CHECK_EQ(0, fade.Tick(clock.Now()));
+	CHECK(fade.GetPhase() == FadeAnimation::PhaseFadeIn);
+
+	int32_t previous = 0;
+
+	while (clock.Now() + FrameMs < FadeAnimation::FadeInMs)
+	{
+		clock.Advance(FrameMs);
+		const auto alpha = fade.Tick(clock.Now());
+		CHECK_EQ(Expected(FadeAnimation::EaseOutCubic(clock.Now() / FadeAnimation::FadeInMs)), alpha);
+		CHECK(alpha > previous);
+		previous = alpha;
+	}
+}
+
+TEST(PingLastsFadeInAndFadeOut)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Start(clock.Now());
+
+	int frames = 0;
+
+	while (fade.Tick(clock.Now()) > 0 || frames == 0)
+	{
+		clock.Advance(FrameMs);
+		frames++;
+	}
+
+	CHECK(!fade.IsRunning());
+	CHECK(clock.Now() >= FadeAnimation::FadeInMs + FadeAnimation::FadeOutMs);
+	CHECK(clock.Now() < FadeAnimation::FadeInMs + FadeAnimation::FadeOutMs + FrameMs);
+	CHECK_EQ(24, frames);
+}
+
+// A late frame lands where it would have been on time, the phases keep their schedule
+TEST(LateFrameKeepsTheSchedule)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Start(clock.Now());
+	fade.Tick(clock.Now());
+
+	clock.Advance(FadeAnimation::FadeInMs + FadeAnimation::FadeOutMs / 2);
+	CHECK_EQ(Expected(1.0 - FadeAnimation::EaseInCubic(0.5)), fade.Tick(clock.Now()));
+	CHECK(fade.GetPhase() == FadeAnimation::PhaseFadeOut);
+
+	clock.Advance(FadeAnimation::FadeOutMs);
+	CHECK_EQ(0, fade.Tick(clock.Now()));
+	CHECK(fade.GetPhase() == FadeAnimation::PhaseNone);
+}
+
+TEST(ExtendHoldsFullyOpaque)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Start(clock.Now());
+	fade.Extend(clock.Now(), 500);
+
+	clock.Advance(FadeAnimation::FadeInMs);
+	CHECK_EQ(255, fade.Tick(clock.Now()));
+	CHECK(fade.GetPhase() == FadeAnimation::PhaseHold);
+
+	clock.Advance(399);
+	CHECK_EQ(255, fade.Tick(clock.Now()));
+
+	// The fade-out starts when the hold ends
+	clock.Advance(1 + FadeAnimation::FadeOutMs / 2);
+	CHECK_EQ(Expected(1.0 - FadeAnimation::EaseInCubic(0.5)), fade.Tick(clock.Now()));
+}
+
+// Fading back in starts from the current alpha, so the overlay doesn't flicker
+TEST(ExtendDuringFadeOutFadesBackIn)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Start(clock.Now());
+
+	clock.Advance(FadeAnimation::FadeInMs + FadeAnimation::FadeOutMs / 2);
+	const auto alpha = fade.Tick(clock.Now());
+
+	fade.Extend(clock.Now(), 200);
+	CHECK(fade.GetPhase() == FadeAnimation::PhaseFadeIn);
+	CHECK(abs(fade.Tick(clock.Now()) - alpha) <= 1);
+
+	int32_t previous = alpha;
+
+	for (int i = 0; i < 4 && fade.GetPhase() == FadeAnimation::PhaseFadeIn; i++)
+	{
+		clock.Advance(5);
+		const auto next = fade.Tick(clock.Now());
+		CHECK(next >= previous);
+		previous = next;
+	}
+
+	clock.Advance(FadeAnimation::FadeInMs);
+	CHECK_EQ(255, fade.Tick(clock.Now()));
+	CHECK(fade.GetPhase() == FadeAnimation::PhaseHold);
+
+	clock.Advance(200);
+	CHECK(fade.Tick(clock.Now()) < 255);
+	CHECK(fade.GetPhase() == FadeAnimation::PhaseFadeOut);
+}
+
+TEST(RestartPlaysTheWholeFadeOutAgain)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Start(clock.Now());
+
+	clock.Advance(FadeAnimation::FadeInMs + FadeAnimation::FadeOutMs * 0.8);
+	const auto alpha = fade.Tick(clock.Now());
+
+	fade.Restart(clock.Now());
+	CHECK(abs(fade.Tick(clock.Now()) - alpha) <= 1);
+
+	// Back to fully opaque for the rest of the fade-in, then faded out after a whole fade-out
+	const double restart = clock.Now();
+	int32_t peak = 0;
+
+	while (fade.IsRunning())
+	{
+		peak = std::max(peak, fade.Tick(clock.Now()));
+		clock.Advance(1);
+	}
+
+	// The millisecond steps can miss the frame at the end of the fade-in
+	CHECK(peak >= 254);
+	CHECK(clock.Now() - restart >= FadeAnimation::FadeOutMs);
+	CHECK(clock.Now() - restart <= FadeAnimation::FadeInMs + FadeAnimation::FadeOutMs + 1);
+}
+
+TEST(RestartWhenIdleStarts)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Restart(clock.Now());
+
+	CHECK(fade.GetPhase() == FadeAnimation::PhaseFadeIn);
+	CHECK_EQ(0, fade.Tick(clock.Now()));
+}
+
+TEST(ExtendWhenIdleDoesNothing)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Extend(clock.Now(), 500);
+
+	CHECK(!fade.IsRunning());
+	CHECK_EQ(0, fade.Tick(clock.Now()));
+}
+
+TEST(StopEndsThePing)
+{
+	VirtualClock clock;
+	FadeAnimation fade;
+	fade.Start(clock.Now());
+
+	clock.Advance(FadeAnimation::FadeInMs / 2);
+	CHECK(fade.Tick(clock.Now()) > 0);
+
+	fade.Stop();
+	CHECK(!fade.IsRunning());
+	CHECK_EQ(0, fade.Tick(clock.Now()));
+}
@@ -0,0 +1,11 @@
+#include <cstdio>
+
+#include "Benchmark.h"
+
+// The benchmarks of ClipPing.exe --benchmark, runnable without Windows
+int main()
+{
+	const auto report = Benchmark::Run();
+	fputs(report.c_str(), stdout);
+	return 0;
+}
@@ -0,0 +1,209 @@
+// ReSharper disable CppCStyleCast
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ClipboardHistory.h"
+#include "Test.h"
+
+// Deduplication, eviction and the memory budget of the clipboard history
+
+static constexpr uint32_t Format = 1;
+static constexpr size_t Budget = 1024 * 1024;
+
+static std::vector<uint8_t> MakeBinary(const uint32_t seed, const size_t size)
+{
+	std::vector<uint8_t> data(size);
+	uint32_t state = seed * 2654435761u + 1;
+
+	for (auto& byte : data)
+	{
+		state = state * 1103515245 + 12345;
+		byte = (uint8_t)(state >> 16);
+	}
+
+	return data;
+}
+
+static uint64_t Add(ClipboardHistory& history, const std::vector<uint8_t>& data, const uint64_t time, const PayloadKind kind = PayloadBinary)
+{
+	return history.Add(Format, data.data(), data.size(), kind, time);
+}
+
+// Ids from the most recent to the oldest
+static std::vector<uint64_t> GetIds(const ClipboardHistory& history)
+{
+	std::vector<uint64_t> ids;
+	history.ForEach([&](const ClipboardHistory::Entry& entry)
+	{
+		ids.push_back(entry.id);
+		return true;
+	});
+
+	return ids;
+}
+
+TEST(DuplicateMovesToFront)
+{
+	ClipboardHistory history(Budget);
+	const auto a = MakeBinary(1, 500);
+	const auto b = MakeBinary(2, 500);
+	const auto c = MakeBinary(3, 500);
+
+	const auto idA = Add(history, a, 10);
+	const auto idB = Add(history, b, 11);
+	const auto idC = Add(history, c, 12);
+	CHECK((GetIds(history) == std::vector<uint64_t>{ idC, idB, idA }));
+
+	CHECK_EQ(idA, Add(history, a, 13));
+	CHECK((GetIds(history) == std::vector<uint64_t>{ idA, idC, idB }));
+	CHECK_EQ(3, history.GetCount());
+	CHECK_EQ(1, history.GetStats().duplicates);
+	CHECK_EQ(3, history.GetStats().inserts);
+	CHECK_EQ(13, history.Find(idA)->time);
+	CHECK_EQ(1500, history.GetStats().payloadBytes);
+
+	// The same bytes in another format are another entry
+	CHECK(history.Add(Format + 1, a.data(), a.size(), PayloadBinary, 14) != idA);
+	CHECK_EQ(4, history.GetCount());
+}
+
+TEST(OldestAreEvictedFirst)
+{
+	ClipboardHistory history(Budget);
+	std::vector<uint64_t> added;
+
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		const auto id = Add(history, MakeBinary(i, 20000 + i), i);
+		CHECK(id != 0);
+		added.push_back(id);
+		CHECK(history.GetFootprint() <= Budget);
+	}
+
+	CHECK(history.GetStats().evictions > 0);
+	CHECK_EQ(200, history.GetCount() + history.GetStats().evictions);
+
+	// What's left is the most recent entries, in order
+	const auto ids = GetIds(history);
+	CHECK_EQ(history.GetCount(), ids.size());
+
+	size_t payloadBytes = 0;
+
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		CHECK_EQ(added[added.size() - 1 - i], ids[i]);
+		payloadBytes += history.Find(ids[i])->size;
+	}
+
+	CHECK(history.Find(added[0]) == nullptr);
+	CHECK_EQ(payloadBytes, history.GetStats().payloadBytes);
+
+	// A used entry is the last to go
+	const auto oldest = ids.back();
+	std::vector<uint8_t> data;
+	CHECK(history.Get(oldest, data));
+	CHECK_EQ(oldest, Add(history, data, 1000));
+	CHECK(Add(history, MakeBinary(5000, 20000), 1001) != 0);
+	CHECK(history.Find(oldest) != nullptr);
+	CHECK(history.Find(ids[ids.size() - 2]) == nullptr);
+}
+
+TEST(OversizedEntriesAreRejected)
+{
+	ClipboardHistory history(Budget);
+	const auto kept = Add(history, MakeBinary(1, 100), 1);
+
+	CHECK_EQ(0, Add(history, MakeBinary(2, Budget / ClipboardHistory::MaxEntryShare + 1), 2));
+	CHECK_EQ(0, Add(history, MakeBinary(3, Budget + 1), 3));
+	CHECK_EQ(2, history.GetStats().rejected);
+
+	// Rejections don't evict anything
+	CHECK_EQ(1, history.GetCount());
+	CHECK(history.Find(kept) != nullptr);
+
+	CHECK(Add(history, MakeBinary(4, Budget / ClipboardHistory::MaxEntryShare), 4) != 0);
+	CHECK(history.GetFootprint() <= Budget);
+
+	ClipboardHistory disabled(0);
+	CHECK_EQ(0, Add(disabled, MakeBinary(5, 1), 5));
+	CHECK_EQ(0, disabled.GetCount());
+}
+
+TEST(CompressedRoundTrip)
+{
+	ClipboardHistory history(Budget);
+	std::string text;
+
+	while (text.size() < 3 * ClipboardHistory::CompressMinBytes)
+	{
+		text += "the clipboard history keeps text compressed, ";
+	}
+
+	const std::vector<uint8_t> data(text.begin(), text.end());
+	const auto id = Add(history, data, 1, PayloadText8);
+	const auto entry = history.Find(id);
+
+	CHECK(entry != nullptr);
+	CHECK(entry->compressed);
+	CHECK(entry->storedSize < entry->size);
+	CHECK_EQ(1, history.GetStats().compressed);
+	CHECK_EQ(entry->storedSize, history.GetStats().storedBytes);
+
+	std::vector<uint8_t> read;
+	CHECK(history.Get(id, read));
+	CHECK(read == data);
+
+	// Incompressible text and small text are stored as they are
+	const auto noise = MakeBinary(7, 2 * ClipboardHistory::CompressMinBytes);
+	const auto noiseId = Add(history, noise, 2, PayloadText8);
+	CHECK(!history.Find(noiseId)->compressed);
+	CHECK(history.Get(noiseId, read));
+	CHECK(read == noise);
+
+	const auto small = Add(history, std::vector<uint8_t>(100, 'a'), 3, PayloadText8);
+	CHECK(!history.Find(small)->compressed);
+}
+
+TEST(FootprintAfterEvictionAndClear)
+{
+	ClipboardHistory history(Budget);
+	CHECK_EQ(0, history.GetFootprint());
+
+	for (uint32_t i = 0; i < 50; i++)
+	{
+		Add(history, MakeBinary(i, 30000), i);
+	}
+
+	std::string text = "some searchable text, long enough to be indexed";
+	Add(history, std::vector<uint8_t>(text.begin(), text.end()), 100, PayloadText8);
+
+	const auto full = history.GetFootprint();
+	CHECK(full > 0);
+	CHECK(full <= Budget);
+
+	// A smaller budget evicts down to it
+	history.SetBudget(Budget / 4);
+	CHECK(history.GetFootprint() <= Budget / 4);
+	CHECK(history.GetFootprint() < full);
+	CHECK(history.GetCount() > 0);
+
+	size_t payloadBytes = 0;
+	history.ForEach([&](const ClipboardHistory::Entry& entry)
+	{
+		payloadBytes += entry.size;
+		return true;
+	});
+
+	CHECK_EQ(payloadBytes, history.GetStats().payloadBytes);
+
+	history.Clear();
+	CHECK_EQ(0, history.GetCount());
+	CHECK_EQ(0, history.GetFootprint());
+	CHECK_EQ(0, history.GetStats().payloadBytes);
+	CHECK_EQ(0, history.GetStats().storedBytes);
+
+	// And the budget is still enforced after
+	CHECK(Add(history, MakeBinary(1, 30000), 200) != 0);
+	CHECK(history.GetFootprint() <= Budget / 4);
+}
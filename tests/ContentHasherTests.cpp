@@ -0,0 +1,104 @@
+// ReSharper disable CppCStyleCast
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "ContentHasher.h"
+#include "Test.h"
+
+// XXH64 against the reference implementation
+
+static uint64_t Hash(const char* text, const uint64_t seed = 0)
+{
+	return ContentHasher::Hash(text, strlen(text), seed);
+}
+
+// Bytes that aren't periodic on any of the hash's block sizes
+static std::vector<uint8_t> MakeData(const size_t size)
+{
+	std::vector<uint8_t> data(size);
+
+	for (size_t i = 0; i < size; i++)
+	{
+		data[i] = (uint8_t)(i * 131 + 7);
+	}
+
+	return data;
+}
+
+TEST(ReferenceVectors)
+{
+	CHECK_EQ(0xef46db3751d8e999ull, Hash(""));
+	CHECK_EQ(0x44bc2cf5ad770999ull, Hash("abc"));
+	CHECK_EQ(0xfbcea83c8a378bf1ull, Hash("Nobody inspects the spammish repetition"));
+	CHECK_EQ(0xbea9ca8199328908ull, Hash("abc", 1));
+}
+
+// Every tail length, and inputs below, at and above a stripe
+TEST(ReferenceVectorsByLength)
+{
+	static constexpr struct { size_t size; uint64_t hash; } Vectors[] =
+	{
+		{ 1, 0xa96c7f0ce858bbb7ull },
+		{ 3, 0xbed43740ee6332bbull },
+		{ 4, 0xfa212ae44b3bb23dull },
+		{ 7, 0x2744460dd675d2c0ull },
+		{ 8, 0x994b676b71ce94ddull },
+		{ 31, 0x6711d55e306b5d8full },
+		{ 32, 0x07f7b8e3bc5d6e25ull },
+		{ 33, 0x09f85eeb4e1cbe9full },
+		{ 63, 0xb7c9968c066cb6a5ull },
+		{ 64, 0x50d4159a0411632eull },
+		{ 100, 0x9ddada11d3dc2d8full },
+		{ 1000, 0x0bf0bdbcc82eb373ull },
+	};
+
+	const auto data = MakeData(1000);
+
+	for (const auto& vector : Vectors)
+	{
+		CHECK_EQ(vector.hash, ContentHasher::Hash(data.data(), vector.size));
+	}
+
+	CHECK_EQ(0x3ecb5d7b5e7c64cfull, ContentHasher::Hash(data.data(), data.size(), 0x9E3779B97F4A7C15ull));
+}
+
+TEST(ChunksHashLikeOneGo)
+{
+	static constexpr size_t ChunkSizes[] = { 1, 3, 7, 8, 31, 32, 33, 100 };
+
+	const auto data = MakeData(300);
+
+	for (size_t size = 0; size <= data.size(); size += size < 70 ? 1 : 23)
+	{
+		const auto expected = ContentHasher::Hash(data.data(), size, 42);
+
+		for (const auto chunk : ChunkSizes)
+		{
+			ContentHasher hasher(42);
+
+			for (size_t offset = 0; offset < size; offset += chunk)
+			{
+				hasher.Update(data.data() + offset, std::min(chunk, size - offset));
+			}
+
+			CHECK_EQ(expected, hasher.Finish());
+		}
+	}
+}
+
+// Finish can be called on a stream that goes on
+TEST(FinishDoesNotEndTheStream)
+{
+	const auto data = MakeData(100);
+	ContentHasher hasher;
+
+	hasher.Update(data.data(), 40);
+	CHECK_EQ(ContentHasher::Hash(data.data(), 40), hasher.Finish());
+
+	hasher.Update(data.data() + 40, 60);
+	CHECK_EQ(0x9ddada11d3dc2d8full, hasher.Finish());
+
+	hasher.Update(nullptr, 0);
+	CHECK_EQ(0x9ddada11d3dc2d8full, hasher.Finish());
+}
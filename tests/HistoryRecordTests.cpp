@@ -0,0 +1,166 @@
+// ReSharper disable CppCStyleCast
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "HistoryRecord.h"
+#include "Test.h"
+
+// The history log format, and the recovery of a log left torn or corrupt by a crash
+
+static const std::string Payloads[] = { "first", "", "a longer payload that spans a few alignment units", "last!!!!" };
+
+// A log with the payloads, and the offsets where each record ends
+static std::vector<uint8_t> MakeLog(std::vector<uint64_t>& ends)
+{
+	std::vector<uint8_t> log;
+	HistoryRecord::AppendFileHeader(log);
+	ends.clear();
+
+	for (size_t i = 0; i < std::size(Payloads); i++)
+	{
+		HistoryRecord::Header header = {};
+		header.size = (uint32_t)Payloads[i].size();
+		header.hash = 0x1000 + i;
+		header.time = 0x2000 + i;
+		header.format = 13;
+		header.kind = PayloadText8;
+
+		HistoryRecord::Append(header, Payloads[i].data(), log);
+		ends.push_back(log.size());
+	}
+
+	return log;
+}
+
+TEST(RecordsRoundTrip)
+{
+	std::vector<uint64_t> ends;
+	const auto log = MakeLog(ends);
+
+	CHECK(HistoryRecord::CheckFileHeader(log.data(), log.size()) == HistoryRecord::FileValid);
+	CHECK_EQ(ends.back(), HistoryRecord::FindEnd(log.data(), log.size()));
+
+	uint64_t offset = HistoryRecord::FileHeaderSize;
+
+	for (size_t i = 0; i < std::size(Payloads); i++)
+	{
+		CHECK_EQ(0, offset % HistoryRecord::Alignment);
+		CHECK_EQ(ends[i] - offset, HistoryRecord::Validate(log.data() + offset, log.size() - offset));
+
+		HistoryRecord::Header header;
+		memcpy(&header, log.data() + offset, sizeof(header));
+		CHECK_EQ(Payloads[i].size(), header.size);
+		CHECK_EQ(0x2000 + i, header.time);
+		CHECK(memcmp(log.data() + offset + sizeof(header), Payloads[i].data(), header.size) == 0);
+
+		offset = ends[i];
+	}
+}
+
+// A torn append: recovery keeps every record before the cut
+TEST(TruncatedLogStopsAtLastRecord)
+{
+	std::vector<uint64_t> ends;
+	const auto log = MakeLog(ends);
+
+	for (size_t size = HistoryRecord::FileHeaderSize; size <= log.size(); size++)
+	{
+		uint64_t expected = HistoryRecord::FileHeaderSize;
+
+		for (const auto end : ends)
+		{
+			expected = end <= size ? end : expected;
+		}
+
+		CHECK_EQ(expected, HistoryRecord::FindEnd(log.data(), size));
+	}
+}
+
+// A flipped byte is caught by the checksum or the header checks, and drops its record and the ones after it
+TEST(FlippedByteStopsAtPreviousRecord)
+{
+	std::vector<uint64_t> ends;
+	const auto original = MakeLog(ends);
+
+	for (size_t i = HistoryRecord::FileHeaderSize; i < original.size(); i++)
+	{
+		auto log = original;
+		log[i] ^= 0x10;
+
+		uint64_t expected = HistoryRecord::FileHeaderSize;
+
+		for (const auto end : ends)
+		{
+			expected = end <= i ? end : expected;
+		}
+
+		// The padding after a payload isn't covered by the checksum, and isn't needed to read it back
+		const auto found = HistoryRecord::FindEnd(log.data(), log.size());
+		CHECK(found == expected || found == ends.back());
+
+		if (found != expected)
+		{
+			HistoryRecord::Header header;
+			memcpy(&header, original.data() + expected, sizeof(header));
+			CHECK(i >= expected + sizeof(header) + header.size);
+		}
+	}
+}
+
+TEST(BadMagicAndKindAreRejected)
+{
+	std::vector<uint64_t> ends;
+	auto log = MakeLog(ends);
+	const auto second = (size_t)ends[0];
+
+	HistoryRecord::Header header;
+	memcpy(&header, log.data() + second, sizeof(header));
+
+	// Even with a checksum that matches, the record can't be read as one
+	auto badMagic = log;
+	auto copy = header;
+	copy.magic ^= 1;
+	memcpy(badMagic.data() + second, &copy, sizeof(copy));
+	CHECK_EQ(0, HistoryRecord::Validate(badMagic.data() + second, badMagic.size() - second));
+	CHECK_EQ(ends[0], HistoryRecord::FindEnd(badMagic.data(), badMagic.size()));
+
+	auto badKind = log;
+	copy = header;
+	copy.kind = (PayloadKind)(PayloadText16 + 1);
+	memcpy(badKind.data() + second, &copy, sizeof(copy));
+	CHECK_EQ(0, HistoryRecord::Validate(badKind.data() + second, badKind.size() - second));
+	CHECK_EQ(ends[0], HistoryRecord::FindEnd(badKind.data(), badKind.size()));
+
+	// A size running past the end of the file
+	auto badSize = log;
+	copy = header;
+	copy.size = 0xFFFFFFF0;
+	memcpy(badSize.data() + second, &copy, sizeof(copy));
+	CHECK_EQ(0, HistoryRecord::Validate(badSize.data() + second, badSize.size() - second));
+}
+
+TEST(FileHeaderStatus)
+{
+	std::vector<uint8_t> header;
+	HistoryRecord::AppendFileHeader(header);
+	CHECK_EQ(HistoryRecord::FileHeaderSize, header.size());
+
+	CHECK(HistoryRecord::CheckFileHeader(header.data(), header.size()) == HistoryRecord::FileValid);
+
+	// Only an empty file or a torn header can be started over
+	for (size_t size = 0; size < header.size(); size++)
+	{
+		CHECK(HistoryRecord::CheckFileHeader(header.data(), size) == HistoryRecord::FileEmpty);
+	}
+
+	auto newer = header;
+	newer[8]++;
+	CHECK(HistoryRecord::CheckFileHeader(newer.data(), newer.size()) == HistoryRecord::FileUnknownVersion);
+	CHECK(HistoryRecord::CheckFileHeader(newer.data(), 10) == HistoryRecord::FileInvalid);
+
+	auto other = header;
+	other[0] = 'X';
+	CHECK(HistoryRecord::CheckFileHeader(other.data(), other.size()) == HistoryRecord::FileInvalid);
+	CHECK(HistoryRecord::CheckFileHeader(other.data(), 3) == HistoryRecord::FileInvalid);
+}
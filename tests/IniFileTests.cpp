@@ -0,0 +1,139 @@
+// ReSharper disable CppCStyleCast
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "IniFile.h"
+#include "Test.h"
+
+static constexpr std::string_view Sample =
+	"; ClipPing settings\r\n"
+	"[Overlay]\r\n"
+	"Type=2\r\n"
+	"  Color = 0x00FF00  \r\n"
+	"Name=\"quoted value\"\r\n"
+	"\r\n"
+	"[Behavior]\r\n"
+	"Retrigger=1\r\n"
+	"Coalesce=50ms\r\n"
+	"\r\n"
+	"# trailing comment\r\n";
+
+TEST(SerializeIsVerbatim)
+{
+	IniFile ini;
+	ini.Parse(Sample);
+	CHECK(ini.Serialize() == Sample);
+	CHECK(!ini.IsDirty());
+}
+
+TEST(LineBreaksFollowTheFile)
+{
+	IniFile ini;
+	ini.Parse("[A]\nKey=1\n");
+	ini.SetString("A", "Other", "2");
+	CHECK(ini.Serialize() == "[A]\nKey=1\nOther=2\n");
+
+	// The last line gets a line break
+	ini.Parse("[A]\r\nKey=1");
+	CHECK(ini.Serialize() == "[A]\r\nKey=1\r\n");
+}
+
+TEST(ByteOrderMarkIsKept)
+{
+	IniFile ini;
+	ini.Parse("\xEF\xBB\xBF[A]\r\nKey=1\r\n");
+	CHECK_EQ(1, ini.GetInt("A", "Key", 0));
+
+	ini.SetInt("A", "Key", 2);
+	CHECK(ini.Serialize() == "\xEF\xBB\xBF[A]\r\nKey=2\r\n");
+
+	// And not added to files without one
+	ini.Parse("[A]\r\nKey=1\r\n");
+	CHECK(ini.Serialize() == "[A]\r\nKey=1\r\n");
+}
+
+TEST(LookupsFollowGetPrivateProfileString)
+{
+	IniFile ini;
+	ini.Parse(Sample);
+
+	CHECK(ini.GetString("overlay", "COLOR", "") == "0x00FF00");
+	CHECK(ini.GetString("Overlay", "Name", "") == "quoted value");
+	CHECK(ini.GetString("Overlay", "Missing", "default") == "default");
+	CHECK(ini.GetString("Missing", "Type", "default") == "default");
+	CHECK_EQ(2, ini.GetInt("Overlay", "Type", 0));
+	CHECK_EQ(50, ini.GetInt("Behavior", "Coalesce", 0));
+	CHECK_EQ(0, ini.GetInt("Overlay", "Name", 7));
+	CHECK_EQ(7, ini.GetInt("Overlay", "Missing", 7));
+
+	// Only the first section with a name is used
+	ini.Parse("[A]\nKey=1\n[B]\nKey=2\n[A]\nKey=3\nOther=4\n");
+	CHECK_EQ(1, ini.GetInt("A", "Key", 0));
+	CHECK_EQ(0, ini.GetInt("A", "Other", 0));
+}
+
+TEST(OnlyChangesMakeDirty)
+{
+	IniFile ini;
+	ini.Parse(Sample);
+
+	ini.SetInt("Overlay", "Type", 2);
+	ini.SetString("Overlay", "Color", "0x00FF00");
+	CHECK(!ini.IsDirty());
+
+	ini.SetInt("Overlay", "Type", 3);
+	CHECK(ini.IsDirty());
+}
+
+TEST(ChangesKeepTheRestOfTheFile)
+{
+	IniFile ini;
+	ini.Parse(Sample);
+
+	ini.SetInt("Overlay", "Type", 3);
+	ini.SetString("Behavior", "Policy", "Queue");
+	ini.SetString("History", "HistoryMB", "16");
+
+	// New keys go after the last entry of their section, new sections at the end
+	CHECK(ini.Serialize() ==
+		"; ClipPing settings\r\n"
+		"[Overlay]\r\n"
+		"Type=3\r\n"
+		"  Color = 0x00FF00  \r\n"
+		"Name=\"quoted value\"\r\n"
+		"\r\n"
+		"[Behavior]\r\n"
+		"Retrigger=1\r\n"
+		"Coalesce=50ms\r\n"
+		"Policy=Queue\r\n"
+		"\r\n"
+		"# trailing comment\r\n"
+		"[History]\r\n"
+		"HistoryMB=16\r\n");
+}
+
+TEST(WriteReplacesTheFile)
+{
+	const auto path = std::filesystem::temp_directory_path() / ("ClipPingIniFileTests-" + std::to_string(std::hash<std::string>()(__FILE__)) + ".ini");
+
+	IniFile ini;
+	ini.Parse(Sample);
+	ini.SetInt("Overlay", "Type", 4);
+	CHECK(ini.Write(path));
+	CHECK(!ini.IsDirty());
+
+	auto temporary = path;
+	temporary += ".tmp";
+	CHECK(!std::filesystem::exists(temporary));
+
+	IniFile read;
+	CHECK(read.Read(path));
+	CHECK_EQ(4, read.GetInt("Overlay", "Type", 0));
+	CHECK(read.Serialize() == ini.Serialize());
+
+	std::filesystem::remove(path);
+	CHECK(!read.Read(path));
+	CHECK(read.Serialize().empty());
+}
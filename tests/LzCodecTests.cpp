@@ -0,0 +1,184 @@
+// ReSharper disable CppCStyleCast
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "LzCodec.h"
+#include "Test.h"
+
+// Round trips of the LZ4 block codec, and decoding of malformed blocks
+
+static constexpr size_t Guard = 64;
+static constexpr uint8_t GuardByte = 0xA5;
+
+static std::vector<uint8_t> Compress(const std::vector<uint8_t>& data)
+{
+	std::vector<uint8_t> compressed(LzCodec::MaxCompressedSize(data.size()));
+	compressed.resize(LzCodec::Compress(data.data(), data.size(), compressed.data(), compressed.size()));
+	return compressed;
+}
+
+// Decodes into a buffer followed by guard bytes, which must survive any input
+static bool Decompress(const std::vector<uint8_t>& compressed, const size_t size, std::vector<uint8_t>& data)
+{
+	data.assign(size + Guard, GuardByte);
+	const bool result = LzCodec::Decompress(compressed.data(), compressed.size(), data.data(), size);
+
+	for (size_t i = size; i < data.size(); i++)
+	{
+		CHECK_EQ(GuardByte, data[i]);
+	}
+
+	data.resize(size);
+	return result;
+}
+
+static std::vector<uint8_t> MakeText(const size_t size)
+{
+	static const char* const Words[] = { "clipboard ", "overlay ", "ping ", "history ", "the ", "window ", "settings\r\n" };
+
+	std::vector<uint8_t> text;
+	std::mt19937 random(7);
+
+	while (text.size() < size)
+	{
+		const auto word = Words[random() % std::size(Words)];
+		text.insert(text.end(), word, word + strlen(word));
+	}
+
+	text.resize(size);
+	return text;
+}
+
+static std::vector<uint8_t> MakeNoise(const size_t size)
+{
+	std::vector<uint8_t> noise(size);
+	std::mt19937 random(11);
+
+	for (auto& byte : noise)
+	{
+		byte = (uint8_t)random();
+	}
+
+	return noise;
+}
+
+static void CheckRoundTrip(const std::vector<uint8_t>& data)
+{
+	const auto compressed = Compress(data);
+	CHECK(!compressed.empty());
+	CHECK(compressed.size() <= LzCodec::MaxCompressedSize(data.size()));
+
+	std::vector<uint8_t> decompressed;
+	CHECK(Decompress(compressed, data.size(), decompressed));
+	CHECK(decompressed == data);
+}
+
+TEST(RoundTripEverySmallSize)
+{
+	const auto text = MakeText(300);
+	const auto noise = MakeNoise(300);
+
+	for (size_t size = 0; size <= 300; size++)
+	{
+		CheckRoundTrip({ text.begin(), text.begin() + (ptrdiff_t)size });
+		CheckRoundTrip({ noise.begin(), noise.begin() + (ptrdiff_t)size });
+	}
+}
+
+// Long runs need overlapping copies and length bytes over 255, the large text matches across the 64 KB window
+TEST(RoundTripLargeInputs)
+{
+	CheckRoundTrip(std::vector<uint8_t>(100000, 0));
+	CheckRoundTrip(MakeText(300000));
+	CheckRoundTrip(MakeNoise(100000));
+
+	auto mixed = MakeText(100000);
+	const auto noise = MakeNoise(70000);
+	mixed.insert(mixed.begin() + 50000, noise.begin(), noise.end());
+	CheckRoundTrip(mixed);
+}
+
+TEST(TextShrinks)
+{
+	const auto text = MakeText(64 * 1024);
+	CHECK(Compress(text).size() < text.size() / 2);
+}
+
+TEST(CompressFailsWhenTheOutputIsTooSmall)
+{
+	const auto noise = MakeNoise(1000);
+	std::vector<uint8_t> compressed(900);
+	CHECK_EQ(0, LzCodec::Compress(noise.data(), noise.size(), compressed.data(), compressed.size()));
+}
+
+// Blocks written by hand in the LZ4 format: a sequence of literals and a match, then the last literals
+TEST(DecodesLz4Blocks)
+{
+	const std::vector<uint8_t> block = { 0x44, 'a', 'b', 'c', 'd', 0x04, 0x00, 0x50, 'e', 'f', 'g', 'h', 'i' };
+	std::vector<uint8_t> data;
+
+	CHECK(Decompress(block, 17, data));
+	CHECK(std::string(data.begin(), data.end()) == "abcdabcdabcdefghi");
+}
+
+TEST(RejectsWrongSize)
+{
+	const auto text = MakeText(5000);
+	const auto compressed = Compress(text);
+	std::vector<uint8_t> data;
+
+	CHECK(!Decompress(compressed, text.size() - 1, data));
+	CHECK(!Decompress(compressed, text.size() + 1, data));
+}
+
+TEST(RejectsMalformedBlocks)
+{
+	std::vector<uint8_t> data;
+
+	// Offset 0, and an offset reaching before the start of the output
+	CHECK(!Decompress({ 0x44, 'a', 'b', 'c', 'd', 0x00, 0x00, 0x50, 'e', 'f', 'g', 'h', 'i' }, 17, data));
+	CHECK(!Decompress({ 0x44, 'a', 'b', 'c', 'd', 0x05, 0x00, 0x50, 'e', 'f', 'g', 'h', 'i' }, 17, data));
+
+	// Literals running past the end of the input, and a length that never ends
+	CHECK(!Decompress({ 0x90, 'a', 'b' }, 9, data));
+	CHECK(!Decompress({ 0xF0, 0xFF, 0xFF, 0xFF }, 1000, data));
+
+	// No input at all
+	CHECK(!Decompress({}, 1, data));
+}
+
+TEST(TruncatedBlocksAreRejected)
+{
+	const auto text = MakeText(2000);
+	const auto compressed = Compress(text);
+	std::vector<uint8_t> data;
+
+	for (size_t size = 0; size < compressed.size(); size++)
+	{
+		CHECK(!Decompress({ compressed.begin(), compressed.begin() + (ptrdiff_t)size }, text.size(), data));
+	}
+}
+
+// Damaged blocks may still decode to something, but never outside the output buffer
+TEST(CorruptBlocksStayInBounds)
+{
+	const auto text = MakeText(4000);
+	const auto compressed = Compress(text);
+	std::mt19937 random(3);
+	std::vector<uint8_t> data;
+
+	for (int i = 0; i < 5000; i++)
+	{
+		auto corrupt = compressed;
+		const int flips = 1 + (int)(random() % 4);
+
+		for (int flip = 0; flip < flips; flip++)
+		{
+			corrupt[random() % corrupt.size()] ^= (uint8_t)(1 + random() % 255);
+		}
+
+		Decompress(corrupt, text.size(), data);
+	}
+}
@@ -0,0 +1,264 @@
+// ReSharper disable CppCStyleCast
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ContentHasher.h"
+#include "OverlayRenderer.h"
+#include "OverlayType.h"
+#include "Rasterizer.h"
+#include "RenderTarget.h"
+#include "Test.h"
+
+// Golden images of every overlay type, rendered through OverlayRenderer into memory. The golden file
+// holds the XXH64 of each image's pixels; a mismatching image is written next to the test as a PAM
+// file to look at. Set CLIPPING_UPDATE_GOLDEN=1 to rewrite the golden file after an intended change.
+
+struct GoldenSize
+{
+	int32_t width;
+	int32_t height;
+};
+
+// Too small to be a nine-patch, a small window, and a large one that streams its stores
+static constexpr GoldenSize Sizes[] = { { 14, 10 }, { 160, 90 }, { 1920, 1200 } };
+
+static const char* const TypeNames[] = { "Top", "Border", "Aura", "Bottom", "Left", "Right" };
+static const char* const IsaNames[] = { "scalar", "sse2", "avx2" };
+
+// An asymmetric color catches swapped channels (COLORREF, 0x00BBGGRR)
+static constexpr uint32_t Color = 0x002080F0;
+
+struct Image
+{
+	int32_t width = 0;
+	int32_t height = 0;
+	std::vector<uint32_t> pixels;
+
+	uint64_t Hash() const { return ContentHasher::Hash(pixels.data(), pixels.size() * sizeof(uint32_t)); }
+};
+
+static std::string GetName(const OverlayType type, const GoldenSize& size)
+{
+	return std::string(TypeNames[type]) + " " + std::to_string(size.width) + "x" + std::to_string(size.height);
+}
+
+static void Blit(Image& image, const Surface& surface, const int32_t x, const int32_t y)
+{
+	for (int32_t row = 0; row < surface.height; row++)
+	{
+		memcpy(&image.pixels[(size_t)(y + row) * image.width + x], surface.bits + (size_t)row * surface.stride, surface.width * sizeof(uint32_t));
+	}
+}
+
+// Renders the overlay as the overlay window does, whole or as the union of its edge strips
+static Image RenderOverlay(OverlayRenderer& renderer, const OverlayType type, const GoldenSize& size, const bool strips)
+{
+	Image image = { size.width, size.height, std::vector<uint32_t>((size_t)size.width * size.height) };
+	Strip list[Rasterizer::MaxStrips] = { { 0, 0, size.width, size.height } };
+	const auto count = strips ? Rasterizer::GetStrips(type, size.width, size.height, list) : 1;
+
+	for (int32_t i = 0; i < count; i++)
+	{
+		const auto entry = renderer.Render(type, Color, size.width, size.height, list[i], strips ? i : -1);
+		CHECK(entry != nullptr);
+
+		if (entry)
+		{
+			Blit(image, entry->surface, list[i].x, list[i].y);
+		}
+	}
+
+	return image;
+}
+
+// Straight RGBA, readable by most image viewers
+static void WriteImage(const Image& image, const std::string& name)
+{
+	auto fileName = name + ".pam";
+	std::replace(fileName.begin(), fileName.end(), ' ', '-');
+
+	const auto file = fopen(fileName.c_str(), "wb");
+
+	if (!file)
+	{
+		return;
+	}
+
+	fprintf(file, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", image.width, image.height);
+
+	for (const auto pixel : image.pixels)
+	{
+		const uint32_t a = pixel >> 24;
+		const auto straight = [&](const uint32_t channel) { return (uint8_t)(a ? (channel * 255 + a / 2) / a : 0); };
+		const uint8_t rgba[4] = { straight(pixel >> 16 & 0xFF), straight(pixel >> 8 & 0xFF), straight(pixel & 0xFF), (uint8_t)a };
+		fwrite(rgba, 1, sizeof(rgba), file);
+	}
+
+	fclose(file);
+	fprintf(stderr, "wrote %s\n", fileName.c_str());
+}
+
+static std::map<std::string, uint64_t> ReadGolden()
+{
+	std::map<std::string, uint64_t> golden;
+	const auto file = fopen(CLIPPING_GOLDEN_FILE, "r");
+
+	if (!file)
+	{
+		fprintf(stderr, "can't open %s\n", CLIPPING_GOLDEN_FILE);
+		return golden;
+	}
+
+	char type[32];
+	int32_t width;
+	int32_t height;
+	unsigned long long hash;
+
+	while (fscanf(file, "%31s %dx%d %llx", type, &width, &height, &hash) == 4)
+	{
+		golden[std::string(type) + " " + std::to_string(width) + "x" + std::to_string(height)] = hash;
+	}
+
+	fclose(file);
+	return golden;
+}
+
+static void WriteGolden(const std::map<std::string, uint64_t>& golden)
+{
+	const auto file = fopen(CLIPPING_GOLDEN_FILE, "w");
+
+	if (!file)
+	{
+		fprintf(stderr, "can't write %s\n", CLIPPING_GOLDEN_FILE);
+		return;
+	}
+
+	for (int type = 0; type < OverlayMax; type++)
+	{
+		for (const auto& size : Sizes)
+		{
+			fprintf(file, "%s %016llx\n", GetName((OverlayType)type, size).c_str(), (unsigned long long)golden.at(GetName((OverlayType)type, size)));
+		}
+	}
+
+	fclose(file);
+	fprintf(stderr, "updated %s\n", CLIPPING_GOLDEN_FILE);
+}
+
+// The variant tells apart the images of the same overlay rendered in different ways
+static void CheckGolden(const std::map<std::string, uint64_t>& golden, const Image& image, const OverlayType type, const GoldenSize& size, const char* variant)
+{
+	const auto it = golden.find(GetName(type, size));
+	const bool match = it != golden.end() && it->second == image.Hash();
+	const auto name = GetName(type, size) + " " + variant;
+
+	if (!match)
+	{
+		fprintf(stderr, "%s: 0x%016llx doesn't match the golden image\n", name.c_str(), (unsigned long long)image.Hash());
+		WriteImage(image, name);
+	}
+
+	CHECK(match);
+}
+
+TEST(FullWindowMatchesGolden)
+{
+	auto golden = ReadGolden();
+	const bool update = getenv("CLIPPING_UPDATE_GOLDEN") != nullptr;
+
+	for (int type = 0; type < OverlayMax; type++)
+	{
+		for (const auto& size : Sizes)
+		{
+			MemoryRenderTarget target;
+			OverlayRenderer renderer(target, 0);
+			const auto image = RenderOverlay(renderer, (OverlayType)type, size, false);
+
+			if (update)
+			{
+				golden[GetName((OverlayType)type, size)] = image.Hash();
+			}
+			else
+			{
+				CheckGolden(golden, image, (OverlayType)type, size, "full");
+			}
+		}
+	}
+
+	if (update)
+	{
+		WriteGolden(golden);
+	}
+}
+
+TEST(StripsMatchGolden)
+{
+	const auto golden = ReadGolden();
+
+	for (int type = 0; type < OverlayMax; type++)
+	{
+		for (const auto& size : Sizes)
+		{
+			MemoryRenderTarget target;
+			OverlayRenderer renderer(target, 0);
+			const auto image = RenderOverlay(renderer, (OverlayType)type, size, true);
+			CheckGolden(golden, image, (OverlayType)type, size, "strips");
+		}
+	}
+}
+
+// The templates and the cache must give the same pixels as rasterizing the overlay directly
+TEST(RendererMatchesRasterizer)
+{
+	for (int type = 0; type < OverlayMax; type++)
+	{
+		for (const auto& size : Sizes)
+		{
+			MemoryRenderTarget target;
+			OverlayRenderer renderer(target, 0);
+			const auto rendered = RenderOverlay(renderer, (OverlayType)type, size, false);
+			const auto cached = RenderOverlay(renderer, (OverlayType)type, size, false);
+
+			Image direct = { size.width, size.height, std::vector<uint32_t>((size_t)size.width * size.height) };
+			Rasterizer::Render({ direct.pixels.data(), size.width, size.height, size.width }, (OverlayType)type, (uint8_t)Color, (uint8_t)(Color >> 8), (uint8_t)(Color >> 16));
+
+			CHECK(rendered.pixels == direct.pixels);
+			CHECK(cached.pixels == direct.pixels);
+		}
+	}
+}
+
+TEST(EveryIsaMatchesGolden)
+{
+	const auto golden = ReadGolden();
+	const auto isa = Rasterizer::GetIsa();
+
+	for (int requested = Rasterizer::IsaScalar; requested <= Rasterizer::IsaAvx2; requested++)
+	{
+		if (Rasterizer::SetIsa((Rasterizer::Isa)requested) != requested)
+		{
+			printf("%s isn't supported, skipped\n", IsaNames[requested]);
+			continue;
+		}
+
+		Rasterizer::ReleaseCaches();
+
+		for (int type = 0; type < OverlayMax; type++)
+		{
+			for (const auto& size : Sizes)
+			{
+				MemoryRenderTarget target;
+				OverlayRenderer renderer(target, 0);
+				const auto image = RenderOverlay(renderer, (OverlayType)type, size, false);
+				CheckGolden(golden, image, (OverlayType)type, size, IsaNames[requested]);
+			}
+		}
+	}
+
+	Rasterizer::SetIsa(isa);
+}
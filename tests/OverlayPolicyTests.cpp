@@ -0,0 +1,127 @@
+#include "OverlayPolicy.h"
+#include "Test.h"
+
+// The policy with faked foreground windows and monitors
+
+static constexpr ForegroundState::Bounds Monitor = { 0, 0, 1920, 1080 };
+static constexpr ForegroundState::Bounds SecondMonitor = { 1920, -200, 4480, 1240 };
+
+static ForegroundState MakeWindow(const ForegroundState::Bounds& window, const ForegroundState::Bounds& monitor, const bool captioned)
+{
+	ForegroundState state;
+	state.hasWindow = true;
+	state.captioned = captioned;
+	state.window = window;
+	state.monitor = monitor;
+	return state;
+}
+
+TEST(WindowedAppShows)
+{
+	OverlayPolicy policy;
+	const auto decision = policy.Evaluate(MakeWindow({ 100, 100, 1200, 800 }, Monitor, true));
+
+	CHECK(decision.action == OverlayPolicy::ActionShow);
+	CHECK(decision.reason == OverlayPolicy::ReasonNone);
+}
+
+// Borderless fullscreen games and video players cover their monitor without a title bar
+TEST(BorderlessFullscreenIsQuiet)
+{
+	OverlayPolicy policy;
+
+	CHECK(policy.Evaluate(MakeWindow(Monitor, Monitor, false)).reason == OverlayPolicy::ReasonFullscreen);
+	CHECK(policy.Evaluate(MakeWindow({ -8, -8, 1928, 1088 }, Monitor, false)).reason == OverlayPolicy::ReasonFullscreen);
+	CHECK(policy.Evaluate(MakeWindow(SecondMonitor, SecondMonitor, false)).reason == OverlayPolicy::ReasonFullscreen);
+	CHECK_EQ(3, policy.GetStats().fullscreen);
+}
+
+TEST(PartialCoverShows)
+{
+	OverlayPolicy policy;
+
+	// One pixel short on each side in turn
+	CHECK(policy.Evaluate(MakeWindow({ 1, 0, 1920, 1080 }, Monitor, false)).action == OverlayPolicy::ActionShow);
+	CHECK(policy.Evaluate(MakeWindow({ 0, 1, 1920, 1080 }, Monitor, false)).action == OverlayPolicy::ActionShow);
+	CHECK(policy.Evaluate(MakeWindow({ 0, 0, 1919, 1080 }, Monitor, false)).action == OverlayPolicy::ActionShow);
+	CHECK(policy.Evaluate(MakeWindow({ 0, 0, 1920, 1079 }, Monitor, false)).action == OverlayPolicy::ActionShow);
+
+	// Fullscreen on the other monitor
+	CHECK(policy.Evaluate(MakeWindow(Monitor, SecondMonitor, false)).action == OverlayPolicy::ActionShow);
+	CHECK_EQ(0, policy.GetStats().fullscreen);
+}
+
+// A maximized window covers the monitor when the taskbar auto-hides, but keeps its title bar
+TEST(MaximizedWindowShows)
+{
+	OverlayPolicy policy;
+	CHECK(policy.Evaluate(MakeWindow({ -8, -8, 1928, 1088 }, Monitor, true)).action == OverlayPolicy::ActionShow);
+}
+
+TEST(DesktopShows)
+{
+	OverlayPolicy policy;
+	ForegroundState state;
+	CHECK(policy.Evaluate(state).action == OverlayPolicy::ActionShow);
+
+	// A monitor that couldn't be read doesn't count as covered
+	CHECK(policy.Evaluate(MakeWindow(Monitor, {}, false)).action == OverlayPolicy::ActionShow);
+}
+
+TEST(BusyIsQuiet)
+{
+	OverlayPolicy policy;
+	auto state = MakeWindow({ 100, 100, 1200, 800 }, Monitor, true);
+	state.busy = true;
+
+	CHECK(policy.Evaluate(state).reason == OverlayPolicy::ReasonBusy);
+	CHECK_EQ(1, policy.GetStats().busy);
+}
+
+TEST(ProcessListIsQuiet)
+{
+	OverlayPolicy policy;
+	policy.SetProcessList(L" vlc.exe;MPV.exe , ,\tobs64.exe\t");
+	CHECK(policy.HasProcessList());
+
+	auto state = MakeWindow({ 100, 100, 1200, 800 }, Monitor, true);
+
+	state.processName = L"VLC.EXE";
+	CHECK(policy.Evaluate(state).reason == OverlayPolicy::ReasonProcess);
+
+	state.processName = L"mpv.exe";
+	CHECK(policy.Evaluate(state).reason == OverlayPolicy::ReasonProcess);
+
+	state.processName = L"obs64.exe";
+	CHECK(policy.Evaluate(state).reason == OverlayPolicy::ReasonProcess);
+
+	state.processName = L"notepad.exe";
+	CHECK(policy.Evaluate(state).action == OverlayPolicy::ActionShow);
+
+	// Names match whole
+	state.processName = L"vlc.exe.bak";
+	CHECK(policy.Evaluate(state).action == OverlayPolicy::ActionShow);
+
+	CHECK_EQ(3, policy.GetStats().process);
+	CHECK_EQ(5, policy.GetStats().evaluated);
+
+	policy.SetProcessList(L"");
+	CHECK(!policy.HasProcessList());
+}
+
+TEST(ModePicksTheAction)
+{
+	OverlayPolicy policy;
+	const auto state = MakeWindow(Monitor, Monitor, false);
+
+	CHECK(policy.GetMode() == QuietTrayFlash);
+	CHECK(policy.Evaluate(state).action == OverlayPolicy::ActionTrayFlash);
+
+	policy.SetMode(QuietSuppress);
+	CHECK(policy.Evaluate(state).action == OverlayPolicy::ActionSuppress);
+
+	policy.SetMode(QuietOff);
+	const auto decision = policy.Evaluate(state);
+	CHECK(decision.action == OverlayPolicy::ActionShow);
+	CHECK(decision.reason == OverlayPolicy::ReasonNone);
+}
@@ -0,0 +1,110 @@
+#include "PingScheduler.h"
+#include "Test.h"
+
+// The retrigger policies, fed with synthetic timestamps
+
+TEST(UpdateWhenIdleShows)
+{
+	PingScheduler scheduler;
+	scheduler.SetPolicy(RetriggerIgnore, 0);
+
+	CHECK(scheduler.OnEvent(1000, false) == PingScheduler::DecisionShow);
+	CHECK(scheduler.OnEvent(1001, false) == PingScheduler::DecisionShow);
+	CHECK_EQ(2, scheduler.GetStats().received);
+}
+
+TEST(BurstIsCoalesced)
+{
+	PingScheduler scheduler;
+	scheduler.SetPolicy(RetriggerRestart, 50);
+
+	// An application writing several formats in a row
+	CHECK(scheduler.OnEvent(1000, false) == PingScheduler::DecisionShow);
+	CHECK(scheduler.OnEvent(1002, true) == PingScheduler::DecisionNone);
+	CHECK(scheduler.OnEvent(1010, true) == PingScheduler::DecisionNone);
+	CHECK(scheduler.OnEvent(1049, true) == PingScheduler::DecisionNone);
+	CHECK_EQ(3, scheduler.GetStats().merged);
+
+	// The window runs from the accepted update, not from the last one
+	CHECK(scheduler.OnEvent(1050, true) == PingScheduler::DecisionRestart);
+	CHECK_EQ(1, scheduler.GetStats().restarted);
+}
+
+TEST(SteadyStreamStillPings)
+{
+	PingScheduler scheduler;
+	scheduler.SetPolicy(RetriggerIgnore, 100);
+
+	int shown = 0;
+
+	for (uint64_t time = 0; time < 1000; time += 10)
+	{
+		shown += scheduler.OnEvent(time, false) == PingScheduler::DecisionShow ? 1 : 0;
+	}
+
+	CHECK_EQ(10, shown);
+	CHECK_EQ(90, scheduler.GetStats().merged);
+}
+
+TEST(IgnoreDropsUpdatesDuringPing)
+{
+	PingScheduler scheduler;
+	scheduler.SetPolicy(RetriggerIgnore, 0);
+
+	CHECK(scheduler.OnEvent(0, false) == PingScheduler::DecisionShow);
+	CHECK(scheduler.OnEvent(100, true) == PingScheduler::DecisionNone);
+	CHECK(scheduler.OnEvent(200, true) == PingScheduler::DecisionNone);
+	CHECK_EQ(2, scheduler.GetStats().dropped);
+	CHECK(!scheduler.OnAnimationEnded());
+}
+
+TEST(ExtendDuringPing)
+{
+	PingScheduler scheduler;
+	scheduler.SetPolicy(RetriggerExtend, 20);
+
+	CHECK(scheduler.OnEvent(0, false) == PingScheduler::DecisionShow);
+	CHECK(scheduler.OnEvent(10, true) == PingScheduler::DecisionNone);
+	CHECK(scheduler.OnEvent(30, true) == PingScheduler::DecisionExtend);
+	CHECK(scheduler.OnEvent(60, true) == PingScheduler::DecisionExtend);
+	CHECK_EQ(2, scheduler.GetStats().extended);
+	CHECK_EQ(1, scheduler.GetStats().merged);
+}
+
+TEST(QueueKeepsOneFollowUp)
+{
+	PingScheduler scheduler;
+	scheduler.SetPolicy(RetriggerQueue, 0);
+
+	CHECK(scheduler.OnEvent(0, false) == PingScheduler::DecisionShow);
+	CHECK(scheduler.OnEvent(100, true) == PingScheduler::DecisionNone);
+	CHECK(scheduler.OnEvent(150, true) == PingScheduler::DecisionNone);
+	CHECK(scheduler.OnEvent(200, true) == PingScheduler::DecisionNone);
+	CHECK_EQ(1, scheduler.GetStats().queued);
+	CHECK_EQ(2, scheduler.GetStats().merged);
+
+	// The follow-up is played once
+	CHECK(scheduler.OnAnimationEnded());
+	CHECK(!scheduler.OnAnimationEnded());
+
+	CHECK(scheduler.OnEvent(500, true) == PingScheduler::DecisionNone);
+	CHECK_EQ(2, scheduler.GetStats().queued);
+	CHECK(scheduler.OnAnimationEnded());
+}
+
+TEST(PolicyChangeAppliesToNextUpdate)
+{
+	PingScheduler scheduler;
+	scheduler.SetPolicy(RetriggerIgnore, 0);
+
+	CHECK(scheduler.OnEvent(0, false) == PingScheduler::DecisionShow);
+	CHECK(scheduler.OnEvent(10, true) == PingScheduler::DecisionNone);
+
+	scheduler.SetPolicy(RetriggerRestart, 0);
+	CHECK(scheduler.OnEvent(20, true) == PingScheduler::DecisionRestart);
+
+	const auto& stats = scheduler.GetStats();
+	CHECK_EQ(3, stats.received);
+	CHECK_EQ(1, stats.dropped);
+	CHECK_EQ(1, stats.restarted);
+}
@@ -0,0 +1,257 @@
+// ReSharper disable CppCStyleCast
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "OverlayType.h"
+#include "Rasterizer.h"
+#include "Test.h"
+
+// The kernels of every instruction set against the scalar ones, and the overlays against a model of
+// the GDI+ brushes they replace
+
+static const char* const IsaNames[] = { "scalar", "sse2", "avx2" };
+
+static constexpr uint8_t Red = 0xF0;
+static constexpr uint8_t Green = 0x80;
+static constexpr uint8_t Blue = 0x20;
+
+// Odd sizes leave every vector kernel a tail, and the offsets misalign the rows
+struct Region
+{
+	int32_t width;
+	int32_t height;
+	int32_t x;
+	int32_t y;
+	int32_t regionWidth;
+	int32_t regionHeight;
+	int32_t stride;
+};
+
+static constexpr Region Regions[] =
+{
+	{ 1, 1, 0, 0, 1, 1, 1 },
+	{ 3, 2, 0, 0, 3, 2, 5 },
+	{ 17, 9, 0, 0, 17, 9, 17 },
+	{ 33, 31, 1, 3, 29, 27, 31 },
+	{ 70, 45, 5, 0, 61, 45, 67 },
+	{ 257, 130, 0, 7, 257, 120, 263 },
+	{ 640, 480, 13, 11, 600, 450, 603 },
+};
+
+// Runs the render with every supported instruction set and returns the surfaces, the scalar one first
+template <typename Render>
+static std::vector<std::vector<uint32_t>> RenderEveryIsa(const Region& region, const Render& render)
+{
+	const auto isa = Rasterizer::GetIsa();
+	std::vector<std::vector<uint32_t>> results;
+
+	for (int requested = Rasterizer::IsaScalar; requested <= Rasterizer::IsaAvx2; requested++)
+	{
+		if (Rasterizer::SetIsa((Rasterizer::Isa)requested) != requested)
+		{
+			continue;
+		}
+
+		// Garbage in the surface and its padding shows up in the comparison if a kernel misses or overruns
+		Rasterizer::ReleaseCaches();
+		std::vector<uint32_t> pixels((size_t)region.stride * region.regionHeight, 0xDEADBEEF);
+		render(Surface{ pixels.data(), region.regionWidth, region.regionHeight, region.stride });
+		results.push_back(std::move(pixels));
+	}
+
+	Rasterizer::SetIsa(isa);
+	return results;
+}
+
+static void CheckSameAsScalar(const std::vector<std::vector<uint32_t>>& results)
+{
+	for (size_t i = 1; i < results.size(); i++)
+	{
+		const bool same = results[i] == results[0];
+
+		if (!same)
+		{
+			const auto mismatch = std::mismatch(results[0].begin(), results[0].end(), results[i].begin());
+			fprintf(stderr, "%s differs at %td: %08x != %08x\n", IsaNames[i], mismatch.first - results[0].begin(), *mismatch.second, *mismatch.first);
+		}
+
+		CHECK(same);
+	}
+}
+
+TEST(TypesMatchScalar)
+{
+	for (int type = 0; type < OverlayMax; type++)
+	{
+		for (const auto& region : Regions)
+		{
+			CheckSameAsScalar(RenderEveryIsa(region, [&](const Surface& surface)
+			{
+				Rasterizer::RenderRegion(surface, region.x, region.y, region.width, region.height, (OverlayType)type, Red, Green, Blue);
+			}));
+		}
+	}
+}
+
+// Large enough to use the streaming stores
+TEST(StreamingMatchesScalar)
+{
+	const Region region = { 2561, 1441, 0, 0, 2561, 1441, 2563 };
+
+	for (int type = 0; type < OverlayMax; type++)
+	{
+		CheckSameAsScalar(RenderEveryIsa(region, [&](const Surface& surface)
+		{
+			Rasterizer::RenderRegion(surface, region.x, region.y, region.width, region.height, (OverlayType)type, Red, Green, Blue);
+		}));
+	}
+}
+
+// Bands composited over each other run the blending kernels
+TEST(BlendedDrawListMatchesScalar)
+{
+	DrawList list;
+	list.id = 1;
+	list.ops = {
+		{ EdgeTop, 0xFF, 0x00, false, false, 0, 0, 9, 0, 0 },
+		{ EdgeLeft, 0x60, 0x10, true, true, 0x3366CC, 0, 13, 2, 3 },
+		{ EdgeRight, 0x80, 0x80, true, false, 0, 2, 7, 0, 0 },
+		{ EdgeBottom, 0x20, 0xE0, true, true, 0xFFFFFF, 1, 11, 0, 0 },
+	};
+	list.insets = { 9, 11, 13, 7 };
+
+	for (const auto& region : Regions)
+	{
+		CheckSameAsScalar(RenderEveryIsa(region, [&](const Surface& surface)
+		{
+			Rasterizer::RenderRegion(surface, region.x, region.y, region.width, region.height, list, Red, Green, Blue);
+		}));
+	}
+}
+
+// GDI+ fills in straight ARGB with its brushes, and stores the premultiplied pixels rounded. Its
+// LinearGradientBrush samples pixel i of an n pixel gradient at i / n (PixelOffsetModeDefault).
+struct ReferencePixel
+{
+	double a = 0;
+	double r = 0;
+	double g = 0;
+	double b = 0;
+};
+
+class Reference
+{
+public:
+	Reference(const int32_t width, const int32_t height)
+		: _width(width), _height(height), _pixels((size_t)width * height)
+	{
+	}
+
+	// SourceOver, like Graphics::FillRectangle
+	void Fill(const int32_t x, const int32_t y, const int32_t width, const int32_t height, const double alpha0, const double alpha1, const bool vertical)
+	{
+		for (int32_t row = std::max(y, 0); row < std::min(y + height, _height); row++)
+		{
+			for (int32_t column = std::max(x, 0); column < std::min(x + width, _width); column++)
+			{
+				const double t = vertical ? (double)(row - y) / height : (double)(column - x) / width;
+				const double alpha = (alpha0 + (alpha1 - alpha0) * t) / 255.0;
+
+				auto& pixel = _pixels[(size_t)row * _width + column];
+				pixel.a = alpha + pixel.a * (1 - alpha);
+				pixel.r = Red / 255.0 * alpha + pixel.r * (1 - alpha);
+				pixel.g = Green / 255.0 * alpha + pixel.g * (1 - alpha);
+				pixel.b = Blue / 255.0 * alpha + pixel.b * (1 - alpha);
+			}
+		}
+	}
+
+	void Check(const std::vector<uint32_t>& pixels) const
+	{
+		int mismatches = 0;
+
+		for (size_t i = 0; i < _pixels.size(); i++)
+		{
+			const auto& reference = _pixels[i];
+			const double expected[4] = { reference.b, reference.g, reference.r, reference.a };
+			bool match = true;
+
+			for (int channel = 0; channel < 4; channel++)
+			{
+				const int actual = (int)(pixels[i] >> (channel * 8) & 0xFF);
+				match = match && std::abs(actual - (int)std::lround(expected[channel] * 255)) <= 1;
+			}
+
+			if (!match && mismatches++ == 0)
+			{
+				fprintf(stderr, "%dx%d: pixel (%zu, %zu) is %08x\n", _width, _height, i % _width, i / _width, pixels[i]);
+			}
+		}
+
+		CHECK_EQ(0, mismatches);
+	}
+
+private:
+	int32_t _width;
+	int32_t _height;
+	std::vector<ReferencePixel> _pixels;
+};
+
+// The brushes of the GDI+ overlays, the aura aside: it was redesigned as a blurred glow
+static Reference RenderReference(const OverlayType type, const int32_t width, const int32_t height)
+{
+	Reference reference(width, height);
+	const int32_t gradientHeight = std::max(height * Rasterizer::GradientHeightPct / 100, 2);
+	const int32_t gradientWidth = std::max(width * Rasterizer::GradientHeightPct / 100, 2);
+	const int32_t t = Rasterizer::BorderThickness;
+	const double gradient = Rasterizer::GradientAlpha;
+	const double border = Rasterizer::BorderAlpha;
+
+	switch (type)
+	{
+	case OverlayTop:
+		reference.Fill(0, 0, width, gradientHeight, gradient, 0, true);
+		break;
+	case OverlayBottom:
+		reference.Fill(0, height - gradientHeight, width, gradientHeight, 0, gradient, true);
+		break;
+	case OverlayLeft:
+		reference.Fill(0, 0, gradientWidth, height, gradient, 0, false);
+		break;
+	case OverlayRight:
+		reference.Fill(width - gradientWidth, 0, gradientWidth, height, 0, gradient, false);
+		break;
+	case OverlayBorder:
+		reference.Fill(0, 0, width, t, border, border, true);
+		reference.Fill(0, height - t, width, t, border, border, true);
+		reference.Fill(0, t, t, height - 2 * t, border, border, true);
+		reference.Fill(width - t, t, t, height - 2 * t, border, border, true);
+		break;
+	default:
+		break;
+	}
+
+	return reference;
+}
+
+TEST(MatchesGdiPlusWithinOne)
+{
+	static constexpr OverlayType Types[] = { OverlayTop, OverlayBottom, OverlayLeft, OverlayRight, OverlayBorder };
+	static constexpr struct { int32_t width; int32_t height; } Sizes[] = { { 10, 6 }, { 15, 12 }, { 97, 61 }, { 800, 600 }, { 1921, 1081 } };
+
+	for (const auto type : Types)
+	{
+		for (const auto& size : Sizes)
+		{
+			const auto reference = RenderReference(type, size.width, size.height);
+			const Region region = { size.width, size.height, 0, 0, size.width, size.height, size.width };
+
+			for (const auto& pixels : RenderEveryIsa(region, [&](const Surface& surface) { Rasterizer::Render(surface, type, Red, Green, Blue); }))
+			{
+				reference.Check(pixels);
+			}
+		}
+	}
+}
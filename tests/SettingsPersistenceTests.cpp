@@ -0,0 +1,169 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SettingsPersistence.h"
+#include "Test.h"
+
+// SettingsPersistence against a backend that records what it's asked to write
+
+struct FakeStore
+{
+	bool autoStart = false;
+	uint32_t overlayColor = 0;
+	OverlayType overlayType = OverlayTop;
+	std::string overlayStyle;
+
+	std::vector<std::string> writes;
+	int autoStartReads = 0;
+	int flushes = 0;
+};
+
+class FakeBackend final : public PersistenceBackend
+{
+public:
+	explicit FakeBackend(FakeStore& store)
+		: _store(store)
+	{
+	}
+
+	bool ReadAutoStart() override
+	{
+		_store.autoStartReads++;
+		return _store.autoStart;
+	}
+
+	void WriteAutoStart(const bool enable) override
+	{
+		_store.autoStart = enable;
+		_store.writes.emplace_back("AutoStart");
+	}
+
+	void WriteOverlayColor(const uint32_t color) override
+	{
+		_store.overlayColor = color;
+		_store.writes.emplace_back("Color");
+	}
+
+	void WriteOverlayType(const OverlayType type) override
+	{
+		_store.overlayType = type;
+		_store.writes.emplace_back("Type");
+	}
+
+	void WriteOverlayStyle(const std::string_view style) override
+	{
+		_store.overlayStyle = style;
+		_store.writes.emplace_back("Style");
+	}
+
+	void Flush() override
+	{
+		_store.flushes++;
+	}
+
+private:
+	FakeStore& _store;
+};
+
+static const PersistedState Initial = { 0x0000FF, OverlayBorder, "Neon", true };
+
+TEST(UnchangedDialogWritesNothing)
+{
+	FakeStore store;
+	SettingsPersistence persistence(std::make_unique<FakeBackend>(store));
+
+	persistence.Begin(Initial, true);
+	CHECK_EQ(0, persistence.Commit(Initial));
+
+	CHECK(store.writes.empty());
+	CHECK_EQ(0, store.flushes);
+	CHECK_EQ(1, persistence.GetStats().commits);
+	CHECK_EQ(4, persistence.GetStats().skippedWrites);
+}
+
+TEST(OnlyChangedFieldsAreWritten)
+{
+	FakeStore store;
+	SettingsPersistence persistence(std::make_unique<FakeBackend>(store));
+
+	persistence.Begin(Initial, true);
+	auto state = Initial;
+	state.overlayColor = 0x00FF00;
+
+	CHECK_EQ(1, persistence.Commit(state));
+	CHECK(store.writes == std::vector<std::string>{ "Color" });
+	CHECK_EQ(0x00FF00, store.overlayColor);
+	CHECK_EQ(1, store.flushes);
+
+	// The commit becomes the new snapshot
+	state.overlayType = OverlayAura;
+	state.autoStart = false;
+	store.writes.clear();
+
+	CHECK_EQ(2, persistence.Commit(state));
+	CHECK((store.writes == std::vector<std::string>{ "Type", "AutoStart" }));
+	CHECK(store.overlayType == OverlayAura);
+	CHECK(!store.autoStart);
+	CHECK_EQ(2, store.flushes);
+
+	const auto& stats = persistence.GetStats();
+	CHECK_EQ(2, stats.commits);
+	CHECK_EQ(3, stats.writes);
+	CHECK_EQ(5, stats.skippedWrites);
+}
+
+// Picking a built-in type in the dialog clears the custom style, which has to reach the file
+TEST(ClearedStyleIsWritten)
+{
+	FakeStore store;
+	store.overlayStyle = "Neon";
+	SettingsPersistence persistence(std::make_unique<FakeBackend>(store));
+
+	persistence.Begin(Initial, true);
+	auto state = Initial;
+	state.overlayType = OverlayLeft;
+	state.overlayStyle.clear();
+
+	CHECK_EQ(2, persistence.Commit(state));
+	CHECK((store.writes == std::vector<std::string>{ "Type", "Style" }));
+	CHECK(store.overlayType == OverlayLeft);
+	CHECK(store.overlayStyle.empty());
+	CHECK_EQ(1, store.flushes);
+}
+
+TEST(FirstCommitWritesEverything)
+{
+	FakeStore store;
+	SettingsPersistence persistence(std::make_unique<FakeBackend>(store));
+
+	persistence.Begin(Initial, false);
+	CHECK_EQ(4, persistence.Commit(Initial));
+	CHECK_EQ(4, store.writes.size());
+	CHECK_EQ(1, store.flushes);
+
+	persistence.Begin(Initial, true);
+	CHECK_EQ(0, persistence.Commit(Initial));
+	CHECK_EQ(4, store.writes.size());
+}
+
+TEST(AutoStartIsReadOnce)
+{
+	FakeStore store;
+	store.autoStart = true;
+	SettingsPersistence persistence(std::make_unique<FakeBackend>(store));
+
+	CHECK(persistence.GetAutoStart());
+	CHECK(persistence.GetAutoStart());
+	CHECK_EQ(1, store.autoStartReads);
+	CHECK_EQ(1, persistence.GetStats().autoStartReads);
+
+	// Then tracked from the commits
+	persistence.Begin(Initial, true);
+	auto state = Initial;
+	state.autoStart = false;
+	persistence.Commit(state);
+
+	CHECK(!persistence.GetAutoStart());
+	CHECK_EQ(1, store.autoStartReads);
+}
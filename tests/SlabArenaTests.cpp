@@ -0,0 +1,172 @@
+// ReSharper disable CppCStyleCast
+#include <cstring>
+#include <vector>
+
+#include "SlabArena.h"
+#include "Test.h"
+
+// The size classes, page reuse and footprint accounting of the slab arena
+
+TEST(SizeClasses)
+{
+	SlabArena arena;
+
+	const size_t sizes[] = { 0, 1, 64, 65, 1000, 1024, 1025, SlabArena::PageSize };
+	const size_t capacities[] = { 64, 64, 64, 128, 1024, 1024, 2048, SlabArena::PageSize };
+
+	std::vector<SlabArena::Block> blocks;
+
+	for (size_t i = 0; i < std::size(sizes); i++)
+	{
+		const auto block = arena.Allocate(sizes[i]);
+		CHECK(block.data != nullptr);
+		CHECK_EQ(capacities[i], block.size);
+		blocks.push_back(block);
+	}
+
+	// One page per class: 64, 128, 1024, 2048 and 64 KB
+	CHECK_EQ(5 * SlabArena::PageSize, arena.GetFootprint());
+
+	for (const auto& block : blocks)
+	{
+		arena.Free(block);
+	}
+
+	CHECK_EQ(0, arena.GetFootprint());
+}
+
+TEST(LargeBlocksAreExact)
+{
+	SlabArena arena;
+	const size_t size = SlabArena::PageSize + 1;
+
+	CHECK_EQ(size, arena.GetCost(size));
+
+	const auto block = arena.Allocate(size);
+	CHECK(block.data != nullptr);
+	CHECK_EQ(size, block.size);
+	CHECK_EQ(size, arena.GetFootprint());
+
+	arena.Free(block);
+	CHECK_EQ(0, arena.GetFootprint());
+}
+
+TEST(CostFollowsPartialPages)
+{
+	SlabArena arena;
+	CHECK_EQ(SlabArena::PageSize, arena.GetCost(100));
+
+	const auto block = arena.Allocate(100);
+	CHECK_EQ(0, arena.GetCost(100));
+	CHECK_EQ(0, arena.GetCost(128));
+	CHECK_EQ(SlabArena::PageSize, arena.GetCost(129));
+
+	arena.Free(block);
+	CHECK_EQ(SlabArena::PageSize, arena.GetCost(100));
+}
+
+// A full page comes back into use when one of its blocks is freed, and is released with its last block
+TEST(PagesAreReusedAndReleased)
+{
+	SlabArena arena;
+	const size_t perPage = SlabArena::PageSize / 256;
+	std::vector<SlabArena::Block> blocks;
+
+	for (size_t i = 0; i < perPage; i++)
+	{
+		blocks.push_back(arena.Allocate(256));
+	}
+
+	CHECK_EQ(SlabArena::PageSize, arena.GetFootprint());
+	CHECK_EQ(SlabArena::PageSize, arena.GetCost(256));
+
+	const auto extra = arena.Allocate(256);
+	CHECK_EQ(2 * SlabArena::PageSize, arena.GetFootprint());
+	arena.Free(extra);
+	CHECK_EQ(SlabArena::PageSize, arena.GetFootprint());
+
+	const auto freed = blocks[perPage / 2];
+	arena.Free(freed);
+	CHECK_EQ(0, arena.GetCost(256));
+
+	const auto reused = arena.Allocate(256);
+	CHECK(reused.data == freed.data);
+	blocks[perPage / 2] = reused;
+	CHECK_EQ(SlabArena::PageSize, arena.GetFootprint());
+
+	for (const auto& block : blocks)
+	{
+		arena.Free(block);
+	}
+
+	CHECK_EQ(0, arena.GetFootprint());
+}
+
+// Single-slot pages go from full to empty without ever being partial
+TEST(SingleSlotPages)
+{
+	SlabArena arena;
+	const auto first = arena.Allocate(SlabArena::PageSize);
+	const auto second = arena.Allocate(SlabArena::PageSize);
+
+	CHECK(first.data != second.data);
+	CHECK_EQ(2 * SlabArena::PageSize, arena.GetFootprint());
+
+	arena.Free(first);
+	arena.Free(second);
+	CHECK_EQ(0, arena.GetFootprint());
+
+	const auto again = arena.Allocate(SlabArena::PageSize);
+	CHECK_EQ(SlabArena::PageSize, arena.GetFootprint());
+	arena.Free(again);
+}
+
+// Live blocks never overlap, through a mix of allocations and frees
+TEST(BlocksKeepTheirContent)
+{
+	SlabArena arena;
+	std::vector<SlabArena::Block> blocks;
+	std::vector<uint8_t> fills;
+	uint32_t seed = 1;
+
+	for (int i = 0; i < 4000; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+
+		if (!blocks.empty() && (seed >> 16) % 3 == 0)
+		{
+			const auto index = (seed >> 8) % blocks.size();
+			const auto& block = blocks[index];
+
+			for (uint32_t j = 0; j < block.size; j++)
+			{
+				CHECK_EQ(fills[index], block.data[j]);
+			}
+
+			arena.Free(block);
+			blocks[index] = blocks.back();
+			fills[index] = fills.back();
+			blocks.pop_back();
+			fills.pop_back();
+			continue;
+		}
+
+		const auto block = arena.Allocate((seed >> 12) % 5000);
+		CHECK(block.data != nullptr);
+		memset(block.data, (uint8_t)i, block.size);
+		blocks.push_back(block);
+		fills.push_back((uint8_t)i);
+	}
+
+	for (size_t i = 0; i < blocks.size(); i++)
+	{
+		for (uint32_t j = 0; j < blocks[i].size; j++)
+		{
+			CHECK_EQ(fills[i], blocks[i].data[j]);
+		}
+
+		arena.Free(blocks[i]);
+	}
+
+	CHECK_EQ(0, arena.GetFootprint());
+}
@@ -0,0 +1,57 @@
+// ReSharper disable CppCStyleCast
+#include "Test.h"
+
+#include <cstring>
+#include <vector>
+
+struct TestCase
+{
+	const char* name;
+	TestFunc func;
+};
+
+static std::vector<TestCase>& GetTests()
+{
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+static int s_failures = 0;
+
+TestRegistration::TestRegistration(const char* name, const TestFunc func)
+{
+	GetTests().push_back({ name, func });
+}
+
+void ReportFailure(const char* file, const int line, const char* expression)
+{
+	fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+	s_failures++;
+}
+
+// Runs every test, or those whose name contains the argument
+int main(const int argc, char** argv)
+{
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+	int failedTests = 0;
+	int ranTests = 0;
+
+	for (const auto& test : GetTests())
+	{
+		if (filter && !strstr(test.name, filter))
+		{
+			continue;
+		}
+
+		const int failures = s_failures;
+		test.func();
+		ranTests++;
+
+		const bool failed = s_failures != failures;
+		failedTests += failed ? 1 : 0;
+		printf("[%s] %s\n", failed ? "FAIL" : " OK ", test.name);
+	}
+
+	printf("%d of %d tests passed\n", ranTests - failedTests, ranTests);
+	return failedTests == 0 && ranTests > 0 ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+// A minimal test runner: each test executable registers its cases with TEST and fails with CHECK.
+// A failed check reports itself and lets the case continue, so one run shows every mismatch.
+
+using TestFunc = void (*)();
+
+struct TestRegistration
+{
+	TestRegistration(const char* name, TestFunc func);
+};
+
+void ReportFailure(const char* file, int line, const char* expression);
+
+#define TEST(name) \
+	static void name(); \
+	static const TestRegistration name##Registration(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			ReportFailure(__FILE__, __LINE__, #condition); \
+		} \
+	} while (false)
+
+// Compares as 64-bit integers, which covers the pixels, sizes and hashes the tests deal with
+#define CHECK_EQ(expected, actual) \
+	do \
+	{ \
+		const auto checkExpected = (expected); \
+		const auto checkActual = (actual); \
+		if (!(checkExpected == checkActual)) \
+		{ \
+			char checkMessage[160]; \
+			snprintf(checkMessage, sizeof(checkMessage), "%s == %s (0x%llx != 0x%llx)", #expected, #actual, (unsigned long long)(uint64_t)checkExpected, (unsigned long long)(uint64_t)checkActual); \
+			ReportFailure(__FILE__, __LINE__, checkMessage); \
+		} \
+	} while (false)
@@ -0,0 +1,214 @@
+// ReSharper disable CppCStyleCast
+#include <cstdlib>
+#include <vector>
+
+#include "OverlayRenderer.h"
+#include "OverlayType.h"
+#include "Rasterizer.h"
+#include "RenderTarget.h"
+#include "Test.h"
+
+// Coverage masks tinted per color against the overlays rendered directly in that color
+
+struct Color
+{
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+};
+
+static constexpr Color Colors[] = { { 0, 0, 0 }, { 255, 255, 255 }, { 255, 0, 0 }, { 0x20, 0x80, 0xF0 }, { 0x7F, 0x80, 0x81 }, { 1, 254, 3 } };
+
+static const char* const IsaNames[] = { "scalar", "sse2", "avx2" };
+
+static std::vector<uint32_t> RenderDirect(const OverlayType type, const int32_t width, const int32_t height, const Color& color)
+{
+	std::vector<uint32_t> pixels((size_t)width * height);
+	Rasterizer::Render({ pixels.data(), width, height, width }, type, color.r, color.g, color.b);
+	return pixels;
+}
+
+static std::vector<uint32_t> RenderTinted(const OverlayType type, const int32_t width, const int32_t height, const Color& color)
+{
+	std::vector<uint8_t> coverage((size_t)width * height);
+	const auto white = RenderDirect(type, width, height, { 0xFF, 0xFF, 0xFF });
+	Rasterizer::ExtractCoverage({ (uint32_t*)white.data(), width, height, width }, coverage.data(), width);
+
+	std::vector<uint32_t> pixels((size_t)width * height);
+	Rasterizer::Tint({ pixels.data(), width, height, width }, coverage.data(), width, color.r, color.g, color.b);
+	return pixels;
+}
+
+// The built-in styles paint every pixel as the color times its alpha, so tinting is exact
+TEST(TintedMatchesDirectRender)
+{
+	const auto isa = Rasterizer::GetIsa();
+
+	for (int requested = Rasterizer::IsaScalar; requested <= Rasterizer::IsaAvx2; requested++)
+	{
+		if (Rasterizer::SetIsa((Rasterizer::Isa)requested) != requested)
+		{
+			continue;
+		}
+
+		Rasterizer::ReleaseCaches();
+
+		for (int type = 0; type < OverlayMax; type++)
+		{
+			for (const auto& color : Colors)
+			{
+				const bool same = RenderTinted((OverlayType)type, 203, 117, color) == RenderDirect((OverlayType)type, 203, 117, color);
+
+				if (!same)
+				{
+					fprintf(stderr, "%s, type %d, color %02x%02x%02x\n", IsaNames[requested], type, color.r, color.g, color.b);
+				}
+
+				CHECK(same);
+			}
+		}
+	}
+
+	Rasterizer::SetIsa(isa);
+}
+
+// The direct render rounds once more for every band blended over the others, the tinted mask only once
+TEST(TintedDrawListWithinRounding)
+{
+	DrawList list;
+	list.id = 1;
+	list.ops = {
+		{ EdgeTop, 0xFF, 0x00, false, false, 0, 0, 9, 0, 0 },
+		{ EdgeLeft, 0x60, 0x10, true, false, 0, 0, 13, 2, 3 },
+		{ EdgeTop, 0x80, 0x40, true, false, 0, 3, 20, 0, 0 },
+		{ EdgeBottom, 0x20, 0xE0, true, false, 0, 1, 11, 0, 0 },
+	};
+
+	int tolerance = 0;
+
+	for (const auto& op : list.ops)
+	{
+		tolerance += op.blend ? 1 : 0;
+	}
+
+	const int32_t width = 97;
+	const int32_t height = 61;
+	std::vector<uint32_t> white((size_t)width * height);
+	std::vector<uint8_t> coverage((size_t)width * height);
+	Rasterizer::RenderRegion({ white.data(), width, height, width }, 0, 0, width, height, list, 0xFF, 0xFF, 0xFF);
+	Rasterizer::ExtractCoverage({ white.data(), width, height, width }, coverage.data(), width);
+
+	for (const auto& color : Colors)
+	{
+		std::vector<uint32_t> direct((size_t)width * height);
+		std::vector<uint32_t> tinted((size_t)width * height);
+		Rasterizer::RenderRegion({ direct.data(), width, height, width }, 0, 0, width, height, list, color.r, color.g, color.b);
+		Rasterizer::Tint({ tinted.data(), width, height, width }, coverage.data(), width, color.r, color.g, color.b);
+
+		int mismatches = 0;
+
+		for (size_t i = 0; i < direct.size(); i++)
+		{
+			for (int shift = 0; shift < 32; shift += 8)
+			{
+				mismatches += abs((int)(direct[i] >> shift & 0xFF) - (int)(tinted[i] >> shift & 0xFF)) > tolerance ? 1 : 0;
+			}
+		}
+
+		CHECK_EQ(0, mismatches);
+	}
+}
+
+TEST(CoverageIsTheAlpha)
+{
+	const int32_t width = 37;
+	const int32_t height = 3;
+	const int32_t stride = 41;
+	std::vector<uint32_t> pixels((size_t)stride * height);
+
+	for (size_t i = 0; i < pixels.size(); i++)
+	{
+		pixels[i] = (uint32_t)(i * 7 % 256) << 24 | 0x00123456;
+	}
+
+	const int32_t coverageStride = 40;
+	std::vector<uint8_t> coverage((size_t)coverageStride * height, 0xEE);
+	Rasterizer::ExtractCoverage({ pixels.data(), width, height, stride }, coverage.data(), coverageStride);
+
+	for (int32_t y = 0; y < height; y++)
+	{
+		for (int32_t x = 0; x < coverageStride; x++)
+		{
+			const uint8_t expected = x < width ? (uint8_t)(pixels[(size_t)y * stride + x] >> 24) : 0xEE;
+			CHECK_EQ(expected, coverage[(size_t)y * coverageStride + x]);
+		}
+	}
+}
+
+// Every ISA, at every alignment and tail length, with the padding left alone
+TEST(TintMatchesScalar)
+{
+	const auto isa = Rasterizer::GetIsa();
+	std::vector<uint8_t> coverage(300);
+
+	for (size_t i = 0; i < coverage.size(); i++)
+	{
+		coverage[i] = (uint8_t)(i * 37 + i / 7);
+	}
+
+	for (int32_t offset = 0; offset < 8; offset++)
+	{
+		for (int32_t width = 1; width < 70; width++)
+		{
+			std::vector<uint32_t> expected;
+
+			for (int requested = Rasterizer::IsaScalar; requested <= Rasterizer::IsaAvx2; requested++)
+			{
+				if (Rasterizer::SetIsa((Rasterizer::Isa)requested) != requested)
+				{
+					continue;
+				}
+
+				std::vector<uint32_t> pixels(80, 0xDEADBEEF);
+				Rasterizer::Tint({ pixels.data() + offset, width, 1, width }, coverage.data() + offset, width, 0x20, 0x80, 0xF0);
+
+				if (expected.empty())
+				{
+					expected = pixels;
+				}
+
+				CHECK(pixels == expected);
+			}
+		}
+	}
+
+	Rasterizer::SetIsa(isa);
+}
+
+// Switching colors reuses the mask, the surfaces must still match the direct render
+TEST(RendererTintsEachColor)
+{
+	MemoryRenderTarget target;
+	OverlayRenderer renderer(target, 0);
+	const int32_t width = 640;
+	const int32_t height = 400;
+	const Strip strip = { 0, 0, width, height };
+
+	for (int type = 0; type < OverlayMax; type++)
+	{
+		for (const auto& color : Colors)
+		{
+			const uint32_t colorRef = color.r | color.g << 8 | color.b << 16;
+			const auto entry = renderer.Render((OverlayType)type, colorRef, width, height, strip, -1);
+			CHECK(entry != nullptr);
+
+			if (entry)
+			{
+				const auto direct = RenderDirect((OverlayType)type, width, height, color);
+				CHECK(std::vector<uint32_t>(entry->surface.bits, entry->surface.bits + (size_t)width * height) == direct);
+			}
+		}
+	}
+
+	CHECK(renderer.GetTemplateBytes() > 0);
+}
@@ -0,0 +1,223 @@
+// ReSharper disable CppCStyleCast
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Test.h"
+#include "Trace.h"
+
+// The latency histogram buckets and percentiles, and the span ring buffer
+
+// The buckets cover every value, in order, and each one is at most 1/8 wider than its lower bound
+TEST(BucketEdges)
+{
+	for (uint64_t ns = 0; ns < 16; ns++)
+	{
+		CHECK_EQ(ns, LatencyHistogram::BucketIndex(ns));
+		CHECK_EQ(ns, LatencyHistogram::BucketLowerBound((size_t)ns));
+	}
+
+	const auto last = LatencyHistogram::BucketIndex(UINT64_MAX);
+
+	for (size_t index = 16; index <= last; index++)
+	{
+		const auto lower = LatencyHistogram::BucketLowerBound(index);
+		const auto previous = LatencyHistogram::BucketLowerBound(index - 1);
+
+		CHECK(lower > previous);
+		CHECK_EQ(index, LatencyHistogram::BucketIndex(lower));
+		CHECK_EQ(index - 1, LatencyHistogram::BucketIndex(lower - 1));
+		CHECK((lower - previous) * 8 <= previous);
+	}
+
+	CHECK_EQ(last, LatencyHistogram::BucketIndex(LatencyHistogram::BucketLowerBound(last) + 1));
+	CHECK(LatencyHistogram::BucketLowerBound(last) > UINT64_MAX / 16 * 15);
+}
+
+TEST(Percentiles)
+{
+	LatencyHistogram empty;
+	CHECK_EQ(0, empty.GetCount());
+	CHECK_EQ(0, empty.GetPercentile(50));
+
+	// Exact below 16
+	LatencyHistogram small;
+	small.Record(5);
+	small.Record(5);
+	small.Record(9);
+	CHECK_EQ(5, small.GetPercentile(50));
+	CHECK_EQ(9, small.GetPercentile(100));
+	CHECK_EQ(5, small.GetPercentile(0));
+
+	LatencyHistogram histogram;
+
+	for (uint64_t ns = 1; ns <= 10000; ns++)
+	{
+		histogram.Record(ns * 1000);
+	}
+
+	CHECK_EQ(10000, histogram.GetCount());
+	CHECK_EQ(10000000, histogram.GetMax());
+	CHECK_EQ(50005000ull * 1000, histogram.GetTotal());
+
+	const double percentiles[] = { 1, 50, 90, 99, 99.9 };
+
+	for (const auto percentile : percentiles)
+	{
+		const auto expected = percentile * 100000.0;
+		const auto actual = (double)histogram.GetPercentile(percentile);
+		CHECK(actual >= expected * 0.875 && actual <= expected * 1.125);
+	}
+
+	const auto top = histogram.GetPercentile(100);
+	CHECK_EQ(LatencyHistogram::BucketIndex(10000000), LatencyHistogram::BucketIndex(top));
+
+	// The midpoint of a bucket is capped to the maximum
+	LatencyHistogram single;
+	single.Record(960);
+	CHECK_EQ(960, LatencyHistogram::BucketLowerBound(LatencyHistogram::BucketIndex(960)));
+	CHECK_EQ(960, single.GetPercentile(50));
+}
+
+TEST(HistogramsAreMerged)
+{
+	LatencyHistogram first;
+	LatencyHistogram second;
+	first.Record(100);
+	first.Record(20000);
+	second.Record(300);
+
+	LatencyHistogram merged;
+	merged.Add(first);
+	merged.Add(second);
+
+	CHECK_EQ(3, merged.GetCount());
+	CHECK_EQ(20400, merged.GetTotal());
+	CHECK_EQ(20000, merged.GetMax());
+
+	const auto median = merged.GetPercentile(50);
+	CHECK_EQ(LatencyHistogram::BucketIndex(300), LatencyHistogram::BucketIndex(median));
+}
+
+TEST(EventsOldestFirst)
+{
+	const auto tracer = std::make_unique<Tracer>();
+	CHECK(tracer->GetEvents().empty());
+
+	for (int64_t i = 0; i < 100; i++)
+	{
+		tracer->Record((TraceSpan)(i % SpanMax), i * 10, i * 10 + i);
+	}
+
+	// A span that ends before it starts is recorded as instant
+	tracer->Record(SpanShow, 2000, 1000);
+
+	const auto events = tracer->GetEvents();
+	CHECK_EQ(101, events.size());
+
+	for (int64_t i = 0; i < 100; i++)
+	{
+		CHECK_EQ(i * 10, events[(size_t)i].start);
+		CHECK_EQ(i, events[(size_t)i].duration);
+		CHECK_EQ(i % SpanMax, events[(size_t)i].span);
+		CHECK_EQ(events[0].thread, events[(size_t)i].thread);
+	}
+
+	CHECK_EQ(0, events.back().duration);
+}
+
+// Past the capacity, the ring buffer keeps the most recent events and the histograms keep counting
+TEST(RingWrapsAround)
+{
+	const auto tracer = std::make_unique<Tracer>();
+	const int64_t total = Tracer::Capacity * 2 + 100;
+
+	for (int64_t i = 0; i < total; i++)
+	{
+		tracer->Record(SpanFrame, i, i + 5);
+	}
+
+	const auto events = tracer->GetEvents();
+	CHECK_EQ(Tracer::Capacity, events.size());
+
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		CHECK_EQ(total - (int64_t)Tracer::Capacity + (int64_t)i, events[i].start);
+	}
+
+	LatencyHistogram histogram;
+	tracer->GetHistogram(SpanFrame, histogram);
+	CHECK_EQ(total, histogram.GetCount());
+	CHECK_EQ(total * 5, histogram.GetTotal());
+}
+
+// Each thread records into histograms of its own, which are merged when read
+TEST(HistogramsPerThread)
+{
+	const auto tracer = std::make_unique<Tracer>();
+	constexpr int Threads = 4;
+	constexpr int Spans = 1000;
+
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < Threads; t++)
+	{
+		threads.emplace_back([&, t]
+		{
+			for (int i = 0; i < Spans; i++)
+			{
+				tracer->Record(SpanHandoff, 0, 100 + t);
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+
+	LatencyHistogram histogram;
+	tracer->GetHistogram(SpanHandoff, histogram);
+	CHECK_EQ(Threads * Spans, histogram.GetCount());
+	CHECK_EQ(Spans * (100 + 101 + 102 + 103), histogram.GetTotal());
+	CHECK_EQ(103, histogram.GetMax());
+
+	LatencyHistogram other;
+	tracer->GetHistogram(SpanShow, other);
+	CHECK_EQ(0, other.GetCount());
+}
+
+// The per-thread cache must not hand out the histograms of a destroyed tracer to one at the same address
+TEST(TracersDontShareHistograms)
+{
+	auto tracer = std::make_unique<Tracer>();
+	tracer->Record(SpanHandoff, 0, 1);
+	tracer.reset();
+
+	for (int i = 0; i < 3; i++)
+	{
+		tracer = std::make_unique<Tracer>();
+		tracer->Record(SpanHandoff, 0, 1);
+
+		LatencyHistogram histogram;
+		tracer->GetHistogram(SpanHandoff, histogram);
+		CHECK_EQ(1, histogram.GetCount());
+	}
+}
+
+TEST(ScopedSpanRecords)
+{
+	const auto tracer = std::make_unique<Tracer>();
+	const auto before = Tracer::Now();
+
+	{
+		ScopedSpan span(SpanRenderSurface, *tracer);
+	}
+
+	const auto events = tracer->GetEvents();
+	CHECK_EQ(1, events.size());
+	CHECK(events[0].span == SpanRenderSurface);
+	CHECK(events[0].start >= before);
+	CHECK(events[0].start + events[0].duration <= Tracer::Now());
+}
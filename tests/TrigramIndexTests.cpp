@@ -0,0 +1,269 @@
+// ReSharper disable CppCStyleCast
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Test.h"
+#include "TrigramIndex.h"
+
+// The index against a brute-force search over the same documents
+
+class BruteForce
+{
+public:
+	void Add(const uint64_t id, const std::u16string_view text)
+	{
+		if (Find(id) != _documents.end())
+		{
+			Touch(id);
+			return;
+		}
+
+		_documents.push_back({ id, Fold(text.substr(0, std::min(text.find(u'\0'), TrigramIndex::MaxIndexedChars))) });
+	}
+
+	void Touch(const uint64_t id)
+	{
+		const auto it = Find(id);
+
+		if (it != _documents.end())
+		{
+			std::rotate(it, it + 1, _documents.end());
+		}
+	}
+
+	void Remove(const uint64_t id)
+	{
+		const auto it = Find(id);
+
+		if (it != _documents.end())
+		{
+			_documents.erase(it);
+		}
+	}
+
+	void Clear() { _documents.clear(); }
+
+	std::vector<uint64_t> Search(const std::u16string_view query, const TrigramIndex::QueryMode mode, const size_t limit) const
+	{
+		const auto folded = Fold(query);
+		std::vector<uint64_t> results;
+
+		for (auto it = _documents.rbegin(); it != _documents.rend() && results.size() < limit; ++it)
+		{
+			const std::u16string_view text = it->second;
+
+			if (mode == TrigramIndex::QueryPrefix ? text.substr(0, folded.size()) == folded : text.find(folded) != std::u16string_view::npos)
+			{
+				results.push_back(it->first);
+			}
+		}
+
+		return results;
+	}
+
+	size_t GetCount() const { return _documents.size(); }
+	const std::u16string& GetText(const size_t index) const { return _documents[index].second; }
+
+private:
+	static std::u16string Fold(const std::u16string_view text)
+	{
+		std::u16string folded(text);
+
+		for (auto& c : folded)
+		{
+			c = c >= u'A' && c <= u'Z' ? (char16_t)(c + (u'a' - u'A')) : c;
+		}
+
+		return folded;
+	}
+
+	std::vector<std::pair<uint64_t, std::u16string>>::iterator Find(const uint64_t id)
+	{
+		return std::find_if(_documents.begin(), _documents.end(), [&](const auto& document) { return document.first == id; });
+	}
+
+	std::vector<std::pair<uint64_t, std::u16string>> _documents; // Oldest first
+};
+
+// A small alphabet, so that queries of every length have matches, with some case and non-ASCII characters
+static std::u16string MakeText(std::mt19937& random, const size_t length)
+{
+	static constexpr char16_t Alphabet[] = u"abcaAB xé中";
+
+	std::u16string text(length, u' ');
+
+	for (auto& c : text)
+	{
+		c = Alphabet[random() % (std::size(Alphabet) - 1)];
+	}
+
+	return text;
+}
+
+static void CheckSearches(const TrigramIndex& index, const BruteForce& model, std::mt19937& random, const int count)
+{
+	static constexpr size_t Limits[] = { 1, 5, SIZE_MAX };
+
+	CHECK_EQ(model.GetCount(), index.GetCount());
+
+	for (int i = 0; i < count; i++)
+	{
+		std::u16string query;
+
+		// Half of the queries are cut from a document, with the case flipped, so they match something
+		if (model.GetCount() > 0 && random() % 2 == 0)
+		{
+			const auto& text = model.GetText(random() % model.GetCount());
+			const size_t start = text.empty() ? 0 : random() % text.size();
+			query = text.substr(start, random() % 8);
+
+			for (auto& c : query)
+			{
+				c = c >= u'a' && c <= u'z' && random() % 2 ? (char16_t)(c - (u'a' - u'A')) : c;
+			}
+		}
+		else
+		{
+			query = MakeText(random, random() % 6);
+		}
+
+		const auto mode = random() % 2 ? TrigramIndex::QuerySubstring : TrigramIndex::QueryPrefix;
+		const auto limit = Limits[random() % std::size(Limits)];
+
+		std::vector<uint64_t> results;
+		index.Search(query, mode, limit, results);
+		CHECK(results == model.Search(query, mode, limit));
+	}
+}
+
+TEST(RandomOperationsMatchBruteForce)
+{
+	std::mt19937 random(5);
+	TrigramIndex index;
+	BruteForce model;
+
+	for (int step = 0; step < 4000; step++)
+	{
+		const uint64_t id = random() % 300;
+
+		switch (random() % 10)
+		{
+		case 0:
+		case 1:
+			index.Touch(id);
+			model.Touch(id);
+			break;
+		case 2:
+		case 3:
+			index.Remove(id);
+			model.Remove(id);
+			break;
+		default:
+		{
+			const auto text = MakeText(random, random() % 40);
+			index.Add(id, text);
+			model.Add(id, text);
+			break;
+		}
+		}
+
+		if (step % 50 == 0)
+		{
+			CheckSearches(index, model, random, 20);
+		}
+	}
+
+	index.Clear();
+	model.Clear();
+	CheckSearches(index, model, random, 20);
+}
+
+// Enough removals to compact the posting lists
+TEST(CompactionKeepsResults)
+{
+	std::mt19937 random(9);
+	TrigramIndex index;
+	BruteForce model;
+
+	for (uint64_t id = 0; id < 3000; id++)
+	{
+		const auto text = MakeText(random, 100);
+		index.Add(id, text);
+		model.Add(id, text);
+	}
+
+	for (uint64_t id = 0; id < 3000; id++)
+	{
+		if (id % 5 != 0)
+		{
+			index.Remove(id);
+			model.Remove(id);
+		}
+	}
+
+	CheckSearches(index, model, random, 300);
+
+	for (uint64_t id = 3000; id < 3500; id++)
+	{
+		const auto text = MakeText(random, 100);
+		index.Add(id, text);
+		model.Add(id, text);
+	}
+
+	CheckSearches(index, model, random, 300);
+}
+
+TEST(OnlyTheStartOfLongDocumentsIsIndexed)
+{
+	TrigramIndex index;
+	std::u16string text(TrigramIndex::MaxIndexedChars, u'a');
+	text += u"needle";
+	index.Add(1, text);
+	index.Add(2, u"Needle in front");
+
+	std::vector<uint64_t> results;
+	index.Search(u"needle", TrigramIndex::QuerySubstring, SIZE_MAX, results);
+	CHECK(results == std::vector<uint64_t>{ 2 });
+}
+
+TEST(TextEndsAtNul)
+{
+	TrigramIndex index;
+	index.Add(1, std::u16string_view(u"visible\0hidden", 14));
+
+	std::vector<uint64_t> results;
+	index.Search(u"hidden", TrigramIndex::QuerySubstring, SIZE_MAX, results);
+	CHECK(results.empty());
+
+	index.Search(u"VISIBLE", TrigramIndex::QueryPrefix, SIZE_MAX, results);
+	CHECK(results == std::vector<uint64_t>{ 1 });
+}
+
+TEST(WidenReadsLatin1)
+{
+	CHECK(TrigramIndex::Widen("caf\xE9") == u"café");
+	CHECK(TrigramIndex::Widen(std::string_view("ab\0cd", 5)) == u"ab");
+}
+
+// A touched document is indexed again, its text must only be counted once
+TEST(TouchDoesNotGrowTheTextBytes)
+{
+	std::mt19937 random(1);
+	TrigramIndex index;
+	const auto text = MakeText(random, 4000);
+	index.Add(1, text);
+	index.Add(2, u"short");
+
+	const auto usage = index.GetMemoryUsage();
+
+	for (int i = 0; i < 10; i++)
+	{
+		index.Touch(1);
+		index.Touch(2);
+	}
+
+	// Each touch only leaves a dead slot behind until the next compaction
+	CHECK(index.GetMemoryUsage() - usage < text.size() * sizeof(char16_t));
+}
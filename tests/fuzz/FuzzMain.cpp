@@ -0,0 +1,82 @@
+// ReSharper disable CppCStyleCast
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+// Stands in for libFuzzer where it isn't available: replays the files given as arguments, or runs a
+// fixed number of inputs mutated from a few seeds, deterministically so that failures reproduce
+int main(const int argc, char** argv)
+{
+	if (argc > 1)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::ifstream file(argv[i], std::ios::binary);
+			const std::string input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			LLVMFuzzerTestOneInput((const uint8_t*)input.data(), input.size());
+		}
+
+		return 0;
+	}
+
+	static const char* const Seeds[] =
+	{
+		"",
+		"[Overlay]\r\nType=2\r\nColor=0x00FF00\r\n",
+		"\xEF\xBB\xBF; comment\n[A]\nKey = \"quoted\" \n\n[B]\nKey='x'\n",
+		"[A\r\n=\r\n[]\r\nKey\r\n==\r\n\r\r\n\n",
+	};
+
+	static constexpr char Alphabet[] = "[]=;#\"' \t\r\nAaKk01\xEF\xBB\xBF";
+	static constexpr int Iterations = 20000;
+
+	std::mt19937 random(12345);
+	std::vector<uint8_t> input;
+
+	for (int i = 0; i < Iterations; i++)
+	{
+		const std::string seed = Seeds[i % std::size(Seeds)];
+		input.assign(seed.begin(), seed.end());
+
+		// Inserts, overwrites and erases, biased towards the characters the parser cares about
+		const int mutations = (int)(random() % 8);
+
+		for (int m = 0; m < mutations; m++)
+		{
+			const auto byte = (uint8_t)(random() % 4 == 0 ? random() : Alphabet[random() % (sizeof(Alphabet) - 1)]);
+			const size_t at = input.empty() ? 0 : random() % (input.size() + 1);
+
+			switch (random() % 3)
+			{
+			case 0:
+				input.insert(input.begin() + (ptrdiff_t)at, byte);
+				break;
+			case 1:
+				if (at < input.size())
+				{
+					input[at] = byte;
+				}
+				break;
+			default:
+				if (at < input.size())
+				{
+					input.erase(input.begin() + (ptrdiff_t)at);
+				}
+				break;
+			}
+		}
+
+		LLVMFuzzerTestOneInput(input.data(), input.size());
+	}
+
+	printf("%d inputs passed\n", Iterations);
+	return 0;
+}
@@ -0,0 +1,51 @@
+// ReSharper disable CppCStyleCast
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "IniFile.h"
+
+// Any input must parse, serialize to a text that parses to the same file, and keep a value that
+// is set. Built for libFuzzer with CLIPPING_FUZZ, otherwise run over generated inputs by FuzzMain.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, const size_t size)
+{
+	const std::string_view text((const char*)data, size);
+
+	IniFile ini;
+	ini.Parse(text);
+	const auto serialized = ini.Serialize();
+
+	IniFile reparsed;
+	reparsed.Parse(serialized);
+
+	if (reparsed.Serialize() != serialized)
+	{
+		abort();
+	}
+
+	// Names and values made of characters that survive trimming and quote stripping
+	char section[8];
+	char key[8];
+	snprintf(section, sizeof(section), "S%zu", size % 7);
+	snprintf(key, sizeof(key), "K%zu", size % 5);
+	const auto value = std::to_string(size);
+
+	ini.SetString(section, key, value);
+
+	if (ini.GetString(section, key, "") != value)
+	{
+		abort();
+	}
+
+	reparsed.Parse(ini.Serialize());
+
+	if (reparsed.GetString(section, key, "") != value || reparsed.Serialize() != ini.Serialize())
+	{
+		abort();
+	}
+
+	return 0;
+}